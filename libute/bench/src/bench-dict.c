@@ -0,0 +1,135 @@
+/// @file
+/// @brief Dictionary insertion and lookup latency across table sizes
+///
+/// This reports the cost of `DICT_SET` and of `DICT_GET` hits and misses for
+/// dictionaries ranging from ones that fit in L1 cache to ones that do not fit
+/// in any cache. Lookups visit keys in a scattered order, so that each one
+/// lands on a different part of the table.
+///
+/// The slot layout is chosen when libute is built. To compare the default
+/// interleaved layout against parallel arrays, run this once from a build
+/// configured with `-DDICT_SOA=ON` and once from one without.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <ute/dict.h>
+
+/// get a monotonic timestamp in nanoseconds
+static uint64_t now(void) {
+  struct timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/// sink for lookup results, to stop the compiler discarding the work
+static volatile uintptr_t sink;
+
+/// number of lookups to time for each measurement
+enum { LOOKUPS = 1 << 22 };
+
+/// scatter an index across a table of `n` entries
+///
+/// @param i Index to scatter
+/// @param n Number of entries, a power of 2
+/// @return A permutation of `i` within [0, n)
+static size_t scatter(size_t i, size_t n) {
+  return (i * (size_t)UINT64_C(0x9e3779b97f4a7c15)) & (n - 1);
+}
+
+/// a key too wide to store inline on any platform
+typedef struct {
+  uint64_t words[8];
+} wide_t;
+
+/// construct a key of each type from an index
+///
+/// Wide keys differ only in their last word, so comparing unequal keys has to
+/// read the whole key.
+///
+/// @param i Index to derive the key from
+/// @return The key
+static uint32_t key32(size_t i) { return (uint32_t)i; }
+static uint64_t key64(size_t i) { return (uint64_t)i; }
+static wide_t key512(size_t i) { return (wide_t){.words[7] = (uint64_t)i}; }
+
+/// timings of one dictionary configuration, in nanoseconds per operation
+typedef struct {
+  double set;
+  double hit;
+  double miss;
+} result_t;
+
+/// run a benchmark against a dictionary type
+///
+/// Keys are derived from indices so that hits use keys in [0, n) and misses
+/// use keys in [n, 2n).
+///
+/// @param dict_type Type of the dictionary
+/// @param make_key Function to construct a key from an index
+/// @param n Number of entries, a power of 2
+/// @param result [out] Timings
+#define RUN(dict_type, make_key, n, result)                                    \
+  do {                                                                         \
+    dict_type d_ = {0};                                                        \
+                                                                               \
+    const uint64_t start_ = now();                                             \
+    for (size_t i_ = 0; i_ < (n); ++i_)                                        \
+      (void)DICT_SET(&d_, make_key(i_), (uint32_t)i_);                         \
+    (result)->set = (double)(now() - start_) / (double)(n);                    \
+                                                                               \
+    uintptr_t acc_ = 0;                                                        \
+    const uint64_t hit_ = now();                                               \
+    for (size_t i_ = 0; i_ < LOOKUPS; ++i_) {                                  \
+      const uint32_t *const v_ = DICT_GET(&d_, make_key(scatter(i_, (n))));    \
+      acc_ += v_ == NULL ? 0 : *v_;                                            \
+    }                                                                          \
+    (result)->hit = (double)(now() - hit_) / LOOKUPS;                          \
+                                                                               \
+    const uint64_t miss_ = now();                                              \
+    for (size_t i_ = 0; i_ < LOOKUPS; ++i_) {                                  \
+      const uint32_t *const v_ =                                               \
+          DICT_GET(&d_, make_key((n) + scatter(i_, (n))));                     \
+      acc_ += v_ == NULL ? 0 : *v_;                                            \
+    }                                                                          \
+    (result)->miss = (double)(now() - miss_) / LOOKUPS;                        \
+    sink = acc_;                                                               \
+                                                                               \
+    DICT_FREE(&d_);                                                            \
+  } while (0)
+
+/// print a row of results
+///
+/// @param label Description of the dictionary configuration
+/// @param n Number of entries
+/// @param r Timings
+static void report(const char *label, size_t n, const result_t *r) {
+  printf("%-8s %10zu %10.2f %10.2f %10.2f\n", label, n, r->set, r->hit,
+         r->miss);
+}
+
+int main(void) {
+  printf("latency (ns/op)\n%-8s %10s %10s %10s %10s\n", "keys", "entries",
+         "set", "get hit", "get miss");
+
+  for (size_t n = (size_t)1 << 10; n <= (size_t)1 << 22; n <<= 4) {
+    result_t r;
+
+    // keys narrower than a pointer, stored inline in their slots
+    RUN(DICT(uint32_t, uint32_t), key32, n, &r);
+    report("inline", n, &r);
+
+    // keys that, on 64-bit platforms, are too wide to store inline
+    RUN(DICT(uint64_t, uint32_t), key64, n, &r);
+    report("boxed", n, &r);
+
+    // keys that are expensive to hash and compare
+    RUN(DICT(wide_t, uint32_t), key512, n, &r);
+    report("wide", n, &r);
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/// @file
+/// @brief Comparison of the default hash against MurmurHash64A
+///
+/// This reports throughput at a range of key sizes, alongside two measures of
+/// quality: how evenly sequential integers spread over the low bits that sets
+/// and dictionaries use to pick a slot, and how close to half the output bits
+/// flip when a single input bit is flipped.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <ute/hash.h>
+
+/// MurmurHash64A by Austin Appleby, as previously used by `hash`
+static size_t murmur(const void *data, size_t len) {
+  const uint64_t m = UINT64_C(0xc6a4a7935bd1e995);
+  const unsigned r = 47;
+
+  uint64_t h = len * m;
+
+  const unsigned char *d = data;
+  const unsigned char *end = d + len / sizeof(uint64_t) * sizeof(uint64_t);
+
+  while (d != end) {
+    uint64_t k;
+    memcpy(&k, d, sizeof(k));
+    d += sizeof(k);
+
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+
+    h ^= k;
+    h *= m;
+  }
+
+  for (size_t i = len & 7; i > 0; --i)
+    h ^= (uint64_t)d[i - 1] << ((i - 1) * 8);
+  if ((len & 7) != 0)
+    h *= m;
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+
+  return (size_t)h;
+}
+
+/// a hash function under test
+typedef struct {
+  const char *name;
+  size_t (*fn)(const void *, size_t);
+} candidate_t;
+
+static const candidate_t CANDIDATES[] = {
+    {"murmur", murmur},
+    {"hash", hash},
+};
+
+/// get a monotonic timestamp in nanoseconds
+static uint64_t now(void) {
+  struct timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/// sink for hash results, to stop the compiler discarding the work
+static volatile size_t sink;
+
+/// measure nanoseconds per hash of keys of a given size
+static double throughput(const candidate_t *c, size_t size) {
+  static unsigned char key[4096];
+  for (size_t i = 0; i < sizeof(key); ++i)
+    key[i] = (unsigned char)(i * 131 + 17);
+
+  // scale iterations so each measurement processes a similar volume of data
+  const size_t iterations = (size_t)1 << 26 >> (size < 64 ? 6 : 12);
+
+  size_t acc = 0;
+  const uint64_t start = now();
+  for (size_t i = 0; i < iterations; ++i) {
+    // vary the key so the call cannot be hoisted
+    key[0] = (unsigned char)i;
+    acc += c->fn(key, size);
+  }
+  const uint64_t end = now();
+  sink = acc;
+
+  return (double)(end - start) / (double)iterations;
+}
+
+/// measure the worst bucket load when hashing sequential 4-byte integers into
+/// a table of 2¹⁶ slots
+static size_t spread(const candidate_t *c) {
+  enum { BUCKETS = 1 << 16 };
+  static size_t load[BUCKETS];
+  memset(load, 0, sizeof(load));
+
+  size_t max = 0;
+  for (uint32_t i = 0; i < BUCKETS; ++i) {
+    const size_t b = c->fn(&i, sizeof(i)) % BUCKETS;
+    if (++load[b] > max)
+      max = load[b];
+  }
+  return max;
+}
+
+/// measure the worst deviation from 50% of the probability an output bit
+/// flips when one input bit is flipped, over keys of a given size
+static double avalanche(const candidate_t *c, size_t size) {
+  enum { TRIALS = 1000 };
+  enum { BITS = sizeof(size_t) * 8 };
+  static size_t flips[64 * 8][BITS];
+  memset(flips, 0, sizeof(flips));
+
+  uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+  for (size_t t = 0; t < TRIALS; ++t) {
+    unsigned char key[64];
+    for (size_t i = 0; i < size; ++i) {
+      state = state * UINT64_C(6364136223846793005) + 1;
+      key[i] = (unsigned char)(state >> 56);
+    }
+
+    const size_t base = c->fn(key, size);
+    for (size_t bit = 0; bit < size * 8; ++bit) {
+      key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+      const size_t diff = base ^ c->fn(key, size);
+      key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+      for (size_t j = 0; j < BITS; ++j)
+        flips[bit][j] += (diff >> j) & 1;
+    }
+  }
+
+  double worst = 0;
+  for (size_t bit = 0; bit < size * 8; ++bit) {
+    for (size_t j = 0; j < BITS; ++j) {
+      const double p = (double)flips[bit][j] / TRIALS;
+      const double bias = p > 0.5 ? p - 0.5 : 0.5 - p;
+      if (bias > worst)
+        worst = bias;
+    }
+  }
+  return worst;
+}
+
+int main(void) {
+  static const size_t SIZES[] = {1, 2, 4, 8, 16, 32, 64, 256, 4096};
+
+  printf("throughput (ns/hash)\n%8s", "size");
+  for (size_t i = 0; i < sizeof(CANDIDATES) / sizeof(CANDIDATES[0]); ++i)
+    printf(" %10s", CANDIDATES[i].name);
+  printf("\n");
+  for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); ++s) {
+    printf("%8zu", SIZES[s]);
+    for (size_t i = 0; i < sizeof(CANDIDATES) / sizeof(CANDIDATES[0]); ++i)
+      printf(" %10.2f", throughput(&CANDIDATES[i], SIZES[s]));
+    printf("\n");
+  }
+
+  printf("\nquality\n%-8s %18s %18s %18s\n", "", "max bucket load",
+         "avalanche bias/4B", "avalanche bias/32B");
+  for (size_t i = 0; i < sizeof(CANDIDATES) / sizeof(CANDIDATES[0]); ++i)
+    printf("%-8s %18zu %18.3f %18.3f\n", CANDIDATES[i].name,
+           spread(&CANDIDATES[i]), avalanche(&CANDIDATES[i], 4),
+           avalanche(&CANDIDATES[i], 32));
+
+  return 0;
+}
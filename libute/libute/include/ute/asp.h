@@ -12,6 +12,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <ute/dword.h>
 
 #ifdef __cplusplus
@@ -26,7 +27,7 @@ typedef struct sp_ctrl sp_ctrl_t;
 /// Analogous to C++’s `std::shared_ptr<…>`. These should only be constructed by
 /// either:
 ///   1. Zero-initialization, e.g. `sp_t s = {0}`; or
-///   2. `sp_new`; or
+///   2. `sp_new` or `sp_make`; or
 ///   3. `sp_acq`.
 /// Any constructed pointer should eventually be destructed with `sp_rel`. Pay
 /// special attention to these semantics as the compiler cannot spot missing
@@ -54,6 +55,23 @@ typedef atomic_dword_t asp_t;
 /// @return A shared pointer or `(sp_t){0}` on failure.
 sp_t sp_new(void *value, void (*dtor)(void *, void *), void *dtor_context);
 
+/// create a new shared pointer to a fresh allocation
+///
+/// This is analogous to C++’s `std::make_shared`. Where `sp_new` allocates a
+/// control block separately from the value it is given, this allocates storage
+/// for both together, saving an allocation and keeping the reference count on
+/// the same cache line as the start of the value. The new value is
+/// zero-initialised. When the last `sp_t` is released, `dtor` is called and
+/// then the storage is freed, so `dtor` must not itself free the value.
+///
+/// @param size Size of the value in bytes
+/// @param alignment Required alignment of the value, a power of 2
+/// @param dtor Optional destructor to be called when last `sp_t` is released
+/// @param dtor_context Value to pass in `dtor` calls as second parameter
+/// @return A shared pointer or `(sp_t){0}` on failure.
+sp_t sp_make(size_t size, size_t alignment, void (*dtor)(void *, void *),
+             void *dtor_context);
+
 /// load a shared pointer
 ///
 /// Any pointer loaded through this function should eventually be released
@@ -117,6 +135,51 @@ void sp_store(asp_t *dst, sp_t src);
 /// @return True if the CAS succeeded
 bool sp_cas(asp_t *dst, sp_t expected, sp_t desired);
 
+/// defer destructors until an explicit call to `sp_reclaim`
+///
+/// By default, releasing the last reference to a shared pointer calls its
+/// destructor immediately, on the releasing thread. When this is the old table
+/// of a set or dictionary that has just been migrated, the thread that
+/// happened to release it absorbs the cost of destroying the whole table. With
+/// deferral enabled, such destructors are instead queued, to be run by a later
+/// call to `sp_reclaim`. Callers can then move this work off latency-sensitive
+/// threads, for example onto a background thread that calls `sp_reclaim`
+/// periodically.
+///
+/// While deferral is enabled, nothing released through a shared pointer is
+/// deallocated until `sp_reclaim` is called. This includes the memory of sets
+/// and dictionaries freed with `SET_FREE` or `DICT_FREE`. Disabling deferral
+/// does not run destructors that are already queued.
+///
+/// @param enable True to queue destructors or false to run them immediately
+void sp_defer_dtors(bool enable);
+
+/// run destructors queued while deferral was enabled
+///
+/// This can be called from any thread, concurrently with any other operation.
+/// Destructors that release further shared pointers have their destructors
+/// run too, before this returns.
+///
+/// @return Number of destructors run
+size_t sp_reclaim(void);
+
+/// statistics about the allocation of shared pointer control blocks
+///
+/// Control blocks created by `sp_new` are recycled through a pool when their
+/// last reference is released.
+typedef struct {
+  size_t hits;   ///< control blocks reused from the pool
+  size_t misses; ///< control blocks obtained from the system allocator
+} sp_pool_stats_t;
+
+/// read statistics about the allocation of shared pointer control blocks
+///
+/// In the presence of concurrent allocations, the result is not a snapshot at
+/// any particular point in time.
+///
+/// @return Counts of allocations since program start
+sp_pool_stats_t sp_pool_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
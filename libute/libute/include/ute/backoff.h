@@ -0,0 +1,59 @@
+/// @file
+/// @brief Contention management for lock-free retry loops
+///
+/// When a compare-and-swap fails because another thread changed the same
+/// location, retrying immediately tends to fail again while both threads
+/// bounce the location’s cache line between their cores. Instead, the retry
+/// loops in this library back off: they wait for an exponentially growing
+/// number of CPU pause instructions before retrying, and after enough failed
+/// attempts give up their time slice altogether.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// how retry loops back off
+typedef struct {
+  /// base-2 logarithm of the most pause instructions in one backoff
+  ///
+  /// The first backoff in a loop pauses once, the next twice, and so on until
+  /// this limit. Values above 16 are treated as 16. 0 means only ever pausing
+  /// once.
+  unsigned max_shift;
+
+  /// should a loop give up its time slice once pausing has reached its limit?
+  bool yield;
+} backoff_config_t;
+
+/// change how retry loops back off
+///
+/// The default configuration is `{.max_shift = 6, .yield = true}`. Changes take
+/// effect for subsequent backoffs in any thread.
+///
+/// @param config New configuration
+void backoff_configure(backoff_config_t config);
+
+/// counts of how often retry loops have backed off
+typedef struct {
+  size_t pauses; ///< backoffs that paused
+  size_t yields; ///< backoffs that gave up their time slice
+} backoff_stats_t;
+
+/// read counts of how often retry loops have backed off
+///
+/// In the presence of concurrent backoffs, the result is not a snapshot at any
+/// particular point in time.
+///
+/// @return Counts since program start
+backoff_stats_t backoff_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
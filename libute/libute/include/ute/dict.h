@@ -4,7 +4,9 @@
 /// This dictionary is:
 ///   • Type-generic – works for any element type
 ///   • Type-safe – compiler should catch all incorrect parameter passing
-///   • Thread-safe – all macros except `DICT_GET` are safe to call concurrently
+///   • Thread-safe – all macros except `DICT_GET` are safe to call
+///     concurrently, unless the dictionary is declared with `DICT_LOCAL`
+///     (`DICT_GET_PROTECTED` is a thread-safe alternative to `DICT_GET`)
 ///   • Lock-free – no mutexes or semaphores involved
 ///
 /// The trade off in being such a general belt-and-suspenders implementation is
@@ -35,43 +37,24 @@ extern "C" {
 ///
 /// @param key_type Type of keys to the dictionary
 /// @param value_type Type of values in the dictionary
-#define DICT(key_type, value_type)                                             \
-  struct {                                                                     \
-    union {                                                                    \
-      dict_t_ impl; /**< private implementation */                             \
-                                                                               \
-      /** mechanism for re-obtaining the dictionary key/value type          */ \
-      /*                                                                    */ \
-      /* To achieve type safety, we need to be able to refer back to        */ \
-      /* `key_type` and `value_type` at call sites involving variables of   */ \
-      /* the struct type being defined here. To do this we propagate these  */ \
-      /* types through an unused member. This does not need to be a pointer */ \
-      /* or be unioned with the `impl` member, but this ensures we minimise */ \
-      /* the size of the struct.                                            */ \
-      struct {                                                                 \
-        key_type k;                                                            \
-        value_type v;                                                          \
-      } *witness;                                                              \
-    };                                                                         \
-                                                                               \
-    /** optional user-supplied key hash                                     */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called when a key needs to be */ \
-    /* hashed.                                                              */ \
-    size_t (*hash)(const void *, size_t);                                      \
-                                                                               \
-    /** optional user-supplied key destructor                               */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called on keys immediately    */ \
-    /* before they are removed from the dictionary.                         */ \
-    void (*key_dtor)(void *);                                                  \
-                                                                               \
-    /** optional user-supplied value destructor                             */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called on values immediately  */ \
-    /* before they are removed from the dictionary.                         */ \
-    void (*value_dtor)(void *);                                                \
-  }
+#define DICT(key_type, value_type) DICT_STRUCT_(key_type, value_type, 1)
+
+/// a dictionary for use by a single thread
+///
+/// This is used in the same way as `DICT`, and the same macros operate on it:
+///
+///   DICT_LOCAL(int, char) d = {0};
+///
+/// The dictionary is not thread-safe. It must not be accessed by more than one
+/// thread at a time, but in return it avoids the cost of synchronisation. Its
+/// entries are stored directly in the slots of an open-addressing hash table,
+/// which is owned through a plain pointer and accessed with plain loads and
+/// stores.
+///
+/// @param key_type Type of keys to the dictionary
+/// @param value_type Type of values in the dictionary
+#define DICT_LOCAL(key_type, value_type)                                       \
+  DICT_STRUCT_(key_type, value_type, 2)
 
 /// insert or update an entry in a dictionary
 ///
@@ -85,13 +68,21 @@ extern "C" {
 /// That is, the caller is responsible for eventually calling the destructor on
 /// the passed in value, whether the insertion succeeds or fails.
 ///
+/// A value this overwrites is normally destroyed and deallocated before this
+/// returns. However, once a value of the dictionary has been retrieved with
+/// `DICT_GET_PROTECTED`, an overwritten value may still be in use by a reader.
+/// It is then instead destroyed and deallocated once no hazard pointer protects
+/// it, by whichever thread next reclaims retired allocations (see
+/// ute/hazard.h). This applies to every later overwrite of the dictionary.
+///
 /// @param dict Dictionary to operate on
 /// @param key Key to insert
 /// @param value Value to insert
 /// @return 0 on success or an errno on failure
 #define DICT_SET(dict, key, value)                                             \
-  dict_set_(&(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key},               \
-            (TYPEOF((dict)->witness->v)[1]){value}, DICT_SIG_(dict))
+  (DICT_IS_LOCAL_(dict) ? dict_local_set_ : dict_set_)(                        \
+      &(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key},                     \
+      (TYPEOF((dict)->witness->v)[1]){value}, DICT_SIG_(dict))
 
 /// retrieve a value from a dictionary
 ///
@@ -111,9 +102,47 @@ extern "C" {
 /// @param key Key to seek
 /// @return Pointer to value associated with key or `NULL`
 #define DICT_GET(dict, key)                                                    \
-  ((TYPEOF(&(dict)->witness->v))dict_get_(                                     \
+  ((TYPEOF(&(dict)->witness->v))(DICT_IS_LOCAL_(dict) ? dict_local_get_        \
+                                                       : dict_get_)(           \
       &(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key}, DICT_SIG_(dict)))
 
+/// retrieve a value from a dictionary, protecting it from concurrent removal
+///
+/// This macro can be thought of as having the C type:
+///
+///   <value_type> *DICT_GET_PROTECTED(DICT(<key_type>, <value_type>) *dict,
+///                                    const <key_type> key, size_t slot);
+///
+/// If the given key is not found in the dictionary, null is returned.
+///
+/// Unlike `DICT_GET`, this is safe to call concurrently with any other
+/// dictionary operation. The returned value is protected by the calling
+/// thread’s hazard pointer `slot` (see ute/hazard.h). It remains valid even if
+/// another thread overwrites or removes it, until the calling thread reuses or
+/// clears `slot` or frees the dictionary.
+///
+/// Values that are narrower than a pointer and have no `value_dtor` are stored
+/// directly in the dictionary rather than in separately allocated storage. For
+/// these, the returned pointer is to a copy of the value held by the calling
+/// thread, so writes through it do not affect the dictionary.
+///
+/// For a dictionary declared with `DICT_LOCAL`, this is equivalent to
+/// `DICT_GET` and `slot` is unused.
+///
+/// @param dict Dictionary to operate on
+/// @param key Key to seek
+/// @param slot Index of the calling thread’s hazard pointer slot to use
+/// @return Pointer to value associated with key or `NULL`
+#define DICT_GET_PROTECTED(dict, key, slot)                                    \
+  ((TYPEOF(&(dict)->witness->v))(                                              \
+      DICT_IS_LOCAL_(dict)                                                     \
+          ? dict_local_get_(&(dict)->impl,                                     \
+                            (TYPEOF((dict)->witness->k)[1]){key},              \
+                            DICT_SIG_(dict))                                   \
+          : dict_get_protected_(&(dict)->impl,                                 \
+                                (TYPEOF((dict)->witness->k)[1]){key}, (slot),  \
+                                DICT_SIG_(dict))))
+
 /// delete an entry from a dictionary
 ///
 /// This macro can be thought of as having the C type:
@@ -121,12 +150,16 @@ extern "C" {
 ///   bool DICT_REMOVE(DICT(<key_type>, <value_type>) *dict,
 ///                    const <key_type> key);
 ///
+/// The removed value is destroyed and deallocated as described for an
+/// overwritten value under `DICT_SET`. So after `DICT_GET_PROTECTED` has been
+/// used on the dictionary, this happens later and possibly on another thread.
+///
 /// @param dict Dictionary to operate on
 /// @param key Key of entry to remove
 /// @return True if the entry was found in the dictionary
 #define DICT_REMOVE(dict, key)                                                 \
-  dict_remove_(&(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key},            \
-               DICT_SIG_(dict))
+  (DICT_IS_LOCAL_(dict) ? dict_local_remove_ : dict_remove_)(                  \
+      &(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key}, DICT_SIG_(dict))
 
 /// does a key exist in a dictionary?
 ///
@@ -139,8 +172,8 @@ extern "C" {
 /// @param key Key to seek
 /// @return True if the key was found in the dictionary
 #define DICT_CONTAINS(dict, key)                                               \
-  dict_contains_(&(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key},          \
-                 DICT_SIG_(dict))
+  (DICT_IS_LOCAL_(dict) ? dict_local_contains_ : dict_contains_)(              \
+      &(dict)->impl, (TYPEOF((dict)->witness->k)[1]){key}, DICT_SIG_(dict))
 
 /// get the number of items in a dictionary
 ///
@@ -150,7 +183,59 @@ extern "C" {
 ///
 /// @param dict Dictionary to operate on
 /// @return Size of the dictionary
-#define DICT_SIZE(dict) dict_size_(&(dict)->impl)
+#define DICT_SIZE(dict)                                                        \
+  (DICT_IS_LOCAL_(dict) ? dict_local_size_ : dict_size_)(&(dict)->impl)
+
+/// pre-size a dictionary to hold a given number of entries
+///
+/// This macro can be thought of as having the C type:
+///
+///   int DICT_RESERVE(DICT(<key_type>, <value_type>) *dict, size_t n);
+///
+/// Inserting entries into a dictionary periodically expands its backing
+/// storage, which involves migrating its existing contents. If the eventual
+/// number of entries is known in advance, this macro can be used to allocate
+/// enough storage up front and avoid these migrations. Dictionaries whose
+/// storage is already large enough are left unchanged.
+///
+/// @param dict Dictionary to operate on
+/// @param n Number of entries to make room for
+/// @return 0 on success or an errno on failure
+#define DICT_RESERVE(dict, n)                                                  \
+  (DICT_IS_LOCAL_(dict) ? dict_local_reserve_ : dict_reserve_)(                \
+      &(dict)->impl, (n), DICT_SIG_(dict))
+
+/// call a function on each entry in a dictionary
+///
+/// This macro can be thought of as having the C type:
+///
+///   int DICT_FOREACH(DICT(<key_type>, <value_type>) *dict,
+///                    int (*callback)(const void *key, void *value,
+///                                    void *context),
+///                    void *context);
+///
+/// `callback` is passed pointers to the key and value of each entry in turn, in
+/// no particular order, along with `context`. If `callback` returns non-zero,
+/// iteration stops and this value is returned.
+///
+/// Iteration does not allocate memory. With respect to keys, it is safe to
+/// perform concurrently with any other dictionary operation but only weakly
+/// consistent. An entry that is in the dictionary for the whole iteration is
+/// visited exactly once. An entry that is inserted or removed during the
+/// iteration may or may not be visited.
+///
+/// Values are subject to the same restriction as `DICT_GET`. A value pointer
+/// is only valid until the next dictionary-modifying operation, and calling
+/// this macro concurrently with any dictionary-modifying operation will result
+/// in undefined behaviour.
+///
+/// @param dict Dictionary to operate on
+/// @param callback Function to call on each entry
+/// @param context Value to pass to `callback`
+/// @return 0 if every entry was visited or the value `callback` stopped with
+#define DICT_FOREACH(dict, callback, context)                                  \
+  (DICT_IS_LOCAL_(dict) ? dict_local_foreach_ : dict_foreach_)(                \
+      &(dict)->impl, (callback), (context))
 
 /// clear a dictionary and deallocate its backing resources
 ///
@@ -160,8 +245,14 @@ extern "C" {
 ///
 /// After a call to this macro, the dictionary is empty and can be reused.
 ///
+/// If `DICT_GET_PROTECTED` has been used on the dictionary, values that were
+/// earlier overwritten or removed may still be protected by another thread’s
+/// hazard pointers. These are destroyed and deallocated later, by whichever
+/// thread reclaims them, possibly after this returns.
+///
 /// @param dict Dictionary to operate on
-#define DICT_FREE(dict) dict_free_(&(dict)->impl)
+#define DICT_FREE(dict)                                                        \
+  (DICT_IS_LOCAL_(dict) ? dict_local_free_ : dict_free_)(&(dict)->impl)
 
 ////////////////////////////////////////////////////////////////////////////////
 // private API
@@ -172,9 +263,75 @@ extern "C" {
 
 /// dictionary private implementation
 typedef struct {
-  asp_t root; ///< shared pointer to the implementation itself
+  union {
+    asp_t root;  ///< shared pointer to the implementation itself
+    void *local; ///< (opaque) owning pointer used by the local implementation
+  };
+
+  /// has a boxed value ever been retrieved with `DICT_GET_PROTECTED`?
+  ///
+  /// Until this is set, overwritten and removed values are deallocated
+  /// immediately. Afterwards, they are retired through hazard pointers.
+  _Atomic bool protected_reads;
 } dict_t_;
 
+/// a dictionary type
+///
+/// @param key_type Type of keys to the dictionary
+/// @param value_type Type of values in the dictionary
+/// @param locality 1 for a thread-safe dictionary or 2 for a thread-local
+///   dictionary
+#define DICT_STRUCT_(key_type, value_type, locality)                           \
+  struct {                                                                     \
+    union {                                                                    \
+      dict_t_ impl; /**< private implementation */                             \
+                                                                               \
+      /** mechanism for re-obtaining the dictionary key/value type          */ \
+      /*                                                                    */ \
+      /* To achieve type safety, we need to be able to refer back to        */ \
+      /* `key_type` and `value_type` at call sites involving variables of   */ \
+      /* the struct type being defined here. To do this we propagate these  */ \
+      /* types through an unused member. This does not need to be a pointer */ \
+      /* or be unioned with the `impl` member, but this ensures we minimise */ \
+      /* the size of the struct.                                            */ \
+      struct {                                                                 \
+        key_type k;                                                            \
+        value_type v;                                                          \
+      } *witness;                                                              \
+                                                                               \
+      /** mechanism for distinguishing `DICT` from `DICT_LOCAL`             */ \
+      /*                                                                    */ \
+      /* This is never accessed. The size of the array it points to is 1    */ \
+      /* for a `DICT` and 2 for a `DICT_LOCAL`, which lets the dictionary   */ \
+      /* macros select an implementation at compile time.                   */ \
+      char (*local_tag)[locality];                                             \
+    };                                                                         \
+                                                                               \
+    /** optional user-supplied key hash                                     */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called when a key needs to be */ \
+    /* hashed.                                                              */ \
+    size_t (*hash)(const void *, size_t);                                      \
+                                                                               \
+    /** optional user-supplied key destructor                               */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called on keys immediately    */ \
+    /* before they are removed from the dictionary.                         */ \
+    void (*key_dtor)(void *);                                                  \
+                                                                               \
+    /** optional user-supplied value destructor                             */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called on values when they    */ \
+    /* are deallocated. For a thread-safe dictionary, a value that is       */ \
+    /* overwritten or removed is only deallocated once no thread is still   */ \
+    /* protecting it (see `DICT_GET_PROTECTED`), so this may be later than  */ \
+    /* its removal.                                                         */ \
+    void (*value_dtor)(void *);                                                \
+  }
+
+/// was this dictionary declared with `DICT_LOCAL`?
+#define DICT_IS_LOCAL_(dict) (sizeof(*(dict)->local_tag) == 2)
+
 /// the characterisation of a dictionary
 typedef struct {
   size_t key_alignment;   ///< required alignment of keys
@@ -221,6 +378,19 @@ int dict_set_(dict_t_ *dict, void *key, void *value, dict_sig_t_ sig);
 /// @return Pointer to value associated with key or `NULL`
 void *dict_get_(dict_t_ *dict, const void *key, dict_sig_t_ sig);
 
+/// retrieve a value from a dictionary, protecting it from concurrent removal
+///
+/// If the given key is not found in the dictionary, null is returned and
+/// `slot` is cleared.
+///
+/// @param dict Dictionary to operate on
+/// @param key Key to seek
+/// @param slot Index of the calling thread’s hazard pointer slot to use
+/// @param sig Signature of the dictionary
+/// @return Pointer to value associated with key or `NULL`
+void *dict_get_protected_(dict_t_ *dict, const void *key, size_t slot,
+                          dict_sig_t_ sig);
+
 /// delete an entry from a dictionary
 ///
 /// @param dict Dictionary to operate on
@@ -243,11 +413,97 @@ bool dict_contains_(dict_t_ *dict, const void *key, dict_sig_t_ sig);
 /// @return Size of the dictionary
 size_t dict_size_(dict_t_ *dict);
 
+/// pre-size a dictionary to hold a given number of entries
+///
+/// @param dict Dictionary to operate on
+/// @param n Number of entries to make room for
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno on failure
+int dict_reserve_(dict_t_ *dict, size_t n, dict_sig_t_ sig);
+
+/// call a function on each entry in a dictionary
+///
+/// Calling this function concurrently with any dictionary-modifying operation
+/// will result in undefined behaviour.
+///
+/// @param dict Dictionary to operate on
+/// @param callback Function to call on each entry
+/// @param context Value to pass to `callback`
+/// @return 0 if every entry was visited or the value `callback` stopped with
+int dict_foreach_(dict_t_ *dict,
+                  int (*callback)(const void *, void *, void *), void *context);
+
 /// clear a dictionary and deallocate its backing resources
 ///
 /// @param dict Dictionary to operate on
 void dict_free_(dict_t_ *dict);
 
+////////////////////////////////////////////////////////////////////////////////
+// implementation for local dictionary
+////////////////////////////////////////////////////////////////////////////////
+
+/// insert or update an entry in a local dictionary
+///
+/// @param dict Dictionary to operate on
+/// @param key Key to insert
+/// @param value Value to insert
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno on failure
+int dict_local_set_(dict_t_ *dict, void *key, void *value, dict_sig_t_ sig);
+
+/// retrieve a value from a local dictionary
+///
+/// @param dict Dictionary to operate on
+/// @param key Key to seek
+/// @param sig Signature of the dictionary
+/// @return Pointer to value associated with key or `NULL`
+void *dict_local_get_(dict_t_ *dict, const void *key, dict_sig_t_ sig);
+
+/// delete an entry from a local dictionary
+///
+/// @param dict Dictionary to operate on
+/// @param key Key of entry to remove
+/// @param sig Signature of the dictionary
+/// @return True if the entry was found in the dictionary
+bool dict_local_remove_(dict_t_ *dict, const void *key, dict_sig_t_ sig);
+
+/// does a key exist in a local dictionary?
+///
+/// @param dict Dictionary to operate on
+/// @param key Key to seek
+/// @param sig Signature of the dictionary
+/// @return True if the key was found in the dictionary
+bool dict_local_contains_(dict_t_ *dict, const void *key, dict_sig_t_ sig);
+
+/// get the number of items in a local dictionary
+///
+/// @param dict Dictionary to operate on
+/// @return Size of the dictionary
+size_t dict_local_size_(dict_t_ *dict);
+
+/// pre-size a local dictionary to hold a given number of entries
+///
+/// @param dict Dictionary to operate on
+/// @param n Number of entries to make room for
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno on failure
+int dict_local_reserve_(dict_t_ *dict, size_t n, dict_sig_t_ sig);
+
+/// call a function on each entry in a local dictionary
+///
+/// @param dict Dictionary to operate on
+/// @param callback Function to call on each entry
+/// @param context Value to pass to `callback`
+/// @return 0 if every entry was visited or the value `callback` stopped with
+int dict_local_foreach_(dict_t_ *dict,
+                        int (*callback)(const void *, void *, void *),
+                        void *context);
+
+/// clear a local dictionary and deallocate its backing resources
+///
+/// @param dict Dictionary to operate on
+void dict_local_free_(dict_t_ *dict);
+
 #ifdef __cplusplus
 }
 #endif
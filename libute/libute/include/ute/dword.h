@@ -62,6 +62,16 @@ typedef _Atomic uint64_t atomic_dword_t;
 #error "unimplemented"
 #endif
 
+// Defining `USE_INLINE_ATOMICS` before including this header makes the
+// definitions of the following functions visible, so the compiler can inline
+// them into callers even without link-time optimisation. `dword_atomic_xchg` is
+// always out of line, as its fallback retry loop relies on libute internals.
+#ifdef USE_INLINE_ATOMICS
+#define DWORD_INLINE_ inline
+#else
+#define DWORD_INLINE_ /* nothing */
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -69,7 +79,7 @@ extern "C" {
 /// create a new dword
 ///
 /// @return A zeroed dword
-dword_t dword_zero(void);
+DWORD_INLINE_ dword_t dword_zero(void);
 
 /// atomically read a dword from memory
 ///
@@ -82,7 +92,7 @@ dword_t dword_zero(void);
 ///
 /// @param src Address to read from
 /// @return Loaded value
-dword_t dword_atomic_load(atomic_dword_t *src);
+DWORD_INLINE_ dword_t dword_atomic_load(atomic_dword_t *src);
 
 /// atomically write a dword to memory
 ///
@@ -95,7 +105,7 @@ dword_t dword_atomic_load(atomic_dword_t *src);
 ///
 /// @param dst Location to write to
 /// @param src Value to write
-void dword_atomic_store(atomic_dword_t *dst, dword_t src);
+DWORD_INLINE_ void dword_atomic_store(atomic_dword_t *dst, dword_t src);
 
 /// atomically compare-and-swap a dword
 ///
@@ -116,7 +126,8 @@ void dword_atomic_store(atomic_dword_t *dst, dword_t src);
 /// @param expected [in,out] Expected old value; actual old value on return
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas(atomic_dword_t *dst, dword_t *expected, dword_t desired);
+DWORD_INLINE_ bool dword_atomic_cas(atomic_dword_t *dst, dword_t *expected,
+                                    dword_t desired);
 
 /// atomically compare-and-swap a dword
 ///
@@ -127,7 +138,8 @@ bool dword_atomic_cas(atomic_dword_t *dst, dword_t *expected, dword_t desired);
 /// @param expected Expected old value
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas_n(atomic_dword_t *dst, dword_t expected, dword_t desired);
+DWORD_INLINE_ bool dword_atomic_cas_n(atomic_dword_t *dst, dword_t expected,
+                                      dword_t desired);
 
 /// atomically read and write a dword
 ///
@@ -156,7 +168,7 @@ dword_t dword_atomic_xchg(atomic_dword_t *dst, dword_t src);
 ///
 /// @param src Address to read from
 /// @return Loaded value
-uintptr_t dword_atomic_load_lo(atomic_dword_t *src);
+DWORD_INLINE_ uintptr_t dword_atomic_load_lo(atomic_dword_t *src);
 
 /// atomically write to the lower half of a dword in memory
 ///
@@ -169,7 +181,7 @@ uintptr_t dword_atomic_load_lo(atomic_dword_t *src);
 ///
 /// @param dst Location to write to
 /// @param src Value to write
-void dword_atomic_store_lo(atomic_dword_t *dst, uintptr_t src);
+DWORD_INLINE_ void dword_atomic_store_lo(atomic_dword_t *dst, uintptr_t src);
 
 /// atomically compare-and-swap the lower half of a dword
 ///
@@ -191,8 +203,8 @@ void dword_atomic_store_lo(atomic_dword_t *dst, uintptr_t src);
 /// @param expected [in,out] Expected old value; actual old value on return
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas_lo(atomic_dword_t *dst, uintptr_t *expected,
-                         uintptr_t desired);
+DWORD_INLINE_ bool dword_atomic_cas_lo(atomic_dword_t *dst, uintptr_t *expected,
+                                       uintptr_t desired);
 
 /// atomically compare-and-swap the lower half of a dword
 ///
@@ -203,8 +215,8 @@ bool dword_atomic_cas_lo(atomic_dword_t *dst, uintptr_t *expected,
 /// @param expected Expected old value
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas_n_lo(atomic_dword_t *dst, uintptr_t expected,
-                           uintptr_t desired);
+DWORD_INLINE_ bool dword_atomic_cas_n_lo(atomic_dword_t *dst,
+                                         uintptr_t expected, uintptr_t desired);
 
 /// atomically read and write the lower half of a dword
 ///
@@ -221,7 +233,8 @@ bool dword_atomic_cas_n_lo(atomic_dword_t *dst, uintptr_t expected,
 /// @param dst Location to read and write
 /// @param src Value to write to `dst`
 /// @return Original value read from `dst`
-uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst, uintptr_t src);
+DWORD_INLINE_ uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst,
+                                             uintptr_t src);
 
 /// atomically read the upper half of a dword from memory
 ///
@@ -234,7 +247,7 @@ uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst, uintptr_t src);
 ///
 /// @param src Address to read from
 /// @return Loaded value
-uintptr_t dword_atomic_load_hi(atomic_dword_t *src);
+DWORD_INLINE_ uintptr_t dword_atomic_load_hi(atomic_dword_t *src);
 
 /// atomically write to the upper half of a dword in memory
 ///
@@ -247,7 +260,7 @@ uintptr_t dword_atomic_load_hi(atomic_dword_t *src);
 ///
 /// @param dst Location to write to
 /// @param src Value to write
-void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src);
+DWORD_INLINE_ void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src);
 
 /// atomically compare-and-swap the upper half of a dword
 ///
@@ -269,8 +282,8 @@ void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src);
 /// @param expected [in,out] Expected old value; actual old value on return
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
-                         uintptr_t desired);
+DWORD_INLINE_ bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
+                                       uintptr_t desired);
 
 /// atomically compare-and-swap the upper half of a dword
 ///
@@ -281,8 +294,8 @@ bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
 /// @param expected Expected old value
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool dword_atomic_cas_n_hi(atomic_dword_t *dst, uintptr_t expected,
-                           uintptr_t desired);
+DWORD_INLINE_ bool dword_atomic_cas_n_hi(atomic_dword_t *dst,
+                                         uintptr_t expected, uintptr_t desired);
 
 /// atomically read and write the upper half of a dword
 ///
@@ -299,8 +312,13 @@ bool dword_atomic_cas_n_hi(atomic_dword_t *dst, uintptr_t expected,
 /// @param dst Location to read and write
 /// @param src Value to write to `dst`
 /// @return Original value read from `dst`
-uintptr_t dword_atomic_xchg_hi(atomic_dword_t *dst, uintptr_t src);
+DWORD_INLINE_ uintptr_t dword_atomic_xchg_hi(atomic_dword_t *dst,
+                                             uintptr_t src);
 
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef USE_INLINE_ATOMICS
+#include <ute/dword_inline.h>
+#endif
@@ -0,0 +1,225 @@
+/// @file
+/// @brief Inline definitions of dword atomics
+///
+/// This is included by ute/dword.h when `USE_INLINE_ATOMICS` is defined and
+/// should not be included directly. As with ute/int128_inline.h, these are C99
+/// inline definitions whose external counterparts are provided by libute.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/dword.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif __SIZEOF_POINTER__ == 8
+#include <ute/int128.h>
+#endif
+
+#ifdef _MSC_VER
+#define DWORD_MAY_ALIAS_ /* nothing */
+#else
+#define DWORD_MAY_ALIAS_ __attribute__((may_alias))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+DWORD_INLINE_ dword_t dword_zero(void) {
+  dword_t d;
+  memset(&d, 0, sizeof(d));
+  return d;
+}
+
+DWORD_INLINE_ dword_t dword_atomic_load(atomic_dword_t *src) {
+  assert(src != NULL);
+
+#if defined(_MSC_VER) && defined(_M_ARM64)
+  {
+    dword_t result = dword_zero();
+    (void)_InterlockedCompareExchange128_acq(src->word, 0, 0, result.word);
+    return result;
+  }
+#elif defined(_MSC_VER) && defined(_WIN64)
+  {
+    dword_t result = dword_zero();
+    (void)_InterlockedCompareExchange128(src->word, 0, 0, result.word);
+    return result;
+  }
+#elif defined(_MSC_VER) && defined(_M_ARM)
+  return _InterlockedCompareExchange64_acq(src, 0, 0);
+#elif defined(_MSC_VER) && defined(_WIN32)
+  return _InterlockedCompareExchange64(src, 0, 0);
+#elif __SIZEOF_POINTER__ == 8
+  return uint128_atomic_load(src);
+#else
+  return atomic_load_explicit(src, memory_order_acquire);
+#endif
+}
+
+DWORD_INLINE_ void dword_atomic_store(atomic_dword_t *dst, dword_t src) {
+  assert(dst != NULL);
+
+#if defined(_MSC_VER) && defined(_WIN64)
+  for (dword_t expected = dword_zero();;) {
+    if (_InterlockedCompareExchange128(dst->word, src.word[1], src.word[0],
+                                       expected.word)) {
+      break;
+    }
+  }
+#elif defined(_MSC_VER) && defined(_M_ARM)
+  (void)_InterlockedExchange64_rel(dst, src);
+#elif defined(_MSC_VER) && defined(_WIN32)
+  for (dword_t old = dword_zero();;) {
+    const dword_t expected = old;
+    old = _InterlockedCompareExchange64(dst, src, expected);
+    if (old == expected) {
+      break;
+    }
+  }
+#elif __SIZEOF_POINTER__ == 8
+  uint128_atomic_store(dst, src);
+#else
+  atomic_store_explicit(dst, src, memory_order_release);
+#endif
+}
+
+DWORD_INLINE_ bool dword_atomic_cas(atomic_dword_t *dst, dword_t *expected,
+                                    dword_t desired) {
+  assert(dst != NULL);
+  assert(expected != NULL);
+
+#if defined(_MSC_VER) && defined(_WIN64)
+  {
+    dword_t expectation = *expected;
+    const unsigned char r = _InterlockedCompareExchange128(
+        dst->word, desired.word[1], desired.word[0], expectation.word);
+    if (r == 0)
+      *expected = expectation;
+    return r != 0;
+  }
+#elif defined(_MSC_VER) && defined(_WIN32)
+  {
+    const dword_t expectation = *expected;
+    const dword_t old =
+        _InterlockedCompareExchange64(dst, desired, expectation);
+    if (old != expectation) {
+      *expected = old;
+      return false;
+    }
+    return true;
+  }
+#elif __SIZEOF_POINTER__ == 8
+  return uint128_atomic_cas(dst, expected, desired);
+#else
+  return atomic_compare_exchange_strong_explicit(
+      dst, expected, desired, memory_order_acq_rel, memory_order_acquire);
+#endif
+}
+
+DWORD_INLINE_ bool dword_atomic_cas_n(atomic_dword_t *dst, dword_t expected,
+                                      dword_t desired) {
+  assert(dst != NULL);
+
+  return dword_atomic_cas(dst, &expected, desired);
+}
+
+DWORD_INLINE_ uintptr_t dword_atomic_load_lo(atomic_dword_t *src) {
+  assert(src != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic const word_t *const s = (_Atomic word_t *)src;
+  return atomic_load_explicit(s, memory_order_acquire);
+}
+
+DWORD_INLINE_ void dword_atomic_store_lo(atomic_dword_t *dst, uintptr_t src) {
+  assert(dst != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  atomic_store_explicit(d, src, memory_order_release);
+}
+
+DWORD_INLINE_ bool dword_atomic_cas_lo(atomic_dword_t *dst, uintptr_t *expected,
+                                       uintptr_t desired) {
+  assert(dst != NULL);
+  assert(expected != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  return atomic_compare_exchange_strong_explicit(
+      d, expected, desired, memory_order_acq_rel, memory_order_acquire);
+}
+
+DWORD_INLINE_ bool dword_atomic_cas_n_lo(atomic_dword_t *dst,
+                                         uintptr_t expected,
+                                         uintptr_t desired) {
+  assert(dst != NULL);
+
+  return dword_atomic_cas_lo(dst, &expected, desired);
+}
+
+DWORD_INLINE_ uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst,
+                                             uintptr_t src) {
+  assert(dst != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  return atomic_exchange_explicit(d, src, memory_order_acq_rel);
+}
+
+DWORD_INLINE_ uintptr_t dword_atomic_load_hi(atomic_dword_t *src) {
+  assert(src != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic const word_t *const s = (_Atomic word_t *)src;
+  return atomic_load_explicit(s + 1, memory_order_acquire);
+}
+
+DWORD_INLINE_ void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src) {
+  assert(dst != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  atomic_store_explicit(d + 1, src, memory_order_release);
+}
+
+DWORD_INLINE_ bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
+                                       uintptr_t desired) {
+  assert(dst != NULL);
+  assert(expected != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  return atomic_compare_exchange_strong_explicit(
+      d + 1, expected, desired, memory_order_acq_rel, memory_order_acquire);
+}
+
+DWORD_INLINE_ bool dword_atomic_cas_n_hi(atomic_dword_t *dst,
+                                         uintptr_t expected,
+                                         uintptr_t desired) {
+  assert(dst != NULL);
+
+  return dword_atomic_cas_hi(dst, &expected, desired);
+}
+
+DWORD_INLINE_ uintptr_t dword_atomic_xchg_hi(atomic_dword_t *dst,
+                                             uintptr_t src) {
+  assert(dst != NULL);
+
+  typedef uintptr_t DWORD_MAY_ALIAS_ word_t;
+  _Atomic word_t *const d = (_Atomic word_t *)dst;
+  return atomic_exchange_explicit(d + 1, src, memory_order_acq_rel);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+/// @file
+/// @brief Read guards for lock-free lookups
+///
+/// Lookups in thread-safe sets (`SET_CONTAINS`, `SET_CONTAINS_MANY`) do not
+/// take a reference to the table they read. Instead they enter a read guard
+/// that defers deallocation of any table they might be looking at until they
+/// have left it. Entering and leaving a guard only touches state private to
+/// the calling thread, so lookups running on many cores do not contend with
+/// one another.
+///
+/// Guards can be nested. A caller issuing many lookups in a row can hold a
+/// guard around the whole sequence, making the guards entered by each lookup
+/// cheaper still. However, memory retired by any thread is not reclaimed while
+/// a guard is held, so guards should not be held for long. A thread must not
+/// block on another thread’s progress while inside a guard.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// enter a read guard
+///
+/// Every call to this function must be paired with a later call to
+/// `epoch_exit` from the same thread.
+void epoch_enter(void);
+
+/// leave a read guard
+void epoch_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
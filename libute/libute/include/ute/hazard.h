@@ -0,0 +1,80 @@
+/// @file
+/// @brief Hazard pointers for protecting individual allocations
+///
+/// Read guards (see ute/epoch.h) protect everything a thread might be looking
+/// at, but only for the duration of a guard. Hazard pointers instead protect
+/// single allocations, for as long as the protecting thread likes. Each thread
+/// owns `HAZARD_SLOTS` slots. Publishing a pointer in one of them
+/// (`hazard_protect`, `hazard_set`) prevents the allocation it points to from
+/// being deallocated if another thread retires it (`hazard_retire`).
+///
+/// Retired allocations are collected per-thread and deallocated in batches
+/// (`hazard_scan`), once no thread’s slots point to them. Protecting and
+/// clearing only write to memory private to the calling thread’s slots, so
+/// many readers do not contend with one another.
+///
+/// The scheme is Maged Michael’s, as described in “Hazard pointers: safe memory
+/// reclamation for lock-free objects”, 2004.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// number of hazard pointer slots each thread owns
+enum { HAZARD_SLOTS = 4 };
+
+/// protect the allocation an atomic pointer currently points to
+///
+/// This loads from `src` and publishes the result in the given slot of the
+/// calling thread, retrying until `src` still holds the same pointer after
+/// publication. The returned pointer stays valid until the slot is overwritten
+/// or cleared, even if another thread retires it in the meantime.
+///
+/// @param slot Index of the calling thread’s slot to use
+/// @param src Pointer to load and protect
+/// @return The protected pointer, which may be `NULL`
+void *hazard_protect(size_t slot, void *_Atomic *src);
+
+/// publish a pointer in one of the calling thread’s slots
+///
+/// This is a lower-level alternative to `hazard_protect` for pointers that are
+/// not stored as a plain `void *_Atomic`. Publication alone does not protect
+/// anything. The caller must re-read wherever it loaded `ptr` from after this
+/// call and only rely on `ptr` if it is still reachable from there.
+///
+/// @param slot Index of the calling thread’s slot to use
+/// @param ptr Pointer to publish
+void hazard_set(size_t slot, const void *ptr);
+
+/// clear one of the calling thread’s slots, ending its protection
+///
+/// @param slot Index of the calling thread’s slot to clear
+void hazard_clear(size_t slot);
+
+/// schedule an allocation for deallocation once no slot protects it
+///
+/// The caller must have already made `ptr` unreachable to any thread that has
+/// not yet protected it. `dtor` may be called by this or any later call to
+/// `hazard_retire` or `hazard_scan` from any thread.
+///
+/// @param ptr Allocation to retire
+/// @param dtor Deallocator to call with `ptr` and `context`
+/// @param context Second parameter to `dtor`
+void hazard_retire(void *ptr, void (*dtor)(void *, void *), void *context);
+
+/// deallocate whatever retired allocations are no longer protected
+///
+/// This considers allocations retired by the calling thread as well as any
+/// left behind by threads that have exited. Retirement calls this periodically,
+/// so it only needs to be called explicitly to reclaim memory promptly.
+void hazard_scan(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -36,6 +36,15 @@ typedef unsigned __int128 uint128_t;
 // atomics                                                                   //
 ///////////////////////////////////////////////////////////////////////////////
 
+// Defining `USE_INLINE_ATOMICS` before including this header makes the
+// definitions of the following functions visible, so the compiler can inline
+// them into callers even without link-time optimisation.
+#ifdef USE_INLINE_ATOMICS
+#define INT128_INLINE_ inline
+#else
+#define INT128_INLINE_ /* nothing */
+#endif
+
 /// atomically read a 128-bit signed integer from memory
 ///
 /// This function is lock-free. It performs the read with (at least) acquire
@@ -47,7 +56,7 @@ typedef unsigned __int128 uint128_t;
 ///
 /// @param src Address to read from
 /// @return Loaded value
-int128_t int128_atomic_load(int128_t *src);
+INT128_INLINE_ int128_t int128_atomic_load(int128_t *src);
 
 /// atomically write a 128-bit signed integer to memory
 ///
@@ -60,7 +69,7 @@ int128_t int128_atomic_load(int128_t *src);
 ///
 /// @param dst Location to write to
 /// @param src Value to write
-void int128_atomic_store(int128_t *dst, int128_t src);
+INT128_INLINE_ void int128_atomic_store(int128_t *dst, int128_t src);
 
 /// atomically compare-and-swap a 128-bit signed integer
 ///
@@ -81,7 +90,8 @@ void int128_atomic_store(int128_t *dst, int128_t src);
 /// @param expected [in,out] Expected old value; actual old value on return
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool int128_atomic_cas(int128_t *dst, int128_t *expected, int128_t desired);
+INT128_INLINE_ bool int128_atomic_cas(int128_t *dst, int128_t *expected,
+                                      int128_t desired);
 
 /// atomically compare-and-swap a 128-bit signed integer
 ///
@@ -92,7 +102,8 @@ bool int128_atomic_cas(int128_t *dst, int128_t *expected, int128_t desired);
 /// @param expected Expected old value
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool int128_atomic_cas_n(int128_t *dst, int128_t expected, int128_t desired);
+INT128_INLINE_ bool int128_atomic_cas_n(int128_t *dst, int128_t expected,
+                                        int128_t desired);
 
 /// atomically read and write a 128-bit signed integer
 ///
@@ -108,7 +119,7 @@ bool int128_atomic_cas_n(int128_t *dst, int128_t expected, int128_t desired);
 /// @param dst Location to read and write
 /// @param src Value to write to `dst`
 /// @return Original value read from `dst`
-int128_t int128_atomic_xchg(int128_t *dst, int128_t src);
+INT128_INLINE_ int128_t int128_atomic_xchg(int128_t *dst, int128_t src);
 
 /// atomically read a 128-bit unsigned integer from memory
 ///
@@ -121,7 +132,7 @@ int128_t int128_atomic_xchg(int128_t *dst, int128_t src);
 ///
 /// @param src Address to read from
 /// @return Loaded value
-uint128_t uint128_atomic_load(uint128_t *src);
+INT128_INLINE_ uint128_t uint128_atomic_load(uint128_t *src);
 
 /// atomically write a 128-bit unsigned integer to memory
 ///
@@ -134,7 +145,7 @@ uint128_t uint128_atomic_load(uint128_t *src);
 ///
 /// @param dst Location to write to
 /// @param src Value to write
-void uint128_atomic_store(uint128_t *dst, uint128_t src);
+INT128_INLINE_ void uint128_atomic_store(uint128_t *dst, uint128_t src);
 
 /// atomically compare-and-swap a 128-bit unsigned integer
 ///
@@ -155,7 +166,8 @@ void uint128_atomic_store(uint128_t *dst, uint128_t src);
 /// @param expected [in,out] Expected old value; actual old value on return
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool uint128_atomic_cas(uint128_t *dst, uint128_t *expected, uint128_t desired);
+INT128_INLINE_ bool uint128_atomic_cas(uint128_t *dst, uint128_t *expected,
+                                       uint128_t desired);
 
 /// atomically compare-and-swap a 128-bit unsigned integer
 ///
@@ -166,8 +178,8 @@ bool uint128_atomic_cas(uint128_t *dst, uint128_t *expected, uint128_t desired);
 /// @param expected Expected old value
 /// @param desired Value to try to write
 /// @return True if the swap succeeded
-bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
-                          uint128_t desired);
+INT128_INLINE_ bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
+                                         uint128_t desired);
 
 /// atomically read and write a 128-bit unsigned integer
 ///
@@ -183,7 +195,126 @@ bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
 /// @param dst Location to read and write
 /// @param src Value to write to `dst`
 /// @return Original value read from `dst`
-uint128_t uint128_atomic_xchg(uint128_t *dst, uint128_t src);
+INT128_INLINE_ uint128_t uint128_atomic_xchg(uint128_t *dst, uint128_t src);
+
+// The following read-modify-write operations are always out of line, as their
+// retry loop backs off using libute internals.
+
+/// atomically add a value to a 128-bit unsigned integer
+///
+/// This function is lock-free. It performs the operation with (at least)
+/// acquire-release semantics. Arithmetic wraps on overflow.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   *dst += src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Operand
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_add(uint128_t *dst, uint128_t src);
+
+/// atomically subtract a value from a 128-bit unsigned integer
+///
+/// This function is lock-free. It performs the operation with (at least)
+/// acquire-release semantics. Arithmetic wraps on overflow.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   *dst -= src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Operand
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_sub(uint128_t *dst, uint128_t src);
+
+/// atomically bitwise-and a value into a 128-bit unsigned integer
+///
+/// This function is lock-free. It performs the operation with (at least)
+/// acquire-release semantics. Arithmetic wraps on overflow.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   *dst &= src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Operand
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_and(uint128_t *dst, uint128_t src);
+
+/// atomically bitwise-or a value into a 128-bit unsigned integer
+///
+/// This function is lock-free. It performs the operation with (at least)
+/// acquire-release semantics. Arithmetic wraps on overflow.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   *dst |= src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Operand
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_or(uint128_t *dst, uint128_t src);
+
+/// atomically bitwise-xor a value into a 128-bit unsigned integer
+///
+/// This function is lock-free. It performs the operation with (at least)
+/// acquire-release semantics. Arithmetic wraps on overflow.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   *dst ^= src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Operand
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_xor(uint128_t *dst, uint128_t src);
+
+/// atomically lower a 128-bit unsigned integer to at most a given value
+///
+/// This function is lock-free. If it writes, it performs the operation with
+/// (at least) acquire-release semantics. If `dst` already holds a value no
+/// larger than `src`, it only reads, with (at least) acquire semantics.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   if (src < old)
+///     *dst = src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Value to compare against
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_min(uint128_t *dst, uint128_t src);
+
+/// atomically raise a 128-bit unsigned integer to at least a given value
+///
+/// This function is lock-free. If it writes, it performs the operation with
+/// (at least) acquire-release semantics. If `dst` already holds a value no
+/// smaller than `src`, it only reads, with (at least) acquire semantics.
+///
+/// Semantically this atomically performs:
+///
+///   uint128_t old = *dst;
+///   if (src > old)
+///     *dst = src;
+///   return old;
+///
+/// @param dst Location to read and write
+/// @param src Value to compare against
+/// @return Original value read from `dst`
+uint128_t uint128_atomic_fetch_max(uint128_t *dst, uint128_t src);
 
 ///////////////////////////////////////////////////////////////////////////////
 // I/O                                                                       //
@@ -206,3 +337,7 @@ int uint128_put(uint128_t v, FILE *stream);
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef USE_INLINE_ATOMICS
+#include <ute/int128_inline.h>
+#endif
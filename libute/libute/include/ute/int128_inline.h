@@ -0,0 +1,214 @@
+/// @file
+/// @brief Inline definitions of 128-bit integer atomics
+///
+/// This is included by ute/int128.h when `USE_INLINE_ATOMICS` is defined and
+/// should not be included directly. The definitions here are C99 inline
+/// definitions, so callers may inline them, while the external definitions
+/// that calls which are not inlined resolve to are provided by libute.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/int128.h>
+
+#ifdef __x86_64__
+#ifdef __has_include
+#if __has_include(<immintrin.h>)
+#include <immintrin.h>
+
+#ifdef __SSE2__
+/// use 128-bit vector loads and stores, which are atomic on x86-64
+#define INT128_AVX_ 1
+#endif
+#endif
+#endif
+#endif
+
+#ifdef __has_feature
+#if __has_feature(thread_sanitizer)
+// TSan does not understand vector accesses as atomic
+#undef INT128_AVX_
+#endif
+#endif
+
+#ifndef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+#error "__sync built-ins unavailable for 128-bit values"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+INT128_INLINE_ int128_t int128_atomic_load(int128_t *src) {
+  assert(src != NULL);
+
+#ifdef INT128_AVX_
+  // A 128-bit AVX load is atomic. However _mm_load_si128 does not reliably
+  // lower to a MOVDQA. Thankfully a volatile load seems to reliably lower to
+  // either this or MOVAPS.
+  {
+    typedef __m128i __attribute__((may_alias)) avx128_t;
+
+    volatile const avx128_t *s = (const avx128_t *)src;
+    return (int128_t)*s;
+  }
+#else
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to a __sync built-in. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=114310
+  return __sync_val_compare_and_swap(src, 1, 1);
+#endif
+}
+
+INT128_INLINE_ int128_t int128_atomic_xchg(int128_t *dst, int128_t src) {
+  assert(dst != NULL);
+
+  // On 128-bit scalars on (at least) aarch64 and x86-64, the __atomic built-ins
+  // and C11 atomics are not lowered to native instructions. So we resort to a
+  // __sync-built-in-based CAS loop. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  for (int128_t expected = 0;;) {
+    const int128_t old = __sync_val_compare_and_swap(dst, expected, src);
+    if (old == expected)
+      return old;
+    expected = old;
+  }
+}
+
+INT128_INLINE_ void int128_atomic_store(int128_t *dst, int128_t src) {
+  assert(dst != NULL);
+
+#ifdef INT128_AVX_
+  // A 128-bit AVX store is atomic. However _mm_store_si128 does not reliably
+  // lower to a MOVDQA. Thankfully a volatile store seems to reliably lower to
+  // either this or MOVAPS.
+  {
+    typedef __m128i __attribute__((may_alias)) avx128_t;
+
+    volatile avx128_t *d = (avx128_t *)dst;
+    *d = (__m128i)src;
+  }
+#endif
+
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to an xchg.
+  (void)int128_atomic_xchg(dst, src);
+}
+
+INT128_INLINE_ bool int128_atomic_cas(int128_t *dst, int128_t *expected,
+                                      int128_t desired) {
+  assert(dst != NULL);
+  assert(expected != NULL);
+
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to a __sync built-in. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  const int128_t expectation = *expected;
+  const int128_t old = __sync_val_compare_and_swap(dst, expectation, desired);
+  if (old == expectation)
+    return true;
+  *expected = old;
+  return false;
+}
+
+INT128_INLINE_ bool int128_atomic_cas_n(int128_t *dst, int128_t expected,
+                                        int128_t desired) {
+  assert(dst != NULL);
+
+  return int128_atomic_cas(dst, &expected, desired);
+}
+
+INT128_INLINE_ uint128_t uint128_atomic_load(uint128_t *src) {
+  assert(src != NULL);
+
+#ifdef INT128_AVX_
+  // A 128-bit AVX load is atomic. However _mm_load_si128 does not reliably
+  // lower to a MOVDQA. Thankfully a volatile load seems to reliably lower to
+  // either this or MOVAPS.
+  {
+    typedef __m128i __attribute__((may_alias)) avx128_t;
+
+    volatile const avx128_t *s = (const avx128_t *)src;
+    return (uint128_t)*s;
+  }
+#else
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to a __sync built-in. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=114310
+  return __sync_val_compare_and_swap(src, 1, 1);
+#endif
+}
+
+INT128_INLINE_ uint128_t uint128_atomic_xchg(uint128_t *dst, uint128_t src) {
+  assert(dst != NULL);
+
+  // On 128-bit scalars on (at least) aarch64 and x86-64, the __atomic built-ins
+  // and C11 atomics are not lowered to native instructions. So we resort to a
+  // __sync-built-in-based CAS loop. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  for (uint128_t expected = 0;;) {
+    const uint128_t old = __sync_val_compare_and_swap(dst, expected, src);
+    if (old == expected)
+      return old;
+    expected = old;
+  }
+}
+
+INT128_INLINE_ void uint128_atomic_store(uint128_t *dst, uint128_t src) {
+  assert(dst != NULL);
+
+#ifdef INT128_AVX_
+  // A 128-bit AVX store is atomic. However _mm_store_si128 does not reliably
+  // lower to a MOVDQA. Thankfully a volatile store seems to reliably lower to
+  // either this or MOVAPS.
+  {
+    typedef __m128i __attribute__((may_alias)) avx128_t;
+
+    volatile avx128_t *d = (avx128_t *)dst;
+    *d = (__m128i)src;
+  }
+#endif
+
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to an xchg.
+  (void)uint128_atomic_xchg(dst, src);
+}
+
+INT128_INLINE_ bool uint128_atomic_cas(uint128_t *dst, uint128_t *expected,
+                                       uint128_t desired) {
+  assert(dst != NULL);
+  assert(expected != NULL);
+
+  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
+  // to native instructions. So we resort to a __sync built-in. See:
+  //   • https://gcc.gnu.org/bugzilla/show_bug.cgi?id=80878
+  //   • https://gcc.gnu.org/pipermail/gcc-help/2017-June.txt
+  const uint128_t expectation = *expected;
+  const uint128_t old = __sync_val_compare_and_swap(dst, expectation, desired);
+  if (old == expectation)
+    return true;
+  *expected = old;
+  return false;
+}
+
+INT128_INLINE_ bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
+                                         uint128_t desired) {
+  assert(dst != NULL);
+
+  return uint128_atomic_cas(dst, &expected, desired);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,226 @@
+/// @file
+/// @brief Type-generic bounded queue
+///
+/// This queue is:
+///   • Type-generic – works for any item type
+///   • Type-safe – compiler should catch all incorrect parameter passing
+///   • Thread-safe – any number of threads can push and pop concurrently
+///   • Lock-free – no mutexes or semaphores involved
+///   • Bounded – its capacity is fixed when it is first used
+///
+/// Items are copied into and out of a ring of slots, each of which carries a
+/// sequence number recording whether it is ready to be pushed to or popped
+/// from. Producers and consumers each claim slots by advancing a shared
+/// position with a compare-and-swap, so they only contend with one another
+/// when racing for the same slot. The batch operations claim a run of slots
+/// with a single compare-and-swap.
+///
+/// A thread that is suspended part way through a push delays consumers from
+/// seeing items pushed after its own, which are reported as not yet present
+/// rather than waited for.
+///
+/// The algorithm is Dmitry Vyukov’s:
+///   Bounded MPMC queue
+///   https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/typeof.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// a queue containing items of a given type
+///
+/// This expands to a type that is intended to be initialised with only its
+/// capacity set:
+///
+///   QUEUE(int) ints = {.capacity = 1024};
+///
+/// The capacity is rounded up to a power of 2, and at least 2. Backing storage
+/// for this many items is allocated by the first push.
+///
+/// @param type Type of items that will be stored in the queue
+#define QUEUE(type)                                                            \
+  struct {                                                                     \
+    union {                                                                    \
+      queue_t_ impl; /**< private implementation */                            \
+                                                                               \
+      /** mechanism for re-obtaining the queue item type (see ute/set.h)    */ \
+      type *witness;                                                           \
+    };                                                                         \
+                                                                               \
+    /** maximum number of items the queue can hold                          */ \
+    size_t capacity;                                                           \
+  }
+
+/// append an item to the back of a queue
+///
+/// This macro can be thought of as having the C type:
+///
+///   int QUEUE_PUSH(QUEUE(<type>) *queue, const <type> item);
+///
+/// @param queue Queue to operate on
+/// @param item Item to push
+/// @return 0 on success, `EAGAIN` if the queue is full, `EINVAL` if its
+///   capacity is 0 or another errno on failure
+#define QUEUE_PUSH(queue, item)                                                \
+  queue_push_(&(queue)->impl, (TYPEOF(*(queue)->witness)[1]){item},            \
+              QUEUE_SIG_(queue))
+
+/// append many items to the back of a queue
+///
+/// This macro can be thought of as having the C type:
+///
+///   size_t QUEUE_PUSH_MANY(QUEUE(<type>) *queue, const <type> *items,
+///                          size_t n);
+///
+/// This pushes as long a prefix of `items` as the queue has room for. The
+/// pushed items are contiguous in the queue, with no other thread’s items
+/// interleaved among them.
+///
+/// @param queue Queue to operate on
+/// @param items Array of items to push
+/// @param n Number of elements in `items`
+/// @return Number of items pushed, which is less than `n` if the queue filled
+///   up or on failure
+#define QUEUE_PUSH_MANY(queue, items, n)                                       \
+  queue_push_many_(&(queue)->impl,                                             \
+                   (const TYPEOF(*(queue)->witness) *[1]){items}[0], (n),      \
+                   QUEUE_SIG_(queue))
+
+/// remove the item at the front of a queue
+///
+/// This macro can be thought of as having the C type:
+///
+///   bool QUEUE_POP(QUEUE(<type>) *queue, <type> *item);
+///
+/// @param queue Queue to operate on
+/// @param item [out] On success, the popped item
+/// @return True if an item was popped or false if the queue was empty
+#define QUEUE_POP(queue, item)                                                 \
+  queue_pop_(&(queue)->impl, (TYPEOF(*(queue)->witness) *[1]){item}[0],        \
+             QUEUE_SIG_(queue))
+
+/// remove many items from the front of a queue
+///
+/// This macro can be thought of as having the C type:
+///
+///   size_t QUEUE_POP_MANY(QUEUE(<type>) *queue, <type> *items, size_t n);
+///
+/// This pops up to `n` items, as many as are ready.
+///
+/// @param queue Queue to operate on
+/// @param items [out] Array of `n` elements to pop into
+/// @param n Maximum number of items to pop
+/// @return Number of items popped
+#define QUEUE_POP_MANY(queue, items, n)                                        \
+  queue_pop_many_(&(queue)->impl, (TYPEOF(*(queue)->witness) *[1]){items}[0],  \
+                  (n), QUEUE_SIG_(queue))
+
+/// get the number of items in a queue
+///
+/// This macro can be thought of as having the C type:
+///
+///   size_t QUEUE_SIZE(QUEUE(<type>) *queue);
+///
+/// In the presence of concurrent pushes and pops, the result is only a
+/// snapshot and may be stale by the time it is returned.
+///
+/// @param queue Queue to operate on
+/// @return Number of items in the queue
+#define QUEUE_SIZE(queue) queue_size_(&(queue)->impl)
+
+/// discard the contents of a queue and deallocate its backing storage
+///
+/// This macro can be thought of as having the C type:
+///
+///   void QUEUE_FREE(QUEUE(<type>) *queue);
+///
+/// This must not be called concurrently with any other operation on the queue.
+/// After a call to this macro, the queue is empty and can be reused.
+///
+/// @param queue Queue to operate on
+#define QUEUE_FREE(queue) queue_free_(&(queue)->impl)
+
+////////////////////////////////////////////////////////////////////////////////
+// private API
+//
+// Everything below this point is not intended to be directly called by
+// includers.
+////////////////////////////////////////////////////////////////////////////////
+
+/// queue private implementation
+typedef struct {
+  void *_Atomic storage; ///< (opaque) backing storage, once allocated
+} queue_t_;
+
+/// the characterisation of a queue
+typedef struct {
+  size_t alignment; ///< required alignment of items
+  size_t size;      ///< byte size of items
+  size_t capacity;  ///< requested capacity
+} queue_sig_t_;
+
+/// construct a `queue_sig_t_` from a queue type
+#define QUEUE_SIG_(queue)                                                      \
+  ((queue_sig_t_){.alignment = alignof(TYPEOF(*(queue)->witness)),             \
+                  .size = sizeof(*(queue)->witness),                           \
+                  .capacity = (queue)->capacity})
+
+/// append an item to the back of a queue
+///
+/// @param queue Queue to operate on
+/// @param item Item to push
+/// @param sig Signature of the queue
+/// @return 0 on success or an errno on failure
+int queue_push_(queue_t_ *queue, const void *item, queue_sig_t_ sig);
+
+/// append many items to the back of a queue
+///
+/// @param queue Queue to operate on
+/// @param items Items to push
+/// @param n Number of items in `items`
+/// @param sig Signature of the queue
+/// @return Number of items pushed
+size_t queue_push_many_(queue_t_ *queue, const void *items, size_t n,
+                        queue_sig_t_ sig);
+
+/// remove the item at the front of a queue
+///
+/// @param queue Queue to operate on
+/// @param item [out] Popped item on success
+/// @param sig Signature of the queue
+/// @return True if an item was popped
+bool queue_pop_(queue_t_ *queue, void *item, queue_sig_t_ sig);
+
+/// remove many items from the front of a queue
+///
+/// @param queue Queue to operate on
+/// @param items [out] Popped items
+/// @param n Maximum number of items to pop
+/// @param sig Signature of the queue
+/// @return Number of items popped
+size_t queue_pop_many_(queue_t_ *queue, void *items, size_t n,
+                       queue_sig_t_ sig);
+
+/// get the number of items in a queue
+///
+/// @param queue Queue to operate on
+/// @return Number of items in the queue
+size_t queue_size_(queue_t_ *queue);
+
+/// discard the contents of a queue and deallocate its backing storage
+///
+/// @param queue Queue to operate on
+void queue_free_(queue_t_ *queue);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,7 +4,8 @@
 /// This set is:
 ///   • Type-generic – works for any element type (WIP)
 ///   • Type-safe – compiler should catch all incorrect parameter passing
-///   • Thread-safe – all macros are safe to call concurrently
+///   • Thread-safe – all macros are safe to call concurrently, unless the set
+///     is declared with `SET_LOCAL`
 ///   • Lock-free – no mutexes or semaphores involved
 ///   • Memory efficient – compile-time specialisation based on set element type
 ///
@@ -16,8 +17,8 @@
 ///   Daniel Hooper
 ///   https://danielchasehooper.com/posts/typechecked-generic-c-data-structures
 ///
-/// The thread-safe aspect of the “boxed” and “unboxed” set implementations is
-/// based on techniques from:
+/// The thread-safe aspect of the “boxed”, “unboxed” and “double-word” set
+/// implementations is based on techniques from:
 ///   A Lock-Free Wait-Free Hash Table
 ///   Dr Cliff Click
 ///   https://web.stanford.edu/class/ee380/Abstracts/070221_LockFreeHash.pdf
@@ -48,39 +49,24 @@ extern "C" {
 ///   SET(int) ints = {0};
 ///
 /// @param type Type of items that will be stored in the set
-#define SET(type, ...)                                                         \
-  struct {                                                                     \
-    union {                                                                    \
-      set_t_ impl; /**< private implementation */                              \
-                                                                               \
-      /** mechanism for re-obtaining the set item type                      */ \
-      /*                                                                    */ \
-      /* To achieve type safety, we need to be able to refer back to `type` */ \
-      /* at call sites involving variables of the struct type being defined */ \
-      /* here. To do this we propagate the type through an unused member.   */ \
-      /* This does not need to be a pointer or be unioned with the `impl`   */ \
-      /* member, but this ensures we minimise the size of the struct.       */ \
-      type *witness;                                                           \
-    };                                                                         \
-                                                                               \
-    /** optional user-supplied item hash                                    */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called when an item needs to  */ \
-    /* be hashed.                                                           */ \
-    size_t (*hash)(const void *, size_t);                                      \
-                                                                               \
-    /** optional user-supplied item comparator                              */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called when two items need to */ \
-    /* be compared.                                                         */ \
-    bool (*eq)(const void *, const void *, size_t);                            \
-                                                                               \
-    /** optional user-supplied item destructor                              */ \
-    /*                                                                      */ \
-    /* If this member is not null, it will be called on set items           */ \
-    /* immediately before they are removed from the set.                    */ \
-    void (*dtor)(void *);                                                      \
-  }
+#define SET(type, ...) SET_STRUCT_(type, 1)
+
+/// a set for use by a single thread
+///
+/// This is used in the same way as `SET`, and the same macros operate on it:
+///
+///   SET_LOCAL(int) ints = {0};
+///
+/// The set is not thread-safe. It must not be accessed by more than one
+/// thread at a time, but in return it avoids the cost of synchronisation. Its
+/// backing storage is owned through a plain pointer, and is accessed with
+/// plain loads and stores. Items of types with few enough values are stored
+/// inline or in a bitset, as they are for `SET`. All other items are stored
+/// directly in the slots of an open-addressing hash table, irrespective of
+/// their size.
+///
+/// @param type Type of items that will be stored in the set
+#define SET_LOCAL(type) SET_STRUCT_(type, 2)
 
 /// insert an item into a set
 ///
@@ -100,13 +86,46 @@ extern "C" {
 ///   item already existed in the set before the insertion
 /// @return 0 on success or an errno on failure
 #define SET_INSERT(set, item, ...)                                             \
-  (SET_CAN_INLINE_(set)   ? set_inline_insert_                                 \
-   : SET_CAN_BITSET_(set) ? set_bitset_insert_                                 \
-   : SET_CAN_UNBOX_(set)  ? set_unboxed_insert_                                \
-                          : set_boxed_insert_)(                                 \
+  (SET_CAN_INLINE_(set)         ? set_inline_insert_                           \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_insert_                     \
+   : SET_IS_LOCAL_(set)         ? set_local_table_insert_                      \
+   : SET_CAN_BITSET_(set)       ? set_bitset_insert_                           \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_insert_                          \
+   : SET_CAN_DWORD_(set)        ? set_dword_insert_                            \
+                                : set_boxed_insert_)(                          \
       &(set)->impl, (TYPEOF(*(set)->witness)[1]){item},                        \
       (bool *[2]){NULL, ##__VA_ARGS__}[1], SET_SIG_(set))
 
+/// insert many items into a set
+///
+/// This macro can be thought of as having one of the C types:
+///
+///   int SET_INSERT_MANY(SET(<type>) *set, <type> *items, size_t n);
+///   int SET_INSERT_MANY(SET(<type>) *set, <type> *items, size_t n,
+///                       bool *exists);
+///
+/// This is equivalent to calling `SET_INSERT` on each of `items` in turn, but
+/// accesses the set’s backing storage once for the whole batch instead of once
+/// per item. The items are “consumed” in the same way as the `item` parameter
+/// of `SET_INSERT`. On failure, some prefix of `items` may have been inserted.
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @return 0 on success or an errno on failure
+#define SET_INSERT_MANY(set, items, n, ...)                                    \
+  (SET_CAN_INLINE_(set)         ? set_inline_insert_many_                      \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_insert_many_                \
+   : SET_IS_LOCAL_(set)         ? set_local_table_insert_many_                 \
+   : SET_CAN_BITSET_(set)       ? set_bitset_insert_many_                      \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_insert_many_                     \
+   : SET_CAN_DWORD_(set)        ? set_dword_insert_many_                       \
+                                : set_boxed_insert_many_)(                     \
+      &(set)->impl, (TYPEOF(*(set)->witness) *[1]){items}[0], (n),             \
+      (bool *[2]){NULL, ##__VA_ARGS__}[1], SET_SIG_(set))
+
 /// remove an item from a set
 ///
 /// This macro can be thought of as having the C type:
@@ -117,10 +136,13 @@ extern "C" {
 /// @param item Item to remove
 /// @return True if the item was removed or false if it was not in the set
 #define SET_REMOVE(set, item)                                                  \
-  (SET_CAN_INLINE_(set)   ? set_inline_remove_                                 \
-   : SET_CAN_BITSET_(set) ? set_bitset_remove_                                 \
-   : SET_CAN_UNBOX_(set)  ? set_unboxed_remove_                                \
-                          : set_boxed_remove_)(                                 \
+  (SET_CAN_INLINE_(set)         ? set_inline_remove_                           \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_remove_                     \
+   : SET_IS_LOCAL_(set)         ? set_local_table_remove_                      \
+   : SET_CAN_BITSET_(set)       ? set_bitset_remove_                           \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_remove_                          \
+   : SET_CAN_DWORD_(set)        ? set_dword_remove_                            \
+                                : set_boxed_remove_)(                          \
       &(set)->impl, (TYPEOF(*(set)->witness)[1]){item}, SET_SIG_(set))
 
 /// does an item exist in a set?
@@ -129,16 +151,52 @@ extern "C" {
 ///
 ///   bool SET_CONTAINS(SET(<type>) *set, const <type> item);
 ///
+/// This does not write to any memory shared with other threads (see
+/// ute/epoch.h).
+///
 /// @param set Set to operate on
 /// @param item Item whose existence to check
 /// @return True if the item was found in the set
 #define SET_CONTAINS(set, item)                                                \
-  (SET_CAN_INLINE_(set)   ? set_inline_contains_                               \
-   : SET_CAN_BITSET_(set) ? set_bitset_contains_                               \
-   : SET_CAN_UNBOX_(set)  ? set_unboxed_contains_                              \
-                          : set_boxed_contains_)(                               \
+  (SET_CAN_INLINE_(set)         ? set_inline_contains_                         \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_contains_                   \
+   : SET_IS_LOCAL_(set)         ? set_local_table_contains_                    \
+   : SET_CAN_BITSET_(set)       ? set_bitset_contains_                         \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_contains_                        \
+   : SET_CAN_DWORD_(set)        ? set_dword_contains_                          \
+                                : set_boxed_contains_)(                        \
       &(set)->impl, (TYPEOF(*(set)->witness)[1]){item}, SET_SIG_(set))
 
+/// check for the existence of many items in a set
+///
+/// This macro can be thought of as having one of the C types:
+///
+///   size_t SET_CONTAINS_MANY(SET(<type>) *set, const <type> *items,
+///                            size_t n);
+///   size_t SET_CONTAINS_MANY(SET(<type>) *set, const <type> *items,
+///                            size_t n, bool *found);
+///
+/// This is equivalent to calling `SET_CONTAINS` on each of `items` in turn, but
+/// accesses the set’s backing storage once for the whole batch instead of once
+/// per item.
+///
+/// @param set Set to operate on
+/// @param items Array of items whose existence to check
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @return Number of `items` that were found in the set
+#define SET_CONTAINS_MANY(set, items, n, ...)                                  \
+  (SET_CAN_INLINE_(set)         ? set_inline_contains_many_                    \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_contains_many_              \
+   : SET_IS_LOCAL_(set)         ? set_local_table_contains_many_               \
+   : SET_CAN_BITSET_(set)       ? set_bitset_contains_many_                    \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_contains_many_                   \
+   : SET_CAN_DWORD_(set)        ? set_dword_contains_many_                     \
+                                : set_boxed_contains_many_)(                   \
+      &(set)->impl, (const TYPEOF(*(set)->witness) *[1]){items}[0], (n),       \
+      (bool *[2]){NULL, ##__VA_ARGS__}[1], SET_SIG_(set))
+
 /// get the number of items in a set
 ///
 /// This macro can be thought of as having the C type:
@@ -148,10 +206,98 @@ extern "C" {
 /// @param set Set to operate on
 /// @return Size of the set
 #define SET_SIZE(set)                                                          \
-  (SET_CAN_INLINE_(set)   ? set_inline_size_                                   \
-   : SET_CAN_BITSET_(set) ? set_bitset_size_                                   \
-   : SET_CAN_UNBOX_(set)  ? set_unboxed_size_                                  \
-                          : set_boxed_size_)(&(set)->impl, SET_SIG_(set))
+  (SET_CAN_INLINE_(set)         ? set_inline_size_                             \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_size_                       \
+   : SET_IS_LOCAL_(set)         ? set_local_table_size_                        \
+   : SET_CAN_BITSET_(set)       ? set_bitset_size_                             \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_size_                            \
+   : SET_CAN_DWORD_(set)        ? set_dword_size_                              \
+                                : set_boxed_size_)(&(set)->impl, SET_SIG_(set))
+
+/// pre-size a set to hold a given number of items
+///
+/// This macro can be thought of as having the C type:
+///
+///   int SET_RESERVE(SET(<type>) *set, size_t n);
+///
+/// Inserting items into a set periodically expands its backing storage, which
+/// involves migrating its existing contents. If the eventual number of items
+/// is known in advance, this macro can be used to allocate enough storage up
+/// front and avoid these migrations. Sets whose storage is already large
+/// enough are left unchanged.
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @return 0 on success or an errno on failure
+#define SET_RESERVE(set, n)                                                    \
+  (SET_CAN_INLINE_(set)         ? set_inline_reserve_                          \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_reserve_                    \
+   : SET_IS_LOCAL_(set)         ? set_local_table_reserve_                     \
+   : SET_CAN_BITSET_(set)       ? set_bitset_reserve_                          \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_reserve_                         \
+   : SET_CAN_DWORD_(set)        ? set_dword_reserve_                           \
+                                : set_boxed_reserve_)(&(set)->impl, (n),       \
+                                                      SET_SIG_(set))
+
+/// reclaim the space occupied by items that have been removed from a set
+///
+/// This macro can be thought of as having the C type:
+///
+///   int SET_COMPACT(SET(<type>) *set);
+///
+/// Removed items leave behind tombstones in the set’s backing storage. These
+/// are reclaimed automatically once enough accumulate, but this macro can be
+/// used to reclaim them eagerly. The set’s storage may also be shrunk if it is
+/// larger than its contents warrant. Concurrent operations on the set remain
+/// safe while it is being compacted.
+///
+/// @param set Set to operate on
+/// @return 0 on success or an errno on failure
+#define SET_COMPACT(set)                                                       \
+  (SET_CAN_INLINE_(set)         ? set_inline_compact_                          \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_compact_                    \
+   : SET_IS_LOCAL_(set)         ? set_local_table_compact_                     \
+   : SET_CAN_BITSET_(set)       ? set_bitset_compact_                          \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_compact_                         \
+   : SET_CAN_DWORD_(set)        ? set_dword_compact_                           \
+                                : set_boxed_compact_)(&(set)->impl,            \
+                                                      SET_SIG_(set))
+
+/// call a function on each item in a set
+///
+/// This macro can be thought of as having the C type:
+///
+///   int SET_FOREACH(SET(<type>) *set,
+///                   int (*callback)(const void *item, void *context),
+///                   void *context);
+///
+/// `callback` is passed a pointer to each item in turn, in no particular order,
+/// along with `context`. As with the `hash`, `eq` and `dtor` members of a set,
+/// `item` is a pointer to a `<type>`. If `callback` returns non-zero, iteration
+/// stops and this value is returned.
+///
+/// Iteration does not allocate memory and is safe to perform concurrently with
+/// any other set operation. However it is only weakly consistent. An item that
+/// is in the set for the whole iteration is visited exactly once. An item that
+/// is inserted or removed during the iteration may or may not be visited, and
+/// an item that is removed and re-inserted during the iteration may be visited
+/// twice. The set’s storage is not freed until the iteration completes, so the
+/// pointer passed to `callback` remains valid until it returns even if the
+/// item is concurrently removed. `callback` must not modify the item.
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @return 0 if every item was visited or the value `callback` stopped with
+#define SET_FOREACH(set, callback, context)                                    \
+  (SET_CAN_INLINE_(set)         ? set_inline_foreach_                          \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_foreach_                    \
+   : SET_IS_LOCAL_(set)         ? set_local_table_foreach_                     \
+   : SET_CAN_BITSET_(set)       ? set_bitset_foreach_                          \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_foreach_                         \
+   : SET_CAN_DWORD_(set)        ? set_dword_foreach_                           \
+                                : set_boxed_foreach_)(                         \
+      &(set)->impl, (callback), (context), SET_SIG_(set))
 
 /// clear a set and deallocate its backing resources
 ///
@@ -161,12 +307,21 @@ extern "C" {
 ///
 /// After a call to this macro, the set is empty and can be reused.
 ///
+/// The backing storage of a thread-safe set may still be being read by
+/// lookups on other threads, so this waits until it has been deallocated. It
+/// therefore blocks while any other thread holds a read guard (see
+/// ute/epoch.h). If the calling thread itself holds a guard, it does not wait
+/// and the storage is deallocated later.
+///
 /// @param set Set to operate on
 #define SET_FREE(set)                                                          \
-  (SET_CAN_INLINE_(set)   ? set_inline_free_                                   \
-   : SET_CAN_BITSET_(set) ? set_bitset_free_                                   \
-   : SET_CAN_UNBOX_(set)  ? set_unboxed_free_                                  \
-                          : set_boxed_free_)(&(set)->impl)
+  (SET_CAN_INLINE_(set)         ? set_inline_free_                             \
+   : SET_CAN_LOCAL_BITSET_(set) ? set_local_bitset_free_                       \
+   : SET_IS_LOCAL_(set)         ? set_local_table_free_                        \
+   : SET_CAN_BITSET_(set)       ? set_bitset_free_                             \
+   : SET_CAN_UNBOX_(set)        ? set_unboxed_free_                            \
+   : SET_CAN_DWORD_(set)        ? set_dword_free_                              \
+                                : set_boxed_free_)(&(set)->impl)
 
 ////////////////////////////////////////////////////////////////////////////////
 // private API
@@ -180,9 +335,55 @@ typedef struct {
   union {
     asp_t root; ///< shared (opaque) pointer to the implementation itself
     _Atomic uintptr_t raw[2]; ///< (opaque) bitset used by inline implementation
+    void *local; ///< (opaque) owning pointer used by local implementations
   };
 } set_t_;
 
+/// a set type
+///
+/// @param type Type of items that will be stored in the set
+/// @param locality 1 for a thread-safe set or 2 for a thread-local set
+#define SET_STRUCT_(type, locality)                                            \
+  struct {                                                                     \
+    union {                                                                    \
+      set_t_ impl; /**< private implementation */                              \
+                                                                               \
+      /** mechanism for re-obtaining the set item type                      */ \
+      /*                                                                    */ \
+      /* To achieve type safety, we need to be able to refer back to `type` */ \
+      /* at call sites involving variables of the struct type being defined */ \
+      /* here. To do this we propagate the type through an unused member.   */ \
+      /* This does not need to be a pointer or be unioned with the `impl`   */ \
+      /* member, but this ensures we minimise the size of the struct.       */ \
+      type *witness;                                                           \
+                                                                               \
+      /** mechanism for distinguishing `SET` from `SET_LOCAL`               */ \
+      /*                                                                    */ \
+      /* This is never accessed. The size of the array it points to is 1    */ \
+      /* for a `SET` and 2 for a `SET_LOCAL`, which lets the set macros     */ \
+      /* select an implementation at compile time.                          */ \
+      char (*local_tag)[locality];                                             \
+    };                                                                         \
+                                                                               \
+    /** optional user-supplied item hash                                    */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called when an item needs to  */ \
+    /* be hashed.                                                           */ \
+    size_t (*hash)(const void *, size_t);                                      \
+                                                                               \
+    /** optional user-supplied item comparator                              */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called when two items need to */ \
+    /* be compared.                                                         */ \
+    bool (*eq)(const void *, const void *, size_t);                            \
+                                                                               \
+    /** optional user-supplied item destructor                              */ \
+    /*                                                                      */ \
+    /* If this member is not null, it will be called on set items           */ \
+    /* immediately before they are removed from the set.                    */ \
+    void (*dtor)(void *);                                                      \
+  }
+
 /// the characterisation of a type
 typedef struct {
   size_t alignment; ///< required alignment
@@ -221,6 +422,12 @@ typedef struct {
    SET_SIG_(set).hash == NULL && SET_SIG_(set).eq == NULL &&                   \
    SET_SIG_(set).dtor == NULL)
 
+/// was this set declared with `SET_LOCAL`?
+#define SET_IS_LOCAL_(set) (sizeof(*(set)->local_tag) == 2)
+
+/// can this thread-local set use the optimised bitset implementation?
+#define SET_CAN_LOCAL_BITSET_(set) (SET_IS_LOCAL_(set) && SET_CAN_BITSET_(set))
+
 /// can this set use the optimised bitset implementation?
 #define SET_CAN_BITSET_(set)                                                   \
   (SET_SIG_(set).size <= 2 && SET_SIG_(set).hash == NULL &&                    \
@@ -232,6 +439,12 @@ typedef struct {
    SET_SIG_(set).alignment <= alignof(uintptr_t) &&                            \
    SET_SIG_(set).dtor == NULL)
 
+/// can this set use the optimised double-word implementation?
+#define SET_CAN_DWORD_(set)                                                    \
+  (SET_SIG_(set).size <= sizeof(uintptr_t) &&                                  \
+   SET_SIG_(set).alignment <= alignof(uintptr_t) &&                            \
+   SET_SIG_(set).dtor == NULL)
+
 ////////////////////////////////////////////////////////////////////////////////
 // implementations for boxed set
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +459,18 @@ typedef struct {
 /// @return 0 on success or an errno on failure
 int set_boxed_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig);
 
+/// insert many items into a boxed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_boxed_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                           set_sig_t_ sig);
+
 /// remove an item from a boxed set
 ///
 /// @param set Set to operate on
@@ -262,6 +487,18 @@ bool set_boxed_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return True if item was found in the set
 bool set_boxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 
+/// check for the existence of many items in a boxed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_boxed_contains_many_(set_t_ *set, const void *items, size_t n,
+                                bool *found, set_sig_t_ sig);
+
 /// get the number of items in a boxed set
 ///
 /// @param set Set to operate on
@@ -269,6 +506,31 @@ bool set_boxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return Size of the set
 size_t set_boxed_size_(set_t_ *set, set_sig_t_ sig);
 
+/// pre-size a boxed set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_boxed_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from a boxed set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_boxed_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in a boxed set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_boxed_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                       void *context, set_sig_t_ sig);
+
 /// clear a boxed set and deallocate its backing resources
 ///
 /// @param set Set to operate on
@@ -288,6 +550,18 @@ void set_boxed_free_(set_t_ *set);
 /// @return 0 on success or an errno on failure
 int set_unboxed_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig);
 
+/// insert many items into an unboxed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_unboxed_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                             set_sig_t_ sig);
+
 /// remove an item from an unboxed set
 ///
 /// @param set Set to operate on
@@ -304,6 +578,18 @@ bool set_unboxed_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return True if item was found in the set
 bool set_unboxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 
+/// check for the existence of many items in an unboxed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_unboxed_contains_many_(set_t_ *set, const void *items, size_t n,
+                                  bool *found, set_sig_t_ sig);
+
 /// get the number of items in an unboxed set
 ///
 /// @param set Set to operate on
@@ -311,11 +597,127 @@ bool set_unboxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return Size of the set
 size_t set_unboxed_size_(set_t_ *set, set_sig_t_ sig);
 
+/// pre-size an unboxed set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_unboxed_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from an unboxed set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_unboxed_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in an unboxed set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_unboxed_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                         void *context, set_sig_t_ sig);
+
 /// clear an unboxed set and deallocate its backing resources
 ///
 /// @param set Set to operate on
 void set_unboxed_free_(set_t_ *set);
 
+////////////////////////////////////////////////////////////////////////////////
+// implementations for double-word set
+////////////////////////////////////////////////////////////////////////////////
+
+/// insert an item into a double-word set
+///
+/// @param set Set to operate on
+/// @param item Item to insert
+/// @param exists [out] If not null, on success this will be set to whether the
+///   item already existed in the set before the insertion
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_dword_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig);
+
+/// insert many items into a double-word set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_dword_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                           set_sig_t_ sig);
+
+/// remove an item from a double-word set
+///
+/// @param set Set to operate on
+/// @param item Item to remove
+/// @param sig Signature of the set item type
+/// @return True if the item was previously in the set
+bool set_dword_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check if an item is in a double-word set
+///
+/// @param set Set to operate on
+/// @param item Item to seek
+/// @param sig Signature of the set item type
+/// @return True if item was found in the set
+bool set_dword_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check for the existence of many items in a double-word set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_dword_contains_many_(set_t_ *set, const void *items, size_t n,
+                                bool *found, set_sig_t_ sig);
+
+/// get the number of items in a double-word set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return Size of the set
+size_t set_dword_size_(set_t_ *set, set_sig_t_ sig);
+
+/// pre-size a double-word set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_dword_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from a double-word set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_dword_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in a double-word set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_dword_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                       void *context, set_sig_t_ sig);
+
+/// clear a double-word set and deallocate its backing resources
+///
+/// @param set Set to operate on
+void set_dword_free_(set_t_ *set);
+
 ////////////////////////////////////////////////////////////////////////////////
 // implementations for bitset-backed set
 ////////////////////////////////////////////////////////////////////////////////
@@ -330,6 +732,18 @@ void set_unboxed_free_(set_t_ *set);
 /// @return 0 on success or an errno on failure
 int set_bitset_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig);
 
+/// insert many items into a bitset-backed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_bitset_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                            set_sig_t_ sig);
+
 /// remove an item from a bitset-backed set
 ///
 /// @param set Set to operate on
@@ -346,6 +760,18 @@ bool set_bitset_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return True if item was found in the set
 bool set_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 
+/// check for the existence of many items in a bitset-backed set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_bitset_contains_many_(set_t_ *set, const void *items, size_t n,
+                                 bool *found, set_sig_t_ sig);
+
 /// get the number of items in a bitset-backed set
 ///
 /// @param set Set to operate on
@@ -353,6 +779,31 @@ bool set_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return Size of the set
 size_t set_bitset_size_(set_t_ *set, set_sig_t_ sig);
 
+/// pre-size a bitset-backed set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_bitset_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from a bitset-backed set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_bitset_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in a bitset-backed set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_bitset_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                        void *context, set_sig_t_ sig);
+
 /// clear a bitset-backed set and deallocate its backing resources
 ///
 /// @param set Set to operate on
@@ -372,6 +823,18 @@ void set_bitset_free_(set_t_ *set);
 /// @return 0 on success or an errno on failure
 int set_inline_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig);
 
+/// insert many items into an inline set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_inline_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                            set_sig_t_ sig);
+
 /// remove an item from an inline set
 ///
 /// @param set Set to operate on
@@ -388,6 +851,18 @@ bool set_inline_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return True if item was found in the set
 bool set_inline_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 
+/// check for the existence of many items in an inline set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_inline_contains_many_(set_t_ *set, const void *items, size_t n,
+                                 bool *found, set_sig_t_ sig);
+
 /// get the number of items in an inline set
 ///
 /// @param set Set to operate on
@@ -395,11 +870,221 @@ bool set_inline_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
 /// @return Size of the set
 size_t set_inline_size_(set_t_ *set, set_sig_t_ sig);
 
+/// pre-size an inline set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_inline_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from an inline set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_inline_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in an inline set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_inline_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                        void *context, set_sig_t_ sig);
+
 /// clear an inline set and deallocate its backing resources
 ///
 /// @param set Set to operate on
 void set_inline_free_(set_t_ *set);
 
+////////////////////////////////////////////////////////////////////////////////
+// implementations for local bitset set
+////////////////////////////////////////////////////////////////////////////////
+
+/// insert an item into a local bitset set
+///
+/// @param set Set to operate on
+/// @param item Item to insert
+/// @param exists [out] If not null, on success this will be set to whether the
+///   item already existed in the set before the insertion
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_bitset_insert_(set_t_ *set, void *item, bool *exists,
+                             set_sig_t_ sig);
+
+/// insert many items into a local bitset set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_bitset_insert_many_(set_t_ *set, void *items, size_t n,
+                                  bool *exists, set_sig_t_ sig);
+
+/// remove an item from a local bitset set
+///
+/// @param set Set to operate on
+/// @param item Item to remove
+/// @param sig Signature of the set item type
+/// @return True if the item was previously in the set
+bool set_local_bitset_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check if an item is in a local bitset set
+///
+/// @param set Set to operate on
+/// @param item Item to seek
+/// @param sig Signature of the set item type
+/// @return True if item was found in the set
+bool set_local_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check for the existence of many items in a local bitset set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_local_bitset_contains_many_(set_t_ *set, const void *items, size_t n,
+                                       bool *found, set_sig_t_ sig);
+
+/// get the number of items in a local bitset set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return Size of the set
+size_t set_local_bitset_size_(set_t_ *set, set_sig_t_ sig);
+
+/// pre-size a local bitset set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_bitset_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from a local bitset set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_bitset_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in a local bitset set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_local_bitset_foreach_(set_t_ *set,
+                              int (*callback)(const void *, void *),
+                              void *context, set_sig_t_ sig);
+
+/// clear a local bitset set and deallocate its backing resources
+///
+/// @param set Set to operate on
+void set_local_bitset_free_(set_t_ *set);
+
+////////////////////////////////////////////////////////////////////////////////
+// implementations for local table set
+////////////////////////////////////////////////////////////////////////////////
+
+/// insert an item into a local table set
+///
+/// @param set Set to operate on
+/// @param item Item to insert
+/// @param exists [out] If not null, on success this will be set to whether the
+///   item already existed in the set before the insertion
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_table_insert_(set_t_ *set, void *item, bool *exists,
+                            set_sig_t_ sig);
+
+/// insert many items into a local table set
+///
+/// @param set Set to operate on
+/// @param items Array of items to insert
+/// @param n Number of elements in `items`
+/// @param exists [out] If not null, an array of `n` elements that on success
+///   will be set to whether each item already existed in the set
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_table_insert_many_(set_t_ *set, void *items, size_t n,
+                                 bool *exists, set_sig_t_ sig);
+
+/// remove an item from a local table set
+///
+/// @param set Set to operate on
+/// @param item Item to remove
+/// @param sig Signature of the set item type
+/// @return True if the item was previously in the set
+bool set_local_table_remove_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check if an item is in a local table set
+///
+/// @param set Set to operate on
+/// @param item Item to seek
+/// @param sig Signature of the set item type
+/// @return True if item was found in the set
+bool set_local_table_contains_(set_t_ *set, const void *item, set_sig_t_ sig);
+
+/// check for the existence of many items in a local table set
+///
+/// @param set Set to operate on
+/// @param items Array of items to seek
+/// @param n Number of elements in `items`
+/// @param found [out] If not null, an array of `n` elements that will be set
+///   to whether each item was found in the set
+/// @param sig Signature of the set item type
+/// @return Number of `items` that were found in the set
+size_t set_local_table_contains_many_(set_t_ *set, const void *items, size_t n,
+                                      bool *found, set_sig_t_ sig);
+
+/// get the number of items in a local table set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return Size of the set
+size_t set_local_table_size_(set_t_ *set, set_sig_t_ sig);
+
+/// pre-size a local table set to hold a given number of items
+///
+/// @param set Set to operate on
+/// @param n Number of items to make room for
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_table_reserve_(set_t_ *set, size_t n, set_sig_t_ sig);
+
+/// reclaim the space occupied by items removed from a local table set
+///
+/// @param set Set to operate on
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno on failure
+int set_local_table_compact_(set_t_ *set, set_sig_t_ sig);
+
+/// call a function on each item in a local table set
+///
+/// @param set Set to operate on
+/// @param callback Function to call on each item
+/// @param context Value to pass to `callback`
+/// @param sig Signature of the set item type
+/// @return 0 if every item was visited or the value `callback` stopped with
+int set_local_table_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                             void *context, set_sig_t_ sig);
+
+/// clear a local table set and deallocate its backing resources
+///
+/// @param set Set to operate on
+void set_local_table_free_(set_t_ *set);
+
 #ifdef __cplusplus
 }
 #endif
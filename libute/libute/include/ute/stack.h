@@ -0,0 +1,193 @@
+/// @file
+/// @brief Type-generic intrusive stack
+///
+/// This stack is:
+///   • Type-generic – works for any item type
+///   • Type-safe – compiler should catch all incorrect parameter passing
+///   • Thread-safe – any number of threads can push and pop concurrently
+///   • Lock-free – no mutexes or semaphores involved
+///   • Intrusive – items are linked through their own storage, so pushing
+///     never allocates
+///
+/// The algorithm is R. Kent Treiber’s, from “Systems programming: Coping with
+/// parallelism”, 1986. Its head pairs a pointer to the top item with a tag that
+/// is incremented on every update. Without the tag, a thread could read the top
+/// item and its successor, be delayed while others pop that item and push it
+/// back with a different successor, and then succeed in a compare-and-swap that
+/// installs the stale successor (the ABA problem).
+///
+/// While an item is on the stack, its first pointer-sized word is overwritten
+/// with a link to the next item. So item types must be at least as large and as
+/// aligned as a pointer. A thread racing to pop an item that another thread has
+/// just popped may read this word after the item has left the stack. Therefore
+/// memory that has been pushed must stay readable for as long as any thread may
+/// still be popping from the stack, for example by only ever recycling it
+/// through the stack itself. This makes the stack well suited to free lists.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <stddef.h>
+#include <ute/dword.h>
+#include <ute/typeof.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// a stack of items of a given type
+///
+/// This expands to a type that is intended to be zero-initialised, which
+/// produces an empty stack:
+///
+///   STACK(struct foo) foos = {0};
+///
+/// @param type Type of items that will be linked into the stack
+#define STACK(type)                                                            \
+  struct {                                                                     \
+    union {                                                                    \
+      stack_t_ impl; /**< private implementation */                            \
+                                                                               \
+      /** mechanism for re-obtaining the stack item type (see ute/set.h)    */ \
+      type *witness;                                                           \
+    };                                                                         \
+  }
+
+/// push an item onto a stack
+///
+/// This macro can be thought of as having the C type:
+///
+///   void STACK_PUSH(STACK(<type>) *stack, <type> *item);
+///
+/// @param stack Stack to operate on
+/// @param item Item to push
+#define STACK_PUSH(stack, item)                                                \
+  stack_push_chain_(&(stack)->impl, STACK_ITEM_(stack, item),                  \
+                    STACK_ITEM_(stack, item))
+
+/// push a chain of items onto a stack
+///
+/// This macro can be thought of as having the C type:
+///
+///   void STACK_PUSH_CHAIN(STACK(<type>) *stack, <type> *first, <type> *last);
+///
+/// The items from `first` to `last` must already be linked together with
+/// `STACK_SET_NEXT`. They are pushed in a single operation, with `first` ending
+/// up on top.
+///
+/// @param stack Stack to operate on
+/// @param first First item of the chain
+/// @param last Last item of the chain
+#define STACK_PUSH_CHAIN(stack, first, last)                                   \
+  stack_push_chain_(&(stack)->impl, STACK_ITEM_(stack, first),                 \
+                    STACK_ITEM_(stack, last))
+
+/// pop the top item from a stack
+///
+/// This macro can be thought of as having the C type:
+///
+///   <type> *STACK_POP(STACK(<type>) *stack);
+///
+/// @param stack Stack to operate on
+/// @return The popped item or `NULL` if the stack was empty
+#define STACK_POP(stack)                                                       \
+  ((TYPEOF((stack)->witness))stack_pop_(&(stack)->impl))
+
+/// pop every item from a stack
+///
+/// This macro can be thought of as having the C type:
+///
+///   <type> *STACK_POP_ALL(STACK(<type>) *stack);
+///
+/// The items are returned as a chain, from the top of the stack down, that can
+/// be walked with `STACK_NEXT`.
+///
+/// @param stack Stack to operate on
+/// @return The first item of the chain or `NULL` if the stack was empty
+#define STACK_POP_ALL(stack)                                                   \
+  ((TYPEOF((stack)->witness))stack_pop_all_(&(stack)->impl))
+
+/// get the item following another in a chain
+///
+/// This macro can be thought of as having the C type:
+///
+///   <type> *STACK_NEXT(STACK(<type>) *stack, <type> *item);
+///
+/// This is only meaningful for items that are not on the stack, such as those
+/// returned by `STACK_POP_ALL`.
+///
+/// @param stack Stack the chain belongs to
+/// @param item Item whose successor to get
+/// @return The next item or `NULL` if `item` is the last in its chain
+#define STACK_NEXT(stack, item)                                                \
+  ((TYPEOF((stack)->witness))stack_next_(STACK_ITEM_(stack, item)))
+
+/// link an item to another in a chain
+///
+/// This macro can be thought of as having the C type:
+///
+///   void STACK_SET_NEXT(STACK(<type>) *stack, <type> *item, <type> *next);
+///
+/// This must not be used on items that are on the stack.
+///
+/// @param stack Stack the chain is for
+/// @param item Item to link from
+/// @param next Item to link to
+#define STACK_SET_NEXT(stack, item, next)                                      \
+  stack_set_next_(STACK_ITEM_(stack, item), STACK_ITEM_(stack, next))
+
+////////////////////////////////////////////////////////////////////////////////
+// private API
+//
+// Everything below this point is not intended to be directly called by
+// includers.
+////////////////////////////////////////////////////////////////////////////////
+
+/// stack private implementation
+typedef struct {
+  /// top of the stack
+  ///
+  /// The lower word is a pointer to the top item. The upper word is a tag that
+  /// is incremented on every update.
+  atomic_dword_t head;
+} stack_t_;
+
+/// type check an item pointer and convert it to `void *`
+#define STACK_ITEM_(stack, item)                                               \
+  ((void *)(TYPEOF((stack)->witness)[1]){item}[0])
+
+/// push a chain of items onto a stack
+///
+/// @param stack Stack to operate on
+/// @param first First item of the chain
+/// @param last Last item of the chain
+void stack_push_chain_(stack_t_ *stack, void *first, void *last);
+
+/// pop the top item from a stack
+///
+/// @param stack Stack to operate on
+/// @return The popped item or `NULL` if the stack was empty
+void *stack_pop_(stack_t_ *stack);
+
+/// pop every item from a stack
+///
+/// @param stack Stack to operate on
+/// @return The first item of the popped chain or `NULL` if the stack was empty
+void *stack_pop_all_(stack_t_ *stack);
+
+/// get the item following another in a chain
+///
+/// @param item Item whose successor to get
+/// @return The next item or `NULL` if `item` is the last in its chain
+void *stack_next_(void *item);
+
+/// link an item to another in a chain
+///
+/// @param item Item to link from
+/// @param next Item to link to
+void stack_set_next_(void *item, void *next);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,6 +3,7 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -33,9 +34,10 @@ static atomic_flag allocated_lock;
 
 /// acquire exclusive access to `allocated`
 static void lock(void) {
+  backoff_t backoff = {0};
   while (
       atomic_flag_test_and_set_explicit(&allocated_lock, memory_order_acq_rel))
-    ;
+    backoff_(&backoff);
 }
 
 /// release exclusive access to `allocated`
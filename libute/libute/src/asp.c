@@ -57,13 +57,20 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
+#include "epoch.h"
+#include "sp_ctrl.h"
+#include "sp_pool.h"
 #include <assert.h>
 #include <limits.h>
+#include <stdalign.h>
 #include <stdatomic.h>
 #include <stdbool.h>
-#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
+#include <ute/aligned_alloc.h>
 #include <ute/asp.h>
 #include <ute/attr.h>
 #include <ute/dword.h>
@@ -110,12 +117,46 @@ static const size_t LOAD_SCALE = (size_t)1 << (sizeof(size_t) * CHAR_BIT / 2);
 /// AND mask for extracting lower half of `sp_ctrl_t.ref_count`
 static const size_t REFS_MASK UNUSED = LOAD_SCALE - 1;
 
-struct sp_ctrl {
-  void *value;                  ///< the managed underlying pointer
-  void (*dtor)(void *, void *); ///< optional user-supplied destructor
-  void *dtor_context;           ///< second parameter to `dtor`
-  atomic_size_t ref_count;      ///< outstanding references
-};
+/// run the destructor of a shared pointer and free its control block
+///
+/// @param ctrl Control block of the pointer
+static void run_dtor(sp_ctrl_t *ctrl) {
+  assert(ctrl != NULL);
+
+  // the destructor may free an embedded control block, so note ownership first
+  const bool embedded = ctrl->embedded;
+  const bool fused = ctrl->fused;
+
+  if (ctrl->dtor != NULL)
+    ctrl->dtor(ctrl->value, ctrl->dtor_context);
+  if (fused) {
+    ALIGNED_FREE(ctrl);
+  } else if (!embedded) {
+    sp_pool_free_(ctrl);
+  }
+}
+
+/// destroy a shared pointer whose last reference has been released
+///
+/// @param ctrl Control block of the pointer
+static void destroy(sp_ctrl_t *ctrl) {
+  assert(ctrl != NULL);
+
+  if (!atomic_load_explicit(&sp_deferred_.enabled, memory_order_relaxed)) {
+    run_dtor(ctrl);
+    return;
+  }
+
+  // leave the destructor for `sp_reclaim`
+  backoff_t backoff = {0};
+  ctrl->deferred =
+      atomic_load_explicit(&sp_deferred_.queue, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(&sp_deferred_.queue,
+                                                &ctrl->deferred, ctrl,
+                                                memory_order_release,
+                                                memory_order_relaxed))
+    backoff_(&backoff);
+}
 
 /// increment the reference count of a shared pointer
 ///
@@ -160,11 +201,8 @@ SP_STORE_L2:
   UNUSED;
 SP_CAS_L3:
   UNUSED;
-  if (old == 1) {
-    if (ctrl->dtor != NULL)
-      ctrl->dtor(ctrl->value, ctrl->dtor_context);
-    free(ctrl);
-  }
+  if (old == 1)
+    destroy(ctrl);
 }
 
 /// decrement the propagated load count of a shared pointer by 1
@@ -205,11 +243,8 @@ SP_STORE_L2:
   UNUSED;
 SP_CAS_L3:
   UNUSED;
-  if (old + load_by * LOAD_SCALE == 1) {
-    if (ctrl->dtor != NULL)
-      ctrl->dtor(ctrl->value, ctrl->dtor_context);
-    free(ctrl);
-  }
+  if (old + load_by * LOAD_SCALE == 1)
+    destroy(ctrl);
 }
 
 /// exposed implementation of an atomic shared pointer
@@ -246,7 +281,7 @@ sp_t sp_new(void *value, void (*dtor)(void *, void *), void *dtor_context) {
     return (sp_t){0};
   }
 
-  sp_ctrl_t *const ctrl = calloc(1, sizeof(*ctrl));
+  sp_ctrl_t *const ctrl = sp_pool_alloc_();
   if (ctrl == NULL) {
     return (sp_t){0};
   }
@@ -254,6 +289,57 @@ sp_t sp_new(void *value, void (*dtor)(void *, void *), void *dtor_context) {
   ctrl->value = value;
   ctrl->dtor = dtor;
   ctrl->dtor_context = dtor_context;
+  atomic_init(&ctrl->ref_count, 0);
+  ctrl->embedded = false;
+  ctrl->fused = false;
+  inc_ref(ctrl, 1);
+
+  return (sp_t){.ptr = value, .impl = ctrl};
+}
+
+sp_t sp_make(size_t size, size_t alignment, void (*dtor)(void *, void *),
+             void *dtor_context) {
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  // ensure the value is distinct from the control block
+  if (size == 0)
+    size = 1;
+
+  // place the value after the control block, padded to its alignment
+  if (alignment < alignof(sp_ctrl_t))
+    alignment = alignof(sp_ctrl_t);
+  const size_t offset =
+      (sizeof(sp_ctrl_t) + alignment - 1) / alignment * alignment;
+  if (size > SIZE_MAX - offset - alignment)
+    return (sp_t){0};
+  const size_t total = (offset + size + alignment - 1) / alignment * alignment;
+
+  sp_ctrl_t *const ctrl = ALIGNED_ALLOC(alignment, total);
+  if (ctrl == NULL)
+    return (sp_t){0};
+  memset(ctrl, 0, total);
+
+  ctrl->value = (char *)ctrl + offset;
+  ctrl->dtor = dtor;
+  ctrl->dtor_context = dtor_context;
+  ctrl->fused = true;
+  inc_ref(ctrl, 1);
+
+  return (sp_t){.ptr = ctrl->value, .impl = ctrl};
+}
+
+sp_t sp_new_in_(sp_ctrl_t *ctrl, void *value, void (*dtor)(void *, void *),
+                void *dtor_context) {
+  assert(ctrl != NULL);
+  assert(value != NULL);
+  assert(dtor != NULL && "embedded control block would never be reclaimed");
+
+  ctrl->value = value;
+  ctrl->dtor = dtor;
+  ctrl->dtor_context = dtor_context;
+  atomic_init(&ctrl->ref_count, 0);
+  ctrl->embedded = true;
+  ctrl->fused = false;
   inc_ref(ctrl, 1);
 
   return (sp_t){.ptr = value, .impl = ctrl};
@@ -268,6 +354,7 @@ sp_t sp_acq(asp_t *asp) {
   // presentations before trying to read this code.
 
   // load the implementation, incrementing the load count
+  backoff_t backoff = {0};
   dword_t old = dword_atomic_load(asp);
 SP_ACQ_L1:
   UNUSED;
@@ -282,6 +369,7 @@ SP_ACQ_L1:
       old = new;
       break;
     }
+    backoff_(&backoff);
   }
 
   DELAY1();
@@ -298,6 +386,7 @@ SP_ACQ_L3:
   const sp_t ret = {.ptr = impl.ctrl->value, .impl = impl.ctrl};
 
   // undo our increment of the load count
+  backoff = (backoff_t){0};
   while (true) {
   SP_ACQ_L4:
     UNUSED;
@@ -315,11 +404,26 @@ SP_ACQ_L3:
       break;
     }
     impl = updated;
+    backoff_(&backoff);
   }
 
   return ret;
 }
 
+void *sp_peek_(asp_t *asp) {
+  assert(asp != NULL);
+
+  // the control block is the first word of the atomic shared pointer, so it
+  // can be read without disturbing the load count in the second
+  static_assert(offsetof(asp_impl_t, ctrl) == 0,
+                "control block is not in the first word of a dword");
+  sp_ctrl_t *const ctrl = (sp_ctrl_t *)dword_atomic_load_lo(asp);
+
+  if (ctrl == NULL)
+    return NULL;
+  return ctrl->value;
+}
+
 sp_t sp_dup(sp_t src) {
 
   // the null pointer is not reference counted
@@ -394,6 +498,7 @@ SP_CAS_L1:
   const asp_impl_t new_impl = {.ctrl = desired.impl};
   const dword_t new = impl2asp(new_impl);
   bool ret;
+  backoff_t backoff = {0};
 
   for (asp_impl_t old_impl = {.ctrl = expected.impl};;) {
     dword_t old = impl2asp(old_impl);
@@ -431,7 +536,55 @@ SP_CAS_L1:
     // does `dst` hold a different pointer than `expected`?
     if (old_impl.ctrl != expected.impl)
       break;
+
+    // otherwise only its load count changed, so try again
+    backoff_(&backoff);
   }
 
   return ret;
 }
+
+void sp_defer_dtors(bool enable) {
+  atomic_store_explicit(&sp_deferred_.enabled, enable, memory_order_relaxed);
+}
+
+size_t sp_reclaim(void) {
+  size_t reclaimed = 0;
+
+  // Destructors may release further references or retire further tables, so
+  // keep going until a pass finds nothing to do. Tables retired into epoch
+  // limbo lists are only claimed once the epoch has advanced by up to 3, so
+  // allow that many idle passes while any are pending.
+  for (size_t idle = 0; idle < EPOCH_LISTS;) {
+    size_t n = 0;
+
+    // help move along any tables awaiting the end of read guards
+    if (atomic_load_explicit(&epoch_state_.pending, memory_order_relaxed) > 0)
+      epoch_try_advance_();
+    n += epoch_reclaim_deferred_();
+
+    // Take the whole queue at once. Nothing is ever popped individually, so
+    // there is no ABA problem here.
+    sp_ctrl_t *ctrl =
+        atomic_exchange_explicit(&sp_deferred_.queue, NULL,
+                                 memory_order_acquire);
+    while (ctrl != NULL) {
+      sp_ctrl_t *const next = ctrl->deferred;
+      run_dtor(ctrl);
+      ctrl = next;
+      ++n;
+    }
+
+    if (n > 0) {
+      reclaimed += n;
+      idle = 0;
+    } else if (atomic_load_explicit(&epoch_state_.pending,
+                                    memory_order_relaxed) == 0) {
+      break;
+    } else {
+      ++idle;
+    }
+  }
+
+  return reclaimed;
+}
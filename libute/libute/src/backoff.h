@@ -0,0 +1,47 @@
+/// @file
+/// @brief Contention management internals
+///
+/// A retry loop declares a zero-initialised `backoff_t` before it starts and
+/// calls `backoff_` each time it fails because of interference from another
+/// thread:
+///
+///   backoff_t backoff = {0};
+///   while (!atomic_compare_exchange_weak(…))
+///     backoff_(&backoff);
+///
+/// Backing off is only ever done after a failure, so it is kept out of line to
+/// keep the uncontended path small.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "counter.h"
+#include <stdatomic.h>
+#include <ute/backoff.h>
+
+/// state of one retry loop
+typedef struct {
+  unsigned attempts; ///< number of backoffs so far
+} backoff_t;
+
+/// upper limit on `backoff_config_t.max_shift`
+enum { BACKOFF_MAX_SHIFT = 16 };
+
+/// global configuration and statistics of backoff
+typedef struct {
+  atomic_uint max_shift; ///< see `backoff_config_t`
+  atomic_bool yield;     ///< see `backoff_config_t`
+
+  counter_t pauses; ///< backoffs that paused
+  counter_t yields; ///< backoffs that gave up their time slice
+} backoff_state_t;
+
+/// global configuration and statistics of backoff
+extern PRIVATE backoff_state_t backoff_state_;
+
+/// wait before a retry
+///
+/// @param backoff State of the calling retry loop
+PRIVATE void backoff_(backoff_t *backoff);
@@ -0,0 +1,64 @@
+/// @file
+/// @brief Implementation of backing off before a retry
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "counter.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+/// hint to the CPU that we are spinning
+static void pause(void) {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#else
+  // at least stop the compiler from collapsing the spin loop
+  atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+void backoff_(backoff_t *backoff) {
+  assert(backoff != NULL);
+
+  unsigned max_shift =
+      atomic_load_explicit(&backoff_state_.max_shift, memory_order_relaxed);
+  if (max_shift > BACKOFF_MAX_SHIFT)
+    max_shift = BACKOFF_MAX_SHIFT;
+
+  // once pausing has stopped growing, let another thread run instead
+  if (backoff->attempts > max_shift &&
+      atomic_load_explicit(&backoff_state_.yield, memory_order_relaxed)) {
+    (void)counter_add(&backoff_state_.yields, 1);
+#ifdef _WIN32
+    (void)SwitchToThread();
+#else
+    (void)sched_yield();
+#endif
+    return;
+  }
+
+  const unsigned shift =
+      backoff->attempts < max_shift ? backoff->attempts : max_shift;
+  ++backoff->attempts;
+
+  (void)counter_add(&backoff_state_.pauses, 1);
+  for (size_t i = 0; i < (size_t)1 << shift; ++i)
+    pause();
+}
@@ -0,0 +1,18 @@
+/// @file
+/// @brief Implementation of configuring backoff
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include <stdatomic.h>
+#include <ute/backoff.h>
+
+void backoff_configure(backoff_config_t config) {
+  const unsigned max_shift = config.max_shift > BACKOFF_MAX_SHIFT
+                                 ? BACKOFF_MAX_SHIFT
+                                 : config.max_shift;
+  atomic_store_explicit(&backoff_state_.max_shift, max_shift,
+                        memory_order_relaxed);
+  atomic_store_explicit(&backoff_state_.yield, config.yield,
+                        memory_order_relaxed);
+}
@@ -0,0 +1,8 @@
+/// @file
+/// @brief Storage for backoff configuration and statistics
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+
+backoff_state_t backoff_state_ = {.max_shift = 6, .yield = true};
@@ -0,0 +1,13 @@
+/// @file
+/// @brief Implementation of reading backoff statistics
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "counter.h"
+#include <ute/backoff.h>
+
+backoff_stats_t backoff_stats(void) {
+  return (backoff_stats_t){.pauses = counter_read(&backoff_state_.pauses),
+                           .yields = counter_read(&backoff_state_.yields)};
+}
@@ -0,0 +1,94 @@
+/// @file
+/// @brief Striped counters for statistics updated by many threads
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// number of independently updated stripes in a counter
+enum { COUNTER_STRIPES = 8 };
+
+/// assumed size of a cache line, used to keep stripes out of each other’s way
+enum { CACHE_LINE = 64 };
+
+/// a counter split across cache lines to avoid contention among writers
+///
+/// Each thread updates a single stripe of the counter. So long as there are
+/// no more writers than stripes, writers never contend with one another. The
+/// counter’s value is the sum of its stripes and is only computed on demand.
+/// Because counters only ever change by adding to or subtracting from a
+/// stripe, individual stripes may wrap around but the sum is still correct.
+typedef struct {
+  struct {
+    alignas(CACHE_LINE) atomic_size_t value;
+  } stripe[COUNTER_STRIPES];
+} counter_t;
+
+/// get the index of the stripe the calling thread should update
+///
+/// @return A stripe index in [0, `COUNTER_STRIPES`)
+PRIVATE size_t counter_stripe_(void);
+
+/// add to a counter
+///
+/// @param counter Counter to update
+/// @param delta Amount to add
+/// @return The new value of the stripe that was updated
+static inline size_t counter_add(counter_t *counter, size_t delta) {
+  const size_t i = counter_stripe_();
+  return atomic_fetch_add_explicit(&counter->stripe[i].value, delta,
+                                   memory_order_acq_rel) +
+         delta;
+}
+
+/// subtract from a counter
+///
+/// @param counter Counter to update
+/// @param delta Amount to subtract
+static inline void counter_sub(counter_t *counter, size_t delta) {
+  const size_t i = counter_stripe_();
+  (void)atomic_fetch_sub_explicit(&counter->stripe[i].value, delta,
+                                  memory_order_acq_rel);
+}
+
+/// sum the stripes of a counter
+///
+/// In the presence of concurrent updates, the result is not a snapshot of the
+/// counter at any particular point in time.
+///
+/// @param counter Counter to read
+/// @return The counter’s current value
+static inline size_t counter_read(counter_t *counter) {
+  size_t sum = 0;
+  for (size_t i = 0; i < COUNTER_STRIPES; ++i)
+    sum += atomic_load_explicit(&counter->stripe[i].value,
+                                memory_order_acquire);
+  return sum;
+}
+
+/// does an update to a counter warrant checking whether it has hit a limit?
+///
+/// Summing a counter means reading every one of its stripes, so doing this on
+/// every update would reintroduce the contention striping avoids. Instead, a
+/// stripe is only summed once it has taken more than its fair share of the
+/// limit, or each time it has grown by 1/`COUNTER_STRIPES` of that share. A
+/// counter can therefore exceed its limit by less than 1/`COUNTER_STRIPES` of
+/// the limit before the overrun is observed.
+///
+/// This relies on each stripe value being seen by exactly one updater, so
+/// should be called with a value returned by `counter_add`.
+///
+/// @param stripe Value of the updated stripe after the update
+/// @param limit Value of the counter being watched for
+/// @return True if the caller should sum the counter and compare it to `limit`
+static inline bool counter_should_check(size_t stripe, size_t limit) {
+  const size_t share = limit / COUNTER_STRIPES;
+  const size_t stride = share / COUNTER_STRIPES + 1;
+  return stripe >= share || stripe % stride == 0;
+}
@@ -0,0 +1,24 @@
+/// @file
+/// @brief Implementation of counter stripe selection
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "counter.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+/// stripe index + 1 of the current thread, or 0 if not yet assigned
+static _Thread_local size_t stripe;
+
+/// next stripe index to hand out
+static atomic_size_t next;
+
+size_t counter_stripe_(void) {
+  // assign stripes to threads round-robin, so a small number of threads each
+  // get their own
+  if (stripe == 0) {
+    const size_t i = atomic_fetch_add_explicit(&next, 1, memory_order_relaxed);
+    stripe = i % COUNTER_STRIPES + 1;
+  }
+  return stripe - 1;
+}
@@ -5,52 +5,82 @@
 
 #pragma once
 
+#include "attr.h"
+#include "counter.h"
 #include <assert.h>
+#include <limits.h>
+#include <stdalign.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
+#include <ute/hazard.h>
 
 /// internal implementation of a dictionary
 ///
 /// A dictionary data structure looks like:
 ///
-///   dict_t_     dict_impl_t    ┌───────┬───────┬───────┬── ctrl slots
-///   ┌───────┐   ┌──────────┐ ┌►│   0²  │   1²  │   2²  │ …
-///   │ root¹ ├──►│   ctrl   ├─┘ └───────┴───────┴───────┴──
-///   │       │   ├──────────┤
-///   └───────┘   │   key    ├─┐ ┌───────┬───────┬───────┬── key slots
-///               ├──────────┤ └►│   0²  │   1²  │   2²  │ …
-///               │  value   ├┐  └───┬───┴───────┴───┬───┴──
-///               ├──────────┤│      ▼               ▼
-///               │   used   ││  ┌───────┐       ┌───────┐
-///               ├──────────┤│  │  key  │       │  key  │
-///               │   size   ││  └───────┘       └───────┘
-///               ├──────────┤│  ┌───────┬───────┬───────┬── value slots
-///               │ capacity │└─►│   0   │   1   │   2   │ …
-///               └──────────┘   └───┬───┴───────┴───┬───┴──
-///                                  │               │
-///                                  ▼               ▼
-///                              ┌───────┐       ┌───────┐
-///                              │ value │       │ value │
-///                              └───────┘       └───────┘
+///   dict_t_     dict_impl_t       slots
+///   ┌───────┐   ┌──────────┐      ┌───────┬───────┬───────┬───────┬───────┬──
+///   │ root¹ ├──►│   key    ├─────►│  key² │ value │ hash  │ ctrl² │  key² │ …
+///   │       │   ├──────────┤      └───┬───┴───────┴───────┴───────┴───┬───┴──
+///   └───────┘   │  value   ├──┐       ▼       ▲                       ▼
+///               ├──────────┤  │   ┌───────┐   │                   ┌───────┐
+///               │   hash   │  │   │  key  │   │                   │  key  │
+///               ├──────────┤  │   └───────┘   │                   └───────┘
+///               │   ctrl   │  └───────────────┘
+///               ├──────────┤
+///               │  stride  │
+///               ├──────────┤
+///               │   full   │
+///               ├──────────┤
+///               │ capacity │
+///               ├──────────┤
+///               │  used³   │
+///               ├──────────┤
+///               │  size³   │
+///               └──────────┘
+///
+/// Each slot is a record of its key word, value word, the hash of its key, and
+/// the key’s control block. A probe compares hashes before keys, so a mismatch
+/// rarely dereferences the key. And a probe that finds its key reads the value
+/// from the same cache line. `key`, `value`, `hash`, and `ctrl` point to the
+/// words of the first slot, and each subsequent slot’s words are `stride` bytes
+/// further on. Building with `USE_DICT_SOA` instead lays the slots out as
+/// parallel arrays, one per word, to allow comparing the two (see
+/// bench/src/bench-dict.c). Either way, slot words are only accessed through
+/// `dict_key`, `dict_key_slot`, `dict_value`, `dict_hash`, and `dict_ctrl`.
+///
+/// The slots follow `dict_impl_t` in the same allocation, which also holds the
+/// control block of the root (see `sp_make`).
+///
+/// Keys narrower than a slot (see `dict_keys_inline`) are instead stored in the
+/// key words themselves, and slots have no hash or control block. Probing then
+/// compares whole key words, without dereferencing anything.
 ///
 /// `dict_impl_t` carries no information about the size of dictionary keys or
 /// values. This is expected to be passed in by callers.
 ///
 /// ¹ This is an atomic shared pointer, 2 words wide.
 /// ² These are the two halves of a shared pointer,
-///   `(sp_t){.ptr = key[i], .impl = ctrl[i]}`.
+///   `(sp_t){.ptr = *dict_key(dict, i), .impl = *dict_ctrl(dict, i)}`.
+/// ³ These are striped counters (see ./counter.h), each stripe occupying its
+///   own cache line.
 typedef struct {
-  /// backing storage for the dictionary keys’ metadata
-  sp_ctrl_t *_Atomic *ctrl;
-
-  /// backing storage of dictionary keys
-  void *_Atomic *key;
+  /// key word of the first slot
+  ///
+  /// Inline keys are stored in the same format as inline values (see below),
+  /// without the migration bit. A slot is written once, when it is claimed for
+  /// a key, and never changes after that.
+  union {
+    void *_Atomic *key;         ///< pointers to boxed keys
+    atomic_uintptr_t *key_slot; ///< inline keys
+  };
 
-  /// backing storage of dictionary value slots
+  /// value word of the first slot
   ///
   /// The high bits of each slot’s word are the actual pointer and the low bits
   /// indicate the state of the slot:
@@ -58,22 +88,163 @@ typedef struct {
   ///              ┌─ sizeof(uintptr_t) * CHAR_BIT - 1
   ///              │                                0
   ///              ▼                                ▼
-  ///   value[i]: ┌────────────────────────────────┬─┐
+  ///      value: ┌────────────────────────────────┬─┐
   ///             └────────────────────────────────┴─┘
   ///                     pointer to value          ▲
   ///                                               │
   ///                                               │
   ///                           has been migrated? ─┘
+  ///
+  /// Values narrower than a slot (see `dict_values_inline`) are instead stored
+  /// in the slot itself, in the bytes that do not hold the state bits:
+  ///
+  ///              ┌─ sizeof(uintptr_t) * CHAR_BIT - 1
+  ///              │                                0
+  ///              ▼                                ▼
+  ///      value: ┌───────────────────────────────┬─┬─┐
+  ///             └───────────────────────────────┴─┴─┘
+  ///                          value               ▲ ▲
+  ///                                              │ │
+  ///                            contains a value? ┘ │
+  ///                                                │
+  ///                             has been migrated? ┘
+  ///
+  /// The value bytes are kept aligned and at a fixed offset into the slot, so
+  /// they can be read and written in place (see `value_slot_inline_ptr`).
   atomic_uintptr_t *value;
 
-  atomic_size_t used; ///< how many key slots are non-empty?
-  atomic_size_t size; ///< how many value slots are non-empty?
-  size_t capacity; ///< exponent + 1 of how many total slots at `key`/`value`?
+  /// hash word of the first slot, or `NULL` if keys are stored inline
+  ///
+  /// This is written before its key word, and never changes after that.
+  atomic_size_t *hash;
+
+  /// key control block word of the first slot, or `NULL` if keys are stored
+  /// inline
+  sp_ctrl_t *_Atomic *ctrl;
+
+  size_t stride; ///< byte distance between the words of consecutive slots
+
+  atomic_bool full; ///< has the dictionary reached its load factor?
+  size_t capacity;  ///< exponent + 1 of how many total slots?
+
+  bool inline_keys;    ///< are keys stored in their slots?
+  size_t key_offset;   ///< byte offset of inline keys within their slots
+  bool inline_values;  ///< are values stored in their slots?
+  size_t value_offset; ///< byte offset of inline values within their slots
+
+  counter_t used; ///< how many key slots are non-empty?
+  counter_t size; ///< how many value slots are non-empty?
 } dict_impl_t;
 
 /// get the capacity (in slots) of a dictionary
-static inline size_t dict_capacity(const dict_impl_t dict) {
-  return (size_t)1 << dict.capacity >> 1;
+static inline size_t dict_capacity(const dict_impl_t *dict) {
+  return (size_t)1 << dict->capacity >> 1;
+}
+
+/// get the key word of a slot holding a boxed key
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the slot’s key word
+static inline void *_Atomic *dict_key(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(!dict->inline_keys);
+  assert(index < dict_capacity(dict));
+  return (void *)((unsigned char *)dict->key + index * dict->stride);
+}
+
+/// get the key word of a slot holding an inline key
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the slot’s key word
+static inline atomic_uintptr_t *dict_key_slot(dict_impl_t *dict,
+                                              size_t index) {
+  assert(dict != NULL);
+  assert(dict->inline_keys);
+  assert(index < dict_capacity(dict));
+  return (void *)((unsigned char *)dict->key_slot + index * dict->stride);
+}
+
+/// get the hash word of a slot holding a boxed key
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the slot’s hash word
+static inline atomic_size_t *dict_hash(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(!dict->inline_keys);
+  assert(index < dict_capacity(dict));
+  return (void *)((unsigned char *)dict->hash + index * dict->stride);
+}
+
+/// get the key control block word of a slot holding a boxed key
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the slot’s control block word
+static inline sp_ctrl_t *_Atomic *dict_ctrl(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(!dict->inline_keys);
+  assert(index < dict_capacity(dict));
+  return (void *)((unsigned char *)dict->ctrl + index * dict->stride);
+}
+
+/// get the value word of a slot
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the slot’s value word
+static inline atomic_uintptr_t *dict_value(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(index < dict_capacity(dict));
+  return (void *)((unsigned char *)dict->value + index * dict->stride);
+}
+
+/// percentage occupancy at which we expand the backing storage
+enum { LOAD_FACTOR = 70 };
+
+/// does a dictionary need to be expanded before inserting into it?
+///
+/// @param dict Dictionary to inspect, or `NULL` for an uninitialised dictionary
+/// @return True if the dictionary is at or above its load factor
+static inline bool dict_is_full(dict_impl_t *dict) {
+  if (dict == NULL)
+    return true;
+  return atomic_load_explicit(&dict->full, memory_order_acquire);
+}
+
+/// account for a key having been written into a previously empty slot
+///
+/// This is where a dictionary notices it has reached its load factor.
+///
+/// @param dict Dictionary that was inserted into
+static inline void dict_add_used(dict_impl_t *dict) {
+  assert(dict != NULL);
+
+  const size_t limit = dict_capacity(dict) * LOAD_FACTOR / 100;
+  const size_t stripe = counter_add(&dict->used, 1);
+  if (!counter_should_check(stripe, limit))
+    return;
+
+  const size_t used = counter_read(&dict->used);
+  if (used * 100 >= dict_capacity(dict) * LOAD_FACTOR)
+    atomic_store_explicit(&dict->full, true, memory_order_release);
+}
+
+/// get the capacity of the smallest dictionary that holds `n` entries without
+/// reaching its load factor
+///
+/// @param n Number of entries, at most `SIZE_MAX / 100`
+/// @return Exponent + 1 of the number of slots needed
+static inline size_t dict_capacity_for(size_t n) {
+  assert(n <= SIZE_MAX / 100);
+
+  size_t c = 1;
+  while (c < sizeof(size_t) * CHAR_BIT &&
+         ((size_t)1 << c >> 1) * LOAD_FACTOR <= n * 100)
+    ++c;
+  return c;
 }
 
 /// atomically read a control pointer
@@ -86,6 +257,26 @@ static inline void *key_load(void *_Atomic *src) {
   return atomic_load_explicit(src, memory_order_acquire);
 }
 
+/// atomically read an inline key slot
+static inline uintptr_t key_slot_load(atomic_uintptr_t *src) {
+  return atomic_load_explicit(src, memory_order_acquire);
+}
+
+/// read a hash word
+///
+/// This is only meaningful after an acquiring read of the corresponding
+/// non-null key word.
+static inline size_t hash_load(atomic_size_t *src) {
+  return atomic_load_explicit(src, memory_order_relaxed);
+}
+
+/// write the hash word of a newly claimed slot
+///
+/// This must precede releasing the corresponding key word.
+static inline void hash_store(atomic_size_t *dst, size_t hash) {
+  atomic_store_explicit(dst, hash, memory_order_relaxed);
+}
+
 /// atomically read a value slot
 static inline uintptr_t value_slot_load(atomic_uintptr_t *slotptr) {
   return atomic_load_explicit(slotptr, memory_order_acquire);
@@ -108,6 +299,16 @@ static inline void key_store(void *_Atomic *dst, void *src) {
   atomic_store_explicit(dst, src, memory_order_release);
 }
 
+/// atomically compare-and-swap into an empty inline key slot
+static inline bool key_slot_cas(atomic_uintptr_t *dst, uintptr_t *expected,
+                                uintptr_t desired) {
+  assert(expected != NULL);
+  assert(*expected == 0 && "overwriting non-empty key slot");
+  assert(desired != 0);
+  return atomic_compare_exchange_strong_explicit(
+      dst, expected, desired, memory_order_acq_rel, memory_order_acquire);
+}
+
 /// atomically compare-and-swap into a hash table value slot
 static inline bool value_slot_cas(atomic_uintptr_t *slotptr,
                                   uintptr_t *expected, uintptr_t desired) {
@@ -138,3 +339,209 @@ static inline void *value_slot_to_ptr(uintptr_t slot) {
 static inline bool value_slot_is_free(uintptr_t slot) {
   return value_slot_to_ptr(slot) == NULL;
 }
+
+/// are a dictionary’s keys stored directly in its key slots?
+///
+/// The criteria are the same as for values (see `dict_values_inline`). Such
+/// dictionaries never allocate or reference count a key.
+///
+/// @param sig Signature of the dictionary
+/// @return True if keys are stored inline
+static inline bool dict_keys_inline(dict_sig_t_ sig) {
+  return sig.key_size < sizeof(uintptr_t) &&
+         sig.key_alignment <= alignof(uintptr_t) && sig.key_dtor == NULL;
+}
+
+/// are a dictionary’s values stored directly in its value slots?
+///
+/// This is the case for values that leave room in a slot for its state bits,
+/// and need no destructor. The criteria match those of `SET_CAN_UNBOX_`. Such
+/// dictionaries never allocate or free a value.
+///
+/// @param sig Signature of the dictionary
+/// @return True if values are stored inline
+static inline bool dict_values_inline(dict_sig_t_ sig) {
+  return sig.value_size < sizeof(uintptr_t) &&
+         sig.value_alignment <= alignof(uintptr_t) && sig.value_dtor == NULL;
+}
+
+/// mask for the present bit of an inline slot (see above)
+enum { PRESENT = (uintptr_t)2 };
+
+/// get the byte offset of an inline key or value within its slot
+///
+/// The state bits are the least significant, so the data goes at whichever end
+/// of the slot does not hold them.
+///
+/// @param size Size of the key or value in bytes, less than a slot
+/// @return Offset in bytes
+static inline size_t inline_offset(size_t size) {
+  assert(size < sizeof(uintptr_t));
+  const uintptr_t one = 1;
+  const bool little_endian = *(const unsigned char *)&one == 1;
+  return little_endian ? sizeof(uintptr_t) - size : 0;
+}
+
+/// construct an inline slot
+///
+/// @param src Key or value to store
+/// @param size Size of `src` in bytes
+/// @return The slot’s representation
+static inline uintptr_t slot_inline(const void *src, size_t size) {
+  assert(src != NULL || size == 0);
+
+  // Check `size` fits, even though callers guarantee it, so that compilers
+  // propagating a wider size into here can see it is never copied.
+  uintptr_t slot = PRESENT;
+  if (size > 0 && size < sizeof(slot))
+    memcpy((unsigned char *)&slot + inline_offset(size), src, size);
+  return slot;
+}
+
+/// construct an inline key slot
+///
+/// @param key Key to store
+/// @param sig Signature of the dictionary
+/// @return The slot’s representation
+static inline uintptr_t key_slot_inline(const void *key, dict_sig_t_ sig) {
+  assert(dict_keys_inline(sig));
+  return slot_inline(key, sig.key_size);
+}
+
+/// construct an inline value slot
+///
+/// @param value Value to store
+/// @param sig Signature of the dictionary
+/// @return The slot’s representation
+static inline uintptr_t value_slot_inline(const void *value, dict_sig_t_ sig) {
+  assert(dict_values_inline(sig));
+  return slot_inline(value, sig.value_size);
+}
+
+/// get a pointer to the key within an inline key slot
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the key
+static inline void *key_slot_inline_ptr(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(dict->inline_keys);
+  assert(index < dict_capacity(dict));
+  return (unsigned char *)dict_key_slot(dict, index) + dict->key_offset;
+}
+
+/// get a pointer to the value within an inline value slot
+///
+/// @param dict Dictionary the slot belongs to
+/// @param index Index of the slot
+/// @return Pointer to the value
+static inline void *value_slot_inline_ptr(dict_impl_t *dict, size_t index) {
+  assert(dict != NULL);
+  assert(dict->inline_values);
+  assert(index < dict_capacity(dict));
+  return (unsigned char *)dict_value(dict, index) + dict->value_offset;
+}
+
+/// find the slot holding a key
+///
+/// Slots that have been claimed for a key that is not yet written are treated
+/// as empty, ending the probe.
+///
+/// @param dict Dictionary to search
+/// @param key Key to seek
+/// @param hash Hash of `key`
+/// @param sig Signature of the dictionary
+/// @return Index of the key’s slot, or the dictionary’s capacity if not found
+static inline size_t dict_find(dict_impl_t *dict, const void *key, size_t hash,
+                               dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+
+  const size_t capacity = dict_capacity(dict);
+
+  // inline keys compare equal exactly when their slots do
+  if (dict->inline_keys) {
+    const uintptr_t want = key_slot_inline(key, sig);
+    for (size_t i = 0; i < capacity; ++i) {
+      const size_t index = (hash + i) % capacity;
+      const uintptr_t k = key_slot_load(dict_key_slot(dict, index));
+
+      // if this slot is unoccupied, we have probed as far as the key could be
+      if (k == 0)
+        break;
+
+      if (k == want)
+        return index;
+    }
+    return capacity;
+  }
+
+  for (size_t i = 0; i < capacity; ++i) {
+    const size_t index = (hash + i) % capacity;
+    const void *const k = key_load(dict_key(dict, index));
+
+    // if this slot is unoccupied, we have probed as far as the key could be
+    if (k == NULL)
+      break;
+
+    // only keys with the same hash can be equal
+    if (hash_load(dict_hash(dict, index)) != hash)
+      continue;
+
+    if (sig.key_size == 0 || memcmp(k, key, sig.key_size) == 0)
+      return index;
+  }
+  return capacity;
+}
+
+/// thread-local copies of inline values returned by `dict_get_protected_`, one
+/// per hazard pointer slot
+extern PRIVATE _Thread_local uintptr_t dict_protected_[HAZARD_SLOTS];
+
+/// insert/update an entry in a dictionary table
+///
+/// The return value means:
+///   • 0 – the entry was inserted or updated
+///   • `ENOMEM` – not enough space to insert the entry
+///
+/// For a dictionary with inline keys, `key.impl` is `NULL` and `key.ptr` need
+/// only remain valid for the duration of the call.
+///
+/// @param owner Dictionary `dict` is the root of, or `NULL` for a table being
+///   migrated into, whose values can not yet be overwritten
+/// @param dict Dictionary to operate on
+/// @param key Key of entry to insert/update
+/// @param hash Hash of `key`
+/// @param value Value slot to store, either a pointer to a boxed value or an
+///   inline value
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno otherwise
+PRIVATE int dict_put_(dict_t_ *owner, dict_impl_t *dict, sp_t key, size_t hash,
+                      uintptr_t value, dict_sig_t_ sig);
+
+/// deallocate a value that was overwritten or removed
+///
+/// If a reader has ever retrieved a boxed value from the dictionary through
+/// `dict_get_protected_`, the value may still be in use. In that case, it is
+/// retired (see ute/hazard.h) rather than deallocated immediately.
+///
+/// @param owner Dictionary the value was removed from
+/// @param value Value to deallocate, or `NULL` for a no-op
+/// @param value_dtor Optional user-supplied value destructor
+PRIVATE void dict_retire_value_(dict_t_ *owner, void *value,
+                                void (*value_dtor)(void *));
+
+/// migrate a dictionary into a new table
+///
+/// The return value means:
+///   • 0 – the new table was installed as the root
+///   • `EALREADY` – someone else migrated or initialised the dictionary first
+///   • `ENOMEM` – out of memory
+///
+/// @param dict Dictionary to operate on
+/// @param sp Reference to the current root of the dictionary
+/// @param capacity Exponent + 1 of the number of slots in the new table
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno otherwise
+PRIVATE int dict_resize_(dict_t_ *dict, sp_t sp, size_t capacity,
+                         dict_sig_t_ sig);
@@ -4,20 +4,19 @@
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #include "dict.h"
+#include "hash.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <string.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
-#include <ute/hash.h>
 
 bool dict_contains_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
   assert(dict != NULL);
   assert(key != NULL || sig.key_size == 0);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(key, sig.key_size);
+  const size_t h = hash_item(sig.hash, key, sig.key_size);
 
   // acquire a reference to the dictionary
   sp_t sp = sp_acq(&dict->root);
@@ -28,30 +27,19 @@ bool dict_contains_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
 
   dict_impl_t *const d = sp.ptr;
 
-  for (size_t i = 0; i < dict_capacity(*d); ++i) {
-    const size_t index = (h + i) % dict_capacity(*d);
-    const void *const k = key_load(&d->key[index]);
-
-    // if we see an empty slot, we have probed as far as this item would be
-    if (k == NULL)
-      break;
-
-    // if this our sought item?
-    if (sig.key_size != 0 && memcmp(key, k, sig.key_size) != 0)
-      continue;
-
-    // load the corresponding value slot
-    const uintptr_t v = value_slot_load(&d->value[index]);
-
+  const size_t index = dict_find(d, key, h, sig);
+  if (index == dict_capacity(d)) {
     sp_rel(sp);
-
-    // skip checking whether this slot is moved or not, because we do not care
-    // if we are racing with a rehashing and reading an older stale copy of the
-    // table
-
-    return !value_slot_is_free(v);
+    return false;
   }
 
+  // load the corresponding value slot
+  const uintptr_t v = value_slot_load(dict_value(d, index));
+
   sp_rel(sp);
-  return false;
+
+  // skip checking whether this slot is moved or not, because we do not care if
+  // we are racing with a rehashing and reading an older stale copy of the table
+
+  return !value_slot_is_free(v);
 }
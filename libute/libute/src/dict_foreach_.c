@@ -0,0 +1,58 @@
+/// @file
+/// @brief Implementation of dictionary iteration
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "dict.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/dict.h>
+
+int dict_foreach_(dict_t_ *dict,
+                  int (*callback)(const void *, void *, void *),
+                  void *context) {
+  assert(dict != NULL);
+  assert(callback != NULL);
+
+  // acquire a reference to the dictionary, which keeps every key in it alive
+  sp_t sp = sp_acq(&dict->root);
+
+  // if the dictionary is uninitialised, it is semantically empty
+  if (sp.ptr == NULL)
+    return 0;
+
+  dict_impl_t *const d = sp.ptr;
+
+  // Walk only the table we hold. If it has been migrated, slots that have been
+  // moved retain their entries, so we still see everything that was present
+  // when the migration began.
+  int rc = 0;
+  for (size_t i = 0; i < dict_capacity(d); ++i) {
+    const void *k = NULL;
+    if (!d->inline_keys) {
+      k = key_load(dict_key(d, i));
+    } else if (key_slot_load(dict_key_slot(d, i)) != 0) {
+      k = key_slot_inline_ptr(d, i);
+    }
+
+    // skip unoccupied slots
+    if (k == NULL)
+      continue;
+
+    // skip deleted entries
+    const uintptr_t v = value_slot_load(dict_value(d, i));
+    if (value_slot_is_free(v))
+      continue;
+
+    void *const value =
+        d->inline_values ? value_slot_inline_ptr(d, i) : value_slot_to_ptr(v);
+    rc = callback(k, value, context);
+    if (rc != 0)
+      break;
+  }
+
+  sp_rel(sp);
+  return rc;
+}
@@ -4,9 +4,11 @@
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
+#include <ute/hazard.h>
 
 void dict_free_(dict_t_ *dict) {
   assert(dict != NULL);
@@ -14,4 +16,10 @@ void dict_free_(dict_t_ *dict) {
   // overwriting the root with a null pointer is enough to free the dictionary
   sp_t null = sp_new(0, NULL, NULL);
   sp_store(&dict->root, null);
+
+  // if values have been read with protection, those this thread overwrote or
+  // removed earlier may still be awaiting deallocation, so reclaim whatever no
+  // reader is still protecting
+  if (atomic_load_explicit(&dict->protected_reads, memory_order_relaxed))
+    hazard_scan();
 }
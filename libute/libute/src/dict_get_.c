@@ -4,53 +4,46 @@
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #include "dict.h"
+#include "hash.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <string.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
-#include <ute/hash.h>
 
 void *dict_get_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
   assert(dict != NULL);
   assert(key != NULL || sig.key_size == 0);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(key, sig.key_size);
+  const size_t h = hash_item(sig.hash, key, sig.key_size);
 
-  // acquire a reference to the dictionary
-  sp_t sp = sp_acq(&dict->root);
+  // Read the dictionary without acquiring a reference to it. Our precondition
+  // is that no modifier runs concurrently, so nothing can release it under us.
+  dict_impl_t *const d = sp_peek_(&dict->root);
 
   // if the dictionary is uninitialised, it is semantically empty
-  if (sp.ptr == NULL)
+  if (d == NULL)
     return NULL;
 
-  dict_impl_t *const d = sp.ptr;
-
-  for (size_t i = 0; i < dict_capacity(*d); ++i) {
-    const size_t index = (h + i) % dict_capacity(*d);
-    const void *const k = key_load(&d->key[index]);
-
-    // if this slot is unoccupied, we have probed as far as the item could be
-    if (k == NULL)
-      break;
-
-    // is this our sought item?
-    if (sig.key_size != 0 && memcmp(k, key, sig.key_size) != 0)
-      continue;
-
-    // load the corresponding value slot
-    const uintptr_t v = value_slot_load(&d->value[index]);
+  const size_t index = dict_find(d, key, h, sig);
+  if (index == dict_capacity(d))
+    return NULL;
 
-    sp_rel(sp);
+  // load the corresponding value slot
+  const uintptr_t v = value_slot_load(dict_value(d, index));
 
-    // we should not encounter anyone else rehashing the dictionary because this
-    // violates our precondition
-    assert(!value_slot_is_moved(v) && "race between DICT_GET and modifier");
+  // we should not encounter anyone else rehashing the dictionary because this
+  // violates our precondition
+  assert(!value_slot_is_moved(v) && "race between DICT_GET and modifier");
 
-    return value_slot_to_ptr(v);
+  // an inline value can be accessed in place, because our precondition also
+  // means no one will overwrite it while our caller uses it
+  if (d->inline_values) {
+    if (value_slot_is_free(v))
+      return NULL;
+    return value_slot_inline_ptr(d, index);
   }
 
-  sp_rel(sp);
-  return NULL;
+  return value_slot_to_ptr(v);
 }
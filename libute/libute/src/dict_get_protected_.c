@@ -0,0 +1,93 @@
+/// @file
+/// @brief Implementation of protected dictionary retrieval
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "dict.h"
+#include "hash.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/dict.h>
+#include <ute/hazard.h>
+
+void *dict_get_protected_(dict_t_ *dict, const void *key, size_t slot,
+                          dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+  assert(slot < HAZARD_SLOTS);
+
+  const size_t h = hash_item(sig.hash, key, sig.key_size);
+
+  backoff_t backoff = {0};
+retry1:;
+  // acquire a reference to the dictionary
+  sp_t sp = sp_acq(&dict->root);
+
+  // if the dictionary is uninitialised, it is semantically empty
+  if (sp.ptr == NULL)
+    goto not_found;
+
+  dict_impl_t *const d = sp.ptr;
+
+  const size_t index = dict_find(d, key, h, sig);
+  if (index == dict_capacity(d))
+    goto release;
+
+  // load the corresponding value slot
+  uintptr_t v = value_slot_load(dict_value(d, index));
+
+retry2:
+  // A value in a migrated slot is owned by the new table, where it can be
+  // overwritten and retired without this slot changing. So seeing it here again
+  // would not prove it is still live.
+  if (value_slot_is_moved(v)) {
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry1;
+  }
+
+  // is this entry deleted?
+  if (value_slot_is_free(v))
+    goto release;
+
+  // An inline value has no storage of its own to protect. Instead, return a
+  // copy taken from our atomic read of its slot, which stays valid until we
+  // next use this hazard pointer slot.
+  if (d->inline_values) {
+    dict_protected_[slot] = v;
+    sp_rel(sp);
+    hazard_clear(slot);
+    return (unsigned char *)&dict_protected_[slot] + d->value_offset;
+  }
+
+  // Boxed values are only retired through hazard pointers once a reader may be
+  // relying on it, so announce ourselves before protecting this one. The fence
+  // in `hazard_set` orders this before our re-read of the slot.
+  if (!atomic_load_explicit(&dict->protected_reads, memory_order_relaxed))
+    atomic_store_explicit(&dict->protected_reads, true, memory_order_relaxed);
+
+  // Protect the value and check it is still in place. Anyone replacing it from
+  // here on retires it only after we published it, so will not free it.
+  hazard_set(slot, value_slot_to_ptr(v));
+  const uintptr_t again = value_slot_load(dict_value(d, index));
+  if (again != v) {
+    v = again;
+    backoff_(&backoff);
+    goto retry2;
+  }
+
+  sp_rel(sp);
+  return value_slot_to_ptr(v);
+
+release:
+  sp_rel(sp);
+
+not_found:
+  hazard_clear(slot);
+  return NULL;
+}
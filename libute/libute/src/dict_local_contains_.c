@@ -0,0 +1,20 @@
+/// @file
+/// @brief Implementation of dictionary existence check, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+bool dict_local_contains_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+
+  const local_layout_t layout = local_dict_layout(sig);
+  const size_t h = local_hash(key, layout);
+  return local_find(dict->local, key, h, layout) != SIZE_MAX;
+}
@@ -0,0 +1,36 @@
+/// @file
+/// @brief Implementation of dictionary iteration, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/dict.h>
+
+int dict_local_foreach_(dict_t_ *dict,
+                        int (*callback)(const void *, void *, void *),
+                        void *context) {
+  assert(dict != NULL);
+  assert(callback != NULL);
+
+  const local_table_t *const t = dict->local;
+
+  // if the table has not yet been allocated, the dictionary is empty
+  if (t == NULL)
+    return 0;
+
+  // we were not given the dictionary’s signature, but the table knows its own
+  // layout
+  const local_layout_t layout = t->layout;
+  for (size_t i = 0; i < local_slots(t); ++i) {
+    if (!local_is_full_slot(t, i))
+      continue;
+    unsigned char *const entry = local_entry(t, i, layout);
+    const int rc = callback(entry, entry + layout.value_offset, context);
+    if (rc != 0)
+      return rc;
+  }
+
+  return 0;
+}
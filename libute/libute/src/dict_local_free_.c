@@ -0,0 +1,18 @@
+/// @file
+/// @brief Implementation of dictionary destruction, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/dict.h>
+
+void dict_local_free_(dict_t_ *dict) {
+  assert(dict != NULL);
+
+  // the table remembers the key and value destructors, so we do not need the
+  // signature
+  local_table_destroy(dict->local);
+  dict->local = NULL;
+}
@@ -0,0 +1,26 @@
+/// @file
+/// @brief Implementation of dictionary retrieval, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+void *dict_local_get_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+
+  const local_layout_t layout = local_dict_layout(sig);
+  const local_table_t *const t = dict->local;
+
+  const size_t h = local_hash(key, layout);
+  const size_t index = local_find(t, key, h, layout);
+  if (index == SIZE_MAX)
+    return NULL;
+
+  unsigned char *const entry = local_entry(t, index, layout);
+  return entry + layout.value_offset;
+}
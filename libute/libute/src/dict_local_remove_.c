@@ -0,0 +1,33 @@
+/// @file
+/// @brief Implementation of dictionary removal, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+bool dict_local_remove_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+
+  const local_layout_t layout = local_dict_layout(sig);
+  local_table_t *const t = dict->local;
+
+  const size_t h = local_hash(key, layout);
+  const size_t index = local_find(t, key, h, layout);
+  if (index == SIZE_MAX)
+    return false;
+
+  unsigned char *const entry = local_entry(t, index, layout);
+  if (sig.key_dtor != NULL)
+    sig.key_dtor(entry);
+  if (sig.value_dtor != NULL)
+    sig.value_dtor(entry + layout.value_offset);
+  local_vacate(t, index);
+
+  return true;
+}
@@ -0,0 +1,31 @@
+/// @file
+/// @brief Implementation of dictionary pre-sizing, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+int dict_local_reserve_(dict_t_ *dict, size_t n, dict_sig_t_ sig) {
+  assert(dict != NULL);
+
+  if (n > SIZE_MAX / 100)
+    return ENOMEM;
+
+  // is the backing storage already large enough?
+  const size_t slots = local_slots_for(n);
+  local_table_t *t = dict->local;
+  if (t != NULL && local_slots(t) >= slots)
+    return 0;
+
+  const int rc = local_table_resize_(&t, slots, local_dict_layout(sig));
+  if (rc != 0)
+    return rc;
+  dict->local = t;
+
+  return 0;
+}
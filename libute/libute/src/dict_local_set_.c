@@ -0,0 +1,53 @@
+/// @file
+/// @brief Implementation of dictionary insertion, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ute/dict.h>
+
+int dict_local_set_(dict_t_ *dict, void *key, void *value, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key != NULL || sig.key_size == 0);
+  assert(value != NULL || sig.value_size == 0);
+
+  const local_layout_t layout = local_dict_layout(sig);
+  local_table_t *t = dict->local;
+
+  {
+    const int rc = local_make_room(&t, layout);
+    if (rc != 0) {
+      if (sig.value_dtor != NULL)
+        sig.value_dtor(value);
+      if (sig.key_dtor != NULL)
+        sig.key_dtor(key);
+      return rc;
+    }
+    dict->local = t;
+  }
+
+  const size_t h = local_hash(key, layout);
+  bool found;
+  const size_t index = local_probe(t, key, h, layout, &found);
+  unsigned char *const entry = local_entry(t, index, layout);
+
+  if (found) {
+    // replace the existing value, keeping the existing key
+    if (sig.value_dtor != NULL)
+      sig.value_dtor(entry + layout.value_offset);
+    if (sig.key_dtor != NULL)
+      sig.key_dtor(key);
+  } else {
+    if (sig.key_size > 0)
+      memcpy(entry, key, sig.key_size);
+    local_occupy(t, index, h);
+  }
+  if (sig.value_size > 0)
+    memcpy(entry + layout.value_offset, value, sig.value_size);
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+/// @file
+/// @brief Implementation of dictionary size, for local dictionary
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/dict.h>
+
+size_t dict_local_size_(dict_t_ *dict) {
+  assert(dict != NULL);
+
+  const local_table_t *const t = dict->local;
+  return t == NULL ? 0 : t->size;
+}
@@ -0,0 +1,291 @@
+/// @file
+/// @brief Implementation of dictionary expansion and migration
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "dict.h"
+#include "hash.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/aligned_alloc.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+
+/// release the contents of a dictionary that is going out of scope
+///
+/// @param dict Dictionary to operate on
+/// @param context Optional user-supplied value destructor
+static void dict_dtor(void *dict, void *context) {
+  assert(dict != NULL);
+
+  dict_impl_t *const d = dict;
+  void (*value_dtor)(void *) = context;
+
+  // free our keys, unless they live in our slots
+  for (size_t i = 0; i < dict_capacity(d) && !d->inline_keys; ++i) {
+    void *const k = key_load(dict_key(d, i));
+    sp_ctrl_t *const c = ctrl_load(dict_ctrl(d, i));
+    sp_t sp = {.ptr = k, .impl = c};
+    sp_rel(sp);
+  }
+
+  // free our values, unless they live in our slots
+  for (size_t i = 0; i < dict_capacity(d) && !d->inline_values; ++i) {
+    const uintptr_t v = value_slot_load(dict_value(d, i));
+    if (value_slot_is_moved(v))
+      continue;
+    void *const value = value_slot_to_ptr(v);
+    if (value != NULL && value_dtor != NULL)
+      value_dtor(value);
+    ALIGNED_FREE(value);
+  }
+
+  // our slots live in the same allocation as us, freed by our caller
+}
+
+int dict_put_(dict_t_ *owner, dict_impl_t *dict, sp_t key, size_t hash,
+              uintptr_t value, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(key.ptr != NULL || sig.key_size == 0);
+  assert((key.impl == NULL) == dict->inline_keys);
+  assert(!value_slot_is_free(value));
+  assert(!value_slot_is_moved(value));
+
+  // has `key` been saved somewhere or `sp_rel`-ed? Inline keys are copied, so
+  // are never held on to.
+  bool key_consumed = dict->inline_keys;
+
+  const uintptr_t want = dict->inline_keys ? key_slot_inline(key.ptr, sig) : 0;
+
+  backoff_t backoff = {0};
+  for (size_t i = 0; i < dict_capacity(dict); ++i) {
+    const size_t index = (hash + i) % dict_capacity(dict);
+
+    if (dict->inline_keys) {
+      uintptr_t k = key_slot_load(dict_key_slot(dict, index));
+
+    retry0:
+      // if this slot is empty, try to claim it as ours
+      if (k == 0) {
+        if (!key_slot_cas(dict_key_slot(dict, index), &k, want)) {
+          backoff_(&backoff);
+          goto retry0;
+        }
+        dict_add_used(dict);
+      } else if (k != want) {
+        // this slot is not ours, so skip it
+        continue;
+      }
+
+    } else {
+      sp_ctrl_t *c = ctrl_load(dict_ctrl(dict, index));
+
+    retry1:
+      // if this slot is empty, try to claim it as ours
+      if (c == NULL) {
+        if (!ctrl_cas(dict_ctrl(dict, index), &c, key.impl)) {
+          backoff_(&backoff);
+          goto retry1;
+        }
+
+        hash_store(dict_hash(dict, index), hash);
+        key_store(dict_key(dict, index), key.ptr);
+
+        // Note that we saved the key somewhere globally visible. This
+        // effectively counts as our 1 reference. But it is fine to hang on to
+        // the (semantically no longer accounted for) `key` because we hold a
+        // reference to `dict`. This reference prevents the key we just wrote
+        // being destructed.
+        key_consumed = true;
+        dict_add_used(dict);
+
+      } else {
+      retry2:;
+        // if this slot is not ours, skip it
+        const void *const k = key_load(dict_key(dict, index));
+        if (k == NULL) {
+          backoff_(&backoff);
+          goto retry2;
+        }
+        if (hash_load(dict_hash(dict, index)) != hash)
+          continue;
+        if (sig.key_size != 0 && memcmp(k, key.ptr, sig.key_size) != 0)
+          continue;
+      }
+    }
+
+    // load the corresponding value slot
+    uintptr_t v = value_slot_load(dict_value(dict, index));
+
+  retry3:
+    // has someone else begun a migration?
+    if (value_slot_is_moved(v)) {
+      // If we are only implicitly holding a reference count for `key`, make
+      // this explicit now. Our caller wants to retry on our failure and,
+      // without this, will unknowingly be reusing a consumed pointer.
+      if (key_consumed && !dict->inline_keys)
+        (void)sp_dup(key);
+
+      return ENOMEM;
+    }
+
+    // store our updated value
+    if (!value_slot_cas(dict_value(dict, index), &v, value)) {
+      backoff_(&backoff);
+      goto retry3;
+    }
+
+    // cleanup any value we just overwrote
+    if (!dict->inline_values)
+      dict_retire_value_(owner, value_slot_to_ptr(v), sig.value_dtor);
+    if (value_slot_is_free(v))
+      (void)counter_add(&dict->size, 1);
+
+    // if we did not use the key, discard it
+    if (!key_consumed)
+      sp_rel(key);
+
+    return 0;
+  }
+
+  return ENOMEM;
+}
+
+
+/// insert everything from one dictionary into another
+///
+/// The destination dictionary is assumed to have enough space to store all
+/// entries from the source dictionary without expansion. On success, the source
+/// dictionary is “consumed” in that the destination takes ownership over all
+/// its values.
+///
+/// @param dst Dictionary to insert into
+/// @param src Dictionary to insert from
+/// @param sig Signature of the dictionary
+/// @return 0 on success or an errno on failure
+static int rehash(dict_impl_t *dst, dict_impl_t *src, dict_sig_t_ sig) {
+  assert(dst != NULL);
+  assert(src == NULL || dict_capacity(dst) >= dict_capacity(src));
+
+  // nothing to do for an uninitialised dictionary
+  if (src == NULL)
+    return 0;
+
+  backoff_t backoff = {0};
+  for (size_t i = 0; i < dict_capacity(src); ++i) {
+    uintptr_t v = value_slot_load(dict_value(src, i));
+  retry:
+
+    // Did someone else beat us to migration? CASing in the “migrated” bit to
+    // the first slot is how we authoritatively claim that we and only we are
+    // migrating this dictionary, so we should only ever race with other
+    // migrators on the first slot.
+    if (value_slot_is_moved(v)) {
+      assert(i == 0 && "another migrator skipped the first slot");
+      return EALREADY;
+    }
+
+    // mark this slot as migrated
+    if (!value_slot_cas(dict_value(src, i), &v, value_slot_moved(v))) {
+      // an inserter or deleter (or migrator if i == 0) beat us
+      backoff_(&backoff);
+      goto retry;
+    }
+
+    if (value_slot_is_free(v))
+      continue;
+
+    // An inline key can be passed from its slot, which stays put while we hold
+    // a reference to the source table, and is cheap to rehash. Otherwise take a
+    // new reference to the key for the destination and reuse its stored hash.
+    sp_t copy;
+    size_t h;
+    if (src->inline_keys) {
+      assert(key_slot_load(dict_key_slot(src, i)) != 0 &&
+             "value associated with empty key slot");
+      copy = (sp_t){.ptr = key_slot_inline_ptr(src, i)};
+      h = hash_item(sig.hash, copy.ptr, sig.key_size);
+    } else {
+      sp_ctrl_t *const c = ctrl_load(dict_ctrl(src, i));
+      assert(c != NULL && "value associated with key without control block");
+      void *const k = key_load(dict_key(src, i));
+      assert(k != NULL && "value associated with null key");
+
+      const sp_t item = {.ptr = k, .impl = c};
+      copy = sp_dup(item);
+      h = hash_load(dict_hash(src, i));
+    }
+    const int rc UNUSED = dict_put_(NULL, dst, copy, h, v, sig);
+    assert(rc == 0 && "rehash destination not owned exclusively?");
+  }
+
+  return 0;
+}
+
+int dict_resize_(dict_t_ *dict, sp_t sp, size_t capacity, dict_sig_t_ sig) {
+  assert(dict != NULL);
+  assert(capacity > 0);
+
+  dict_impl_t *const d = sp.ptr;
+
+  // allocate the table, its slots, and its control block all together
+  static_assert(sizeof(void *) == sizeof(uintptr_t) &&
+                    sizeof(size_t) == sizeof(uintptr_t) &&
+                    sizeof(sp_ctrl_t *) == sizeof(uintptr_t),
+                "slot words differ in size");
+  const bool inline_keys = dict_keys_inline(sig);
+  const size_t slots = (size_t)1 << capacity >> 1;
+  const size_t word = sizeof(uintptr_t);
+  const size_t words = inline_keys ? 2 : 4; // key, value[, hash, ctrl]
+  const size_t slot_size = words * word;
+  if (slots > (SIZE_MAX - sizeof(dict_impl_t)) / slot_size)
+    return ENOMEM;
+  sp_t new_sp = sp_make(sizeof(dict_impl_t) + slots * slot_size,
+                        alignof(dict_impl_t), dict_dtor, sig.value_dtor);
+  if (new_sp.ptr == NULL)
+    return ENOMEM;
+
+  // `dict_impl_t` is cache line aligned and slots are a power of 2 in size, so
+  // slots following it start on a cache line and no slot straddles two
+  dict_impl_t *const new = new_sp.ptr;
+  unsigned char *const base = (unsigned char *)new + sizeof(*new);
+#ifdef USE_DICT_SOA
+  const size_t column = slots * word;
+  new->stride = word;
+#else
+  const size_t column = word;
+  new->stride = slot_size;
+#endif
+  new->key = (void *)base;
+  new->value = (void *)(base + column);
+  new->hash = inline_keys ? NULL : (void *)(base + 2 * column);
+  new->ctrl = inline_keys ? NULL : (void *)(base + 3 * column);
+  new->capacity = capacity;
+  new->inline_keys = inline_keys;
+  if (inline_keys)
+    new->key_offset = inline_offset(sig.key_size);
+  new->inline_values = dict_values_inline(sig);
+  if (new->inline_values)
+    new->value_offset = inline_offset(sig.value_size);
+
+  if (rehash(new, d, sig) != 0) {
+    sp_rel(new_sp);
+    return EALREADY;
+  }
+
+  const bool r = sp_cas(&dict->root, sp, new_sp);
+  assert((r || sp.ptr == NULL) && "successful migrations race one another");
+  if (!r) {
+    sp_rel(new_sp);
+    return EALREADY;
+  }
+
+  return 0;
+}
@@ -0,0 +1,10 @@
+/// @file
+/// @brief Storage for copies of protected inline dictionary values
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "dict.h"
+#include <stdint.h>
+#include <ute/hazard.h>
+
+_Thread_local uintptr_t dict_protected_[HAZARD_SLOTS];
@@ -3,23 +3,21 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
 #include "dict.h"
+#include "hash.h"
 #include <assert.h>
-#include <stdatomic.h>
 #include <stdbool.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ute/aligned_alloc.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
-#include <ute/hash.h>
 
 bool dict_remove_(dict_t_ *dict, const void *key, dict_sig_t_ sig) {
   assert(dict != NULL);
   assert(key != NULL || sig.key_size == 0);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(key, sig.key_size);
+  const size_t h = hash_item(sig.hash, key, sig.key_size);
 
+  backoff_t backoff = {0};
 retry1:;
   // acquire a reference to the dictionary
   sp_t sp = sp_acq(&dict->root);
@@ -30,46 +28,37 @@ retry1:;
 
   dict_impl_t *const d = sp.ptr;
 
-  for (size_t i = 0; i < dict_capacity(*d); ++i) {
-    const size_t index = (h + i) % dict_capacity(*d);
-    const void *const k = key_load(&d->key[index]);
-
-    // if this slot is unoccupied, we have probed as far as the item could be
-    if (k == NULL)
-      break;
-
-    // is this our sought item?
-    if (sig.key_size != 0 && memcmp(k, key, sig.key_size) != 0)
-      continue;
-
-    // load the corresponding value slot
-    uintptr_t v = value_slot_load(&d->value[index]);
+  const size_t index = dict_find(d, key, h, sig);
+  if (index == dict_capacity(d)) {
+    sp_rel(sp);
+    return false;
+  }
 
-  retry2:
-    if (value_slot_is_moved(v)) {
-      // someone is rehashing the dictionary into new storage
-      sp_rel(sp);
-      goto retry1;
-    }
+  // load the corresponding value slot
+  uintptr_t v = value_slot_load(dict_value(d, index));
 
-    // is this entry already deleted?
-    if (value_slot_is_free(v))
-      break;
+retry2:
+  if (value_slot_is_moved(v)) {
+    // someone is rehashing the dictionary into new storage
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry1;
+  }
 
-    // mark as deleted
-    if (!value_slot_cas(&d->value[index], &v, 0))
-      goto retry2;
-    (void)atomic_fetch_sub_explicit(&d->size, 1, memory_order_acq_rel);
+  // is this entry already deleted?
+  if (value_slot_is_free(v)) {
     sp_rel(sp);
-    {
-      void *const value = value_slot_to_ptr(v);
-      if (value != NULL && sig.value_dtor != NULL)
-        sig.value_dtor(value);
-      ALIGNED_FREE(value);
-    }
-    return true;
+    return false;
   }
 
+  // mark as deleted
+  if (!value_slot_cas(dict_value(d, index), &v, 0)) {
+    backoff_(&backoff);
+    goto retry2;
+  }
+  counter_sub(&d->size, 1);
   sp_rel(sp);
-  return false;
+  if (!d->inline_values)
+    dict_retire_value_(dict, value_slot_to_ptr(v), sig.value_dtor);
+  return true;
 }
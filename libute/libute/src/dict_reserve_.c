@@ -0,0 +1,41 @@
+/// @file
+/// @brief Implementation of dictionary pre-sizing
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "dict.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/dict.h>
+
+int dict_reserve_(dict_t_ *dict, size_t n, dict_sig_t_ sig) {
+  assert(dict != NULL);
+
+  if (n > SIZE_MAX / 100)
+    return ENOMEM;
+
+  const size_t c = dict_capacity_for(n);
+
+retry:;
+
+  // acquire a reference to the dictionary
+  sp_t sp = sp_acq(&dict->root);
+
+  // is the backing storage already large enough?
+  const dict_impl_t *const d = sp.ptr;
+  if (d != NULL && d->capacity >= c) {
+    sp_rel(sp);
+    return 0;
+  }
+
+  const int rc = dict_resize_(dict, sp, c, sig);
+  sp_rel(sp);
+  if (rc == ENOMEM)
+    return ENOMEM;
+
+  // whether we or someone else replaced the root, check it again
+  goto retry;
+}
@@ -0,0 +1,47 @@
+/// @file
+/// @brief Implementation of retiring a dictionary value
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "dict.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/aligned_alloc.h>
+#include <ute/dict.h>
+#include <ute/hazard.h>
+
+/// deallocate a value no reader can still be looking at
+///
+/// @param value Value to deallocate
+/// @param context Optional user-supplied value destructor
+static void value_free(void *value, void *context) {
+  assert(value != NULL);
+
+  void (*value_dtor)(void *) = context;
+  if (value_dtor != NULL)
+    value_dtor(value);
+  ALIGNED_FREE(value);
+}
+
+void dict_retire_value_(dict_t_ *owner, void *value,
+                        void (*value_dtor)(void *)) {
+  if (value == NULL)
+    return;
+
+  assert(owner != NULL);
+
+  // Pair with the fence in `hazard_set`, which `dict_get_protected_` calls
+  // after setting `protected_reads`. Either we see the flag, or that reader
+  // re-reads the value’s slot after we unlinked the value and so will not use
+  // it.
+  if (!atomic_load_explicit(&owner->protected_reads, memory_order_relaxed)) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load_explicit(&owner->protected_reads, memory_order_relaxed)) {
+      value_free(value, (void *)value_dtor);
+      return;
+    }
+  }
+
+  hazard_retire(value, value_free, (void *)value_dtor);
+}
@@ -3,19 +3,17 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
 #include "dict.h"
+#include "hash.h"
 #include <assert.h>
 #include <errno.h>
-#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 #include <ute/aligned_alloc.h>
 #include <ute/asp.h>
-#include <ute/attr.h>
 #include <ute/dict.h>
-#include <ute/hash.h>
 
 /// allocate storage for a new dictionary value
 ///
@@ -43,198 +41,18 @@ static void *alloc(size_t alignment, size_t size) {
   return ALIGNED_ALLOC(alignment, size);
 }
 
-/// deallocate a dictionary that is going out of scope
+/// destruct a dictionary key that is going out of scope
 ///
-/// @param dict Dictionary to operate on
-/// @param context Optional user-supplied value destructor
-static void dict_dtor(void *dict, void *context) {
-  assert(dict != NULL);
-
-  dict_impl_t *const d = dict;
-  void (*value_dtor)(void *) = context;
-
-  // free our keys
-  for (size_t i = 0; i < dict_capacity(*d); ++i) {
-    void *const k = key_load(&d->key[i]);
-    sp_ctrl_t *const c = ctrl_load(&d->ctrl[i]);
-    sp_t sp = {.ptr = k, .impl = c};
-    sp_rel(sp);
-  }
-
-  // free our values
-  for (size_t i = 0; i < dict_capacity(*d); ++i) {
-    const uintptr_t v = value_slot_load(&d->value[i]);
-    if (value_slot_is_moved(v))
-      continue;
-    void *const value = value_slot_to_ptr(v);
-    if (value != NULL && value_dtor != NULL)
-      value_dtor(value);
-    ALIGNED_FREE(value);
-  }
-
-  free(d->value);
-  free(d->key);
-  free(d->ctrl);
-  free(d);
-}
-
-/// deallocate a dictionary key that is going out of scope
+/// The key’s storage is freed along with its control block (see `sp_make`).
 ///
 /// @param ptr Pointer to the key
-/// @param context Optional user-supplied key destructor
+/// @param context User-supplied key destructor
 static void key_dtor(void *ptr, void *context) {
   assert(ptr != NULL);
+  assert(context != NULL);
 
   void (*dtor)(void *) = context;
-  if (dtor != NULL)
-    dtor(ptr);
-
-  ALIGNED_FREE(ptr);
-}
-
-/// insert/update an entry in a dictionary
-///
-/// The return value means:
-///   • 0 – the entry was inserted or updated
-///   • `ENOMEM` – not enough space to insert the entry
-///
-/// @param dict Dictionary to operate on
-/// @param key Key of entry to insert/update
-/// @param value Value to insert/update
-/// @param sig Signature of the dictionary
-/// @return 0 on success or an errno otherwise
-static int insert(dict_impl_t *dict, sp_t key, void *value, dict_sig_t_ sig) {
-  assert(dict != NULL);
-  assert(key.ptr != NULL);
-  assert(key.impl != NULL);
-  assert(value != NULL);
-
-  // has `key` been saved somewhere or `sp_rel`-ed?
-  bool key_consumed = false;
-
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(key.ptr, sig.key_size);
-  for (size_t i = 0; i < dict_capacity(*dict); ++i) {
-    const size_t index = (h + i) % dict_capacity(*dict);
-    sp_ctrl_t *c = ctrl_load(&dict->ctrl[index]);
-
-  retry1:
-    // if this slot is empty, try to claim it as ours
-    if (c == NULL) {
-      if (!ctrl_cas(&dict->ctrl[index], &c, key.impl))
-        goto retry1;
-
-      key_store(&dict->key[index], key.ptr);
-
-      // Note that we saved the key somewhere globally visible. This effectively
-      // counts as our 1 reference. But it is fine to hang on to the
-      // (semantically no longer accounted for) `key` because we hold a
-      // reference to `dict`. This reference prevents the key we just wrote
-      // being destructed.
-      key_consumed = true;
-      (void)atomic_fetch_add_explicit(&dict->used, 1, memory_order_acq_rel);
-
-    } else {
-    retry2:;
-      // if this slot is not ours, skip it
-      const void *const k = key_load(&dict->key[index]);
-      if (k == NULL)
-        goto retry2;
-      if (sig.key_size != 0 && memcmp(k, key.ptr, sig.key_size) != 0)
-        continue;
-    }
-
-    // load the corresponding value slot
-    uintptr_t v = value_slot_load(&dict->value[index]);
-
-  retry3:
-    // has someone else begun a migration?
-    if (value_slot_is_moved(v)) {
-      // If we are only implicitly holding a reference count for `key`, make
-      // this explicit now. Our caller wants to retry on our failure and,
-      // without this, will unknowingly be reusing a consumed pointer.
-      if (key_consumed)
-        (void)sp_dup(key);
-
-      return ENOMEM;
-    }
-
-    // store our updated value
-    if (!value_slot_cas(&dict->value[index], &v, (uintptr_t)value))
-      goto retry3;
-
-    // cleanup any value we just overwrote
-    {
-      void *const val = value_slot_to_ptr(v);
-      if (val != NULL && sig.value_dtor != NULL)
-        sig.value_dtor(val);
-      ALIGNED_FREE(val);
-    }
-    if (value_slot_is_free(v))
-      (void)atomic_fetch_add_explicit(&dict->size, 1, memory_order_acq_rel);
-
-    // if we did not use the key, discard it
-    if (!key_consumed)
-      sp_rel(key);
-
-    return 0;
-  }
-
-  return ENOMEM;
-}
-
-/// insert everything from one dictionary into another
-///
-/// The destination dictionary is assumed to have enough space to store all
-/// entries from the source dictionary without expansion. On success, the source
-/// dictionary is “consumed” in that the destination takes ownership over all
-/// its values.
-///
-/// @param dst Dictionary to insert into
-/// @param src Dictionary to insert from
-/// @param sig Signature of the dictionary
-/// @return 0 on success or an errno on failure
-static int rehash(dict_impl_t *dst, dict_impl_t *src, dict_sig_t_ sig) {
-  assert(dst != NULL);
-  assert(src == NULL || dict_capacity(*dst) >= dict_capacity(*src));
-
-  // nothing to do for an uninitialised dictionary
-  if (src == NULL)
-    return 0;
-
-  for (size_t i = 0; i < dict_capacity(*src); ++i) {
-    uintptr_t v = value_slot_load(&src->value[i]);
-  retry:
-
-    // Did someone else beat us to migration? CASing in the “migrated” bit to
-    // the first slot is how we authoritatively claim that we and only we are
-    // migrating this dictionary, so we should only ever race with other
-    // migrators on the first slot.
-    if (value_slot_is_moved(v)) {
-      assert(i == 0 && "another migrator skipped the first slot");
-      return EALREADY;
-    }
-
-    // mark this slot as migrated
-    if (!value_slot_cas(&src->value[i], &v, value_slot_moved(v))) {
-      // an inserter or deleter (or migrator if i == 0) beat us
-      goto retry;
-    }
-
-    if (value_slot_is_free(v))
-      continue;
-
-    sp_ctrl_t *const c = ctrl_load(&src->ctrl[i]);
-    assert(c != NULL && "value associated with key without control block");
-    void *const k = key_load(&src->key[i]);
-    assert(k != NULL && "value associated with null key");
-
-    const sp_t item = {.ptr = k, .impl = c};
-    const sp_t copy = sp_dup(item);
-    const int rc UNUSED = insert(dst, copy, value_slot_to_ptr(v), sig);
-    assert(rc == 0 && "rehash destination not owned exclusively?");
-  }
-
-  return 0;
+  dtor(ptr);
 }
 
 int dict_set_(dict_t_ *dict, void *key, void *value, dict_sig_t_ sig) {
@@ -242,110 +60,81 @@ int dict_set_(dict_t_ *dict, void *key, void *value, dict_sig_t_ sig) {
   assert(key != NULL || sig.key_size == 0);
   assert(value != NULL || sig.value_size == 0);
 
-  // copy key for insertion
-  const size_t k_size = sig.key_size == 0 ? 1 : sig.key_size;
-  void *const box = ALIGNED_ALLOC(sig.key_alignment, k_size);
-  if (box == NULL) {
-    if (sig.value_dtor != NULL)
-      sig.value_dtor(value);
-    if (sig.key_dtor != NULL)
-      sig.key_dtor(key);
-    return ENOMEM;
-  }
-  if (sig.key_size > 0)
-    memcpy(box, key, sig.key_size);
-  const sp_t k = sp_new(box, key_dtor, sig.key_dtor);
-  if (k.ptr == NULL) {
-    if (sig.value_dtor != NULL)
-      sig.value_dtor(value);
-    key_dtor(box, sig.key_dtor);
-    return ENOMEM;
+  // An inline key is copied into its slot by `dict_put_`, so can be passed
+  // through as-is. Otherwise copy the key for insertion, alongside its control
+  // block.
+  const bool inline_key = dict_keys_inline(sig);
+  sp_t k = {.ptr = key};
+  if (!inline_key) {
+    k = sp_make(sig.key_size, sig.key_alignment,
+                sig.key_dtor == NULL ? NULL : key_dtor, (void *)sig.key_dtor);
+    if (k.ptr == NULL) {
+      if (sig.value_dtor != NULL)
+        sig.value_dtor(value);
+      if (sig.key_dtor != NULL)
+        sig.key_dtor(key);
+      return ENOMEM;
+    }
+    if (sig.key_size > 0)
+      memcpy(k.ptr, key, sig.key_size);
   }
 
-  // copy value for insertion, noting that we need a non-null pointer
-  void *const v = alloc(sig.value_alignment, sig.value_size);
-  if (v == NULL) {
-    sp_rel(k);
-    if (sig.value_dtor != NULL)
-      sig.value_dtor(value);
-    return ENOMEM;
+  // copy value for insertion, either into the slot representation itself or
+  // into a box, noting that we need a non-null pointer
+  const bool inline_value = dict_values_inline(sig);
+  uintptr_t v;
+  if (inline_value) {
+    v = value_slot_inline(value, sig);
+  } else {
+    void *const box = alloc(sig.value_alignment, sig.value_size);
+    if (box == NULL) {
+      if (!inline_key)
+        sp_rel(k);
+      if (sig.value_dtor != NULL)
+        sig.value_dtor(value);
+      return ENOMEM;
+    }
+    if (sig.value_size > 0)
+      memcpy(box, value, sig.value_size);
+    v = (uintptr_t)box;
   }
-  if (sig.value_size > 0)
-    memcpy(v, value, sig.value_size);
 
-  // percentage occupancy at which we expand the backing storage
-  enum { LOAD_FACTOR = 70 };
+  const size_t h = hash_item(sig.hash, key, sig.key_size);
 
+  backoff_t backoff = {0};
 retry:;
 
   // acquire a reference to the dictionary
   sp_t sp = sp_acq(&dict->root);
 
   dict_impl_t *const d = sp.ptr;
-  const size_t used =
-      d == NULL ? 0 : atomic_load_explicit(&d->used, memory_order_acquire);
-  const size_t capacity = d == NULL ? 0 : dict_capacity(*d);
 
   // do we need to expand the backing storage?
-  if (used * 100 >= capacity * LOAD_FACTOR) {
-
-    dict_impl_t *const new = calloc(1, sizeof(*new));
-    if (new == NULL) {
-      sp_rel(sp);
-      if (sig.value_dtor != NULL)
-        sig.value_dtor(v);
-      ALIGNED_FREE(v);
-      sp_rel(k);
-      return ENOMEM;
-    }
-
-    sp_t new_sp = sp_new(new, dict_dtor, sig.value_dtor);
-    if (new_sp.ptr == NULL) {
-      dict_dtor(new, sig.value_dtor);
-      sp_rel(sp);
-      if (sig.value_dtor != NULL)
-        sig.value_dtor(v);
-      ALIGNED_FREE(v);
-      sp_rel(k);
-      return ENOMEM;
-    }
-
-    const size_t c = capacity + 1;
-    *new = (dict_impl_t){
-        .ctrl = calloc((size_t)1 << c >> 1, sizeof(new->ctrl[0])),
-        .key = calloc((size_t)1 << c >> 1, sizeof(new->key[0])),
-        .value = calloc((size_t)1 << c >> 1, sizeof(new->value[0]))};
-    if (new->ctrl == NULL || new->key == NULL || new->value == NULL) {
-      sp_rel(new_sp);
-      sp_rel(sp);
-      if (sig.value_dtor != NULL)
-        sig.value_dtor(v);
-      ALIGNED_FREE(v);
-      sp_rel(k);
+  if (dict_is_full(d)) {
+    const size_t c = d == NULL ? 1 : d->capacity + 1;
+    const int rc = dict_resize_(dict, sp, c, sig);
+    sp_rel(sp);
+    if (rc == ENOMEM) {
+      if (!inline_value) {
+        if (sig.value_dtor != NULL)
+          sig.value_dtor(value_slot_to_ptr(v));
+        ALIGNED_FREE(value_slot_to_ptr(v));
+      }
+      if (!inline_key)
+        sp_rel(k);
       return ENOMEM;
     }
-    new->capacity = c;
-
-    if (rehash(new, d, sig) != 0) {
-      sp_rel(new_sp);
-      sp_rel(sp);
-      goto retry;
-    }
-
-    const bool r = sp_cas(&dict->root, sp, new_sp);
-    assert((r || sp.ptr == NULL) && "successful migrations race one another");
-    if (!r)
-      sp_rel(new_sp);
-    sp_rel(sp);
     goto retry;
   }
 
   // insert the key+value
   {
-    const int rc = insert(d, k, v, sig);
+    const int rc = dict_put_(dict, d, k, h, v, sig);
     sp_rel(sp);
-    if (rc != 0)
+    if (rc != 0) {
+      backoff_(&backoff);
       goto retry;
+    }
   }
 
   return 0;
@@ -5,8 +5,8 @@
 
 #include "dict.h"
 #include <assert.h>
-#include <stdatomic.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <ute/asp.h>
 #include <ute/dict.h>
 
@@ -20,10 +20,15 @@ size_t dict_size_(dict_t_ *dict) {
   if (sp.ptr == NULL)
     return 0;
 
-  const dict_impl_t *const d = sp.ptr;
-  const size_t size = atomic_load_explicit(&d->size, memory_order_acquire);
+  dict_impl_t *const d = sp.ptr;
+  const size_t size = counter_read(&d->size);
 
   sp_rel(sp);
 
+  // in the case of racing insertions and deletes, we can see a removal whose
+  // insertion we did not count, making the sum appear to have wrapped around
+  if (size > SIZE_MAX / 2)
+    return 0;
+
   return size;
 }
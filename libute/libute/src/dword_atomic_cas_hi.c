@@ -1,28 +1,14 @@
 /// @file
 /// @brief Implementation of upper half dword CAS
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdatomic.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <ute/dword.h>
-
-#ifdef _MSC_VER
-#define MAY_ALIAS /* nothing */
-#else
-#define MAY_ALIAS __attribute__((may_alias))
-#endif
+#define USE_INLINE_ATOMICS 1
 
-bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
-                         uintptr_t desired) {
-  assert(dst != NULL);
-  assert(expected != NULL);
+#include <ute/dword.h>
 
-  typedef uintptr_t MAY_ALIAS word_t;
-  _Atomic word_t *const d = (_Atomic word_t *)dst;
-  return atomic_compare_exchange_strong_explicit(
-      d + 1, expected, desired, memory_order_acq_rel, memory_order_acquire);
-}
+extern inline bool dword_atomic_cas_hi(atomic_dword_t *dst, uintptr_t *expected,
+                                       uintptr_t desired);
@@ -1,16 +1,14 @@
 /// @file
 /// @brief Implementation of dword CAS by value
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <ute/dword.h>
+#define USE_INLINE_ATOMICS 1
 
-bool dword_atomic_cas_n(atomic_dword_t *dst, dword_t expected,
-                        dword_t desired) {
-  assert(dst != NULL);
+#include <ute/dword.h>
 
-  return dword_atomic_cas(dst, &expected, desired);
-}
+extern inline bool dword_atomic_cas_n(atomic_dword_t *dst, dword_t expected,
+                                      dword_t desired);
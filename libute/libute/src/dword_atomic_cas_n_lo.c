@@ -1,17 +1,14 @@
 /// @file
 /// @brief Implementation of lower half dword CAS by value
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <ute/dword.h>
+#define USE_INLINE_ATOMICS 1
 
-bool dword_atomic_cas_n_lo(atomic_dword_t *dst, uintptr_t expected,
-                           uintptr_t desired) {
-  assert(dst != NULL);
+#include <ute/dword.h>
 
-  return dword_atomic_cas_lo(dst, &expected, desired);
-}
+extern inline bool dword_atomic_cas_n_lo(atomic_dword_t *dst,
+                                         uintptr_t expected, uintptr_t desired);
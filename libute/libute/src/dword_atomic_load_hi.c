@@ -1,24 +1,13 @@
 /// @file
 /// @brief Implementation of upper half dword load
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdatomic.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <ute/dword.h>
-
-#ifdef _MSC_VER
-#define MAY_ALIAS /* nothing */
-#else
-#define MAY_ALIAS __attribute__((may_alias))
-#endif
+#define USE_INLINE_ATOMICS 1
 
-uintptr_t dword_atomic_load_hi(atomic_dword_t *src) {
-  assert(src != NULL);
+#include <ute/dword.h>
 
-  typedef uintptr_t MAY_ALIAS word_t;
-  _Atomic const word_t *const s = (_Atomic word_t *)src;
-  return atomic_load_explicit(s + 1, memory_order_acquire);
-}
+extern inline uintptr_t dword_atomic_load_hi(atomic_dword_t *src);
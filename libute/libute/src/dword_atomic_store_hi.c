@@ -1,24 +1,13 @@
 /// @file
 /// @brief Implementation of upper half dword store
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdatomic.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <ute/dword.h>
-
-#ifdef _MSC_VER
-#define MAY_ALIAS /* nothing */
-#else
-#define MAY_ALIAS __attribute__((may_alias))
-#endif
+#define USE_INLINE_ATOMICS 1
 
-void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src) {
-  assert(dst != NULL);
+#include <ute/dword.h>
 
-  typedef uintptr_t MAY_ALIAS word_t;
-  _Atomic word_t *const d = (_Atomic word_t *)dst;
-  atomic_store_explicit(d + 1, src, memory_order_release);
-}
+extern inline void dword_atomic_store_hi(atomic_dword_t *dst, uintptr_t src);
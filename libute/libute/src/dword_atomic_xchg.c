@@ -3,6 +3,7 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
 #include <assert.h>
 #include <stdatomic.h>
 #include <stddef.h>
@@ -21,9 +22,10 @@ dword_t dword_atomic_xchg(atomic_dword_t *dst, dword_t src) {
   return _InterlockedExchange64(dst, src);
 #elif defined(_MSC_VER)
   {
+    backoff_t backoff = {0};
     dword_t old = dword_zero();
-    while (!dword_atomic_cas(dst, &old, src)) {
-    }
+    while (!dword_atomic_cas(dst, &old, src))
+      backoff_(&backoff);
     return old;
   }
 #elif __SIZEOF_POINTER__ == 8
@@ -1,24 +1,14 @@
 /// @file
 /// @brief Implementation of lower half dword exchange
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdatomic.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <ute/dword.h>
-
-#ifdef _MSC_VER
-#define MAY_ALIAS /* nothing */
-#else
-#define MAY_ALIAS __attribute__((may_alias))
-#endif
+#define USE_INLINE_ATOMICS 1
 
-uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst, uintptr_t src) {
-  assert(dst != NULL);
+#include <ute/dword.h>
 
-  typedef uintptr_t MAY_ALIAS word_t;
-  _Atomic word_t *const d = (_Atomic word_t *)dst;
-  return atomic_exchange_explicit(d, src, memory_order_acq_rel);
-}
+extern inline uintptr_t dword_atomic_xchg_lo(atomic_dword_t *dst,
+                                             uintptr_t src);
@@ -1,13 +1,13 @@
 /// @file
 /// @brief Implementation of dword initialisation
 ///
+/// The definition is in ute/dword_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <string.h>
+#define USE_INLINE_ATOMICS 1
+
 #include <ute/dword.h>
 
-dword_t dword_zero(void) {
-  dword_t d;
-  memset(&d, 0, sizeof(d));
-  return d;
-}
+extern inline dword_t dword_zero(void);
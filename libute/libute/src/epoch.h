@@ -0,0 +1,149 @@
+/// @file
+/// @brief Epoch-based reclamation internals
+///
+/// Looking up an item through an atomic shared pointer (`sp_acq`, `sp_rel`)
+/// costs two read-modify-writes on the root of a set, a cache line that every
+/// reader shares. Instead, readers can announce that they are inside a guard
+/// (`epoch_enter`, `epoch_exit`) and access the current table without taking a
+/// reference. Tables read this way must not be deallocated as soon as their
+/// last reference is dropped. They are retired (`epoch_retire_`) and only
+/// deallocated once every thread that could have seen them has left its guard.
+///
+/// The scheme is Keir Fraser’s epoch-based reclamation, as described in
+/// “Practical lock-freedom”, 2004. There is a global epoch, which each thread
+/// publishes a copy of on entering a guard. Allocations retired in epoch e are
+/// placed on a limbo list. The global epoch can only advance from e to e + 1
+/// once every thread inside a guard has published e, so once the global epoch
+/// reaches e + 2 no thread can still be looking at an allocation retired in e.
+/// Only three limbo lists are live at once, indexed by epoch modulo 3.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "counter.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/// an allocation awaiting deallocation
+///
+/// This is intended to be embedded in the allocation itself, so retiring
+/// never needs to allocate.
+typedef struct epoch_node {
+  struct epoch_node *next;      ///< next allocation on the same limbo list
+  void (*dtor)(void *, void *); ///< deallocator to eventually call
+  void *value;                  ///< first parameter to `dtor`
+  void *context;                ///< second parameter to `dtor`
+} epoch_node_t;
+
+/// a thread’s published state
+///
+/// Records are allocated on a thread’s first guard and never freed. When the
+/// thread exits, its record is released for reuse by a later thread.
+typedef struct epoch_record {
+  /// the global epoch this thread observed on entering its outermost guard,
+  /// shifted left by 1 with the low bit set, or 0 if not inside a guard
+  alignas(CACHE_LINE) atomic_size_t epoch;
+
+  atomic_bool in_use; ///< is this record owned by a live thread?
+
+  struct epoch_record *next; ///< next record in `epoch_state_.records`
+} epoch_record_t;
+
+/// a thread’s private state
+typedef struct {
+  epoch_record_t *record; ///< our published state, if we have one
+  size_t depth;           ///< how many guards are we nested within?
+  size_t exits;           ///< how many outermost guards have we left?
+} epoch_thread_t;
+
+/// number of limbo lists
+enum { EPOCH_LISTS = 3 };
+
+/// how many outermost guard exits between attempts to reclaim memory
+enum { EPOCH_ADVANCE_INTERVAL = 64 };
+
+/// global state of epoch-based reclamation
+typedef struct {
+  alignas(CACHE_LINE) atomic_size_t epoch; ///< current global epoch
+
+  /// allocations awaiting reclamation, indexed by retiring epoch modulo 3
+  epoch_node_t *_Atomic limbo[EPOCH_LISTS];
+
+  atomic_size_t pending; ///< how many allocations are on limbo lists?
+
+  /// number of threads inside a guard without a published record
+  ///
+  /// A thread that fails to allocate a record falls back to counting itself
+  /// here, and the global epoch does not advance while this is non-zero.
+  atomic_size_t anonymous;
+
+  /// is a thread currently advancing the global epoch?
+  atomic_flag advancing;
+
+  /// claimed allocations whose deallocation is left for `sp_reclaim`
+  epoch_node_t *_Atomic deferred;
+
+  /// published state of every thread that has ever entered a guard
+  alignas(CACHE_LINE) epoch_record_t *_Atomic records;
+} epoch_state_t;
+
+/// global state of epoch-based reclamation
+extern PRIVATE epoch_state_t epoch_state_;
+
+/// private state of the calling thread
+extern PRIVATE _Thread_local epoch_thread_t epoch_thread_;
+
+/// acquire a published record for the calling thread
+///
+/// @return The acquired record or `NULL` on out-of-memory
+PRIVATE epoch_record_t *epoch_register_(void);
+
+/// schedule an allocation for deallocation once no guard can still see it
+///
+/// The caller must have already made the allocation unreachable to any thread
+/// that has not yet entered a guard.
+///
+/// @param node Storage for tracking the allocation until it is deallocated
+/// @param dtor Deallocator to call
+/// @param value First parameter to `dtor`
+/// @param context Second parameter to `dtor`
+PRIVATE void epoch_retire_(epoch_node_t *node, void (*dtor)(void *, void *),
+                           void *value, void *context);
+
+/// try to advance the global epoch and reclaim anything this makes safe
+///
+/// This gives up without waiting if any thread is inside a guard begun in a
+/// prior epoch, or if another thread is concurrently advancing the epoch.
+PRIVATE void epoch_try_advance_(void);
+
+/// deallocate claimed allocations that were left for `sp_reclaim`
+///
+/// @return Number of allocations deallocated
+PRIVATE size_t epoch_reclaim_deferred_(void);
+
+/// deallocate a list of claimed allocations
+///
+/// @param list First allocation in the list
+/// @return Number of allocations deallocated
+static inline size_t epoch_run(epoch_node_t *list) {
+  size_t reclaimed = 0;
+  while (list != NULL) {
+    epoch_node_t *const next = list->next;
+    list->dtor(list->value, list->context);
+    list = next;
+    ++reclaimed;
+  }
+  if (reclaimed > 0)
+    (void)atomic_fetch_sub_explicit(&epoch_state_.pending, reclaimed,
+                                    memory_order_relaxed);
+  return reclaimed;
+}
+
+/// wait for everything retired so far to be deallocated
+///
+/// This is a no-op if called from within a guard, which would otherwise wait
+/// forever on itself.
+PRIVATE void epoch_synchronize_(void);
@@ -0,0 +1,37 @@
+/// @file
+/// @brief Implementation of entering a read guard
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "epoch.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/epoch.h>
+
+void epoch_enter(void) {
+  epoch_thread_t *const self = &epoch_thread_;
+
+  // if we are already inside a guard, it covers this one too
+  if (self->depth++ > 0)
+    return;
+
+  if (self->record == NULL)
+    self->record = epoch_register_();
+
+  if (self->record == NULL) {
+    // if we could not get a record, stall reclamation for everyone instead
+    (void)atomic_fetch_add_explicit(&epoch_state_.anonymous, 1,
+                                    memory_order_relaxed);
+  } else {
+    // publish the epoch we are reading in
+    const size_t epoch =
+        atomic_load_explicit(&epoch_state_.epoch, memory_order_acquire);
+    atomic_store_explicit(&self->record->epoch, epoch << 1 | 1,
+                          memory_order_relaxed);
+  }
+
+  // Order our publication before any subsequent loads of pointers we will
+  // dereference. A thread trying to advance the epoch either sees our
+  // publication, or retired its allocations before we could have loaded them.
+  atomic_thread_fence(memory_order_seq_cst);
+}
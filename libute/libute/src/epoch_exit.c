@@ -0,0 +1,35 @@
+/// @file
+/// @brief Implementation of leaving a read guard
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "epoch.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/epoch.h>
+
+void epoch_exit(void) {
+  epoch_thread_t *const self = &epoch_thread_;
+  assert(self->depth > 0 && "leaving a guard that was never entered");
+
+  // if we are still inside an outer guard, there is nothing more to do
+  if (--self->depth > 0)
+    return;
+
+  if (self->record == NULL) {
+    (void)atomic_fetch_sub_explicit(&epoch_state_.anonymous, 1,
+                                    memory_order_release);
+    return;
+  }
+
+  atomic_store_explicit(&self->record->epoch, 0, memory_order_release);
+
+  // Retiring threads try to reclaim memory themselves, but can be held back
+  // by readers that are long gone by the time their next retirement comes.
+  // So readers also occasionally help.
+  ++self->exits;
+  if (self->exits % EPOCH_ADVANCE_INTERVAL == 0 &&
+      atomic_load_explicit(&epoch_state_.pending, memory_order_relaxed) > 0)
+    epoch_try_advance_();
+}
@@ -0,0 +1,18 @@
+/// @file
+/// @brief Implementation of deallocating deferred epoch allocations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "epoch.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+size_t epoch_reclaim_deferred_(void) {
+
+  // Take the whole list at once. Nothing is ever popped individually, so there
+  // is no ABA problem here.
+  epoch_node_t *const deferred = atomic_exchange_explicit(
+      &epoch_state_.deferred, NULL, memory_order_acquire);
+
+  return epoch_run(deferred);
+}
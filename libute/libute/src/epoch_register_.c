@@ -0,0 +1,93 @@
+/// @file
+/// @brief Implementation of acquiring a per-thread epoch record
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "counter.h"
+#include "epoch.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if USE_PTHREADS
+#include <pthread.h>
+
+/// key whose destructor releases a thread’s record when the thread exits
+static pthread_key_t key;
+
+/// was `key` successfully created?
+static bool have_key;
+
+/// guard for creating `key`
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/// release the record of an exiting thread
+///
+/// @param record Record to release
+static void release(void *record) {
+  epoch_record_t *const r = record;
+  assert(atomic_load_explicit(&r->epoch, memory_order_relaxed) == 0 &&
+         "thread exited inside a guard");
+
+  // forget the record in case a later thread-exit handler enters a guard
+  epoch_thread_.record = NULL;
+
+  atomic_store_explicit(&r->in_use, false, memory_order_release);
+}
+
+/// create `key`
+static void make_key(void) {
+  have_key = pthread_key_create(&key, release) == 0;
+}
+#endif
+
+epoch_record_t *epoch_register_(void) {
+
+  // try to reuse a record released by a thread that has since exited
+  epoch_record_t *r =
+      atomic_load_explicit(&epoch_state_.records, memory_order_acquire);
+  for (; r != NULL; r = r->next) {
+    bool in_use = false;
+    if (atomic_compare_exchange_strong_explicit(&r->in_use, &in_use, true,
+                                                memory_order_acq_rel,
+                                                memory_order_relaxed))
+      break;
+  }
+
+  if (r == NULL) {
+    // Records are never freed, so allocate with slack to align them by hand
+    // rather than using `ALIGNED_ALLOC`, whose leak checks would flag them.
+    void *const p = calloc(1, sizeof(*r) + alignof(epoch_record_t));
+    if (p == NULL)
+      return NULL;
+    const uintptr_t aligned = ((uintptr_t)p + alignof(epoch_record_t) - 1) /
+                              alignof(epoch_record_t) *
+                              alignof(epoch_record_t);
+    r = (epoch_record_t *)aligned;
+    atomic_init(&r->epoch, 0);
+    atomic_init(&r->in_use, true);
+
+    // add it to the list of records
+    backoff_t backoff = {0};
+    r->next = atomic_load_explicit(&epoch_state_.records, memory_order_acquire);
+    while (!atomic_compare_exchange_weak_explicit(&epoch_state_.records,
+                                                  &r->next, r,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire))
+      backoff_(&backoff);
+  }
+
+#if USE_PTHREADS
+  // arrange for the record to be released when we exit
+  (void)pthread_once(&key_once, make_key);
+  if (have_key)
+    (void)pthread_setspecific(key, r);
+#endif
+
+  return r;
+}
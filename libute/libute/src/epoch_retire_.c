@@ -0,0 +1,35 @@
+/// @file
+/// @brief Implementation of retiring an allocation
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "epoch.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+void epoch_retire_(epoch_node_t *node, void (*dtor)(void *, void *),
+                   void *value, void *context) {
+  assert(node != NULL);
+  assert(dtor != NULL);
+
+  *node = (epoch_node_t){.dtor = dtor, .value = value, .context = context};
+  (void)atomic_fetch_add_explicit(&epoch_state_.pending, 1,
+                                  memory_order_relaxed);
+
+  // File the allocation under the epoch in which it became unreachable. The
+  // fence orders our caller unlinking it before this, so a reader that loads
+  // the epoch we see or a later one cannot have loaded the allocation.
+  atomic_thread_fence(memory_order_seq_cst);
+  const size_t epoch =
+      atomic_load_explicit(&epoch_state_.epoch, memory_order_relaxed);
+  epoch_node_t *_Atomic *const limbo = &epoch_state_.limbo[epoch % EPOCH_LISTS];
+  backoff_t backoff = {0};
+  node->next = atomic_load_explicit(limbo, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(
+      limbo, &node->next, node, memory_order_release, memory_order_relaxed))
+    backoff_(&backoff);
+
+  epoch_try_advance_();
+}
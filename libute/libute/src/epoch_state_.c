@@ -0,0 +1,10 @@
+/// @file
+/// @brief Storage for epoch-based reclamation state
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "epoch.h"
+
+epoch_state_t epoch_state_;
+
+_Thread_local epoch_thread_t epoch_thread_;
@@ -0,0 +1,36 @@
+/// @file
+/// @brief Implementation of waiting for retired allocations to be reclaimed
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "epoch.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+void epoch_synchronize_(void) {
+
+  // we would never observe our own guard being left
+  if (epoch_thread_.depth > 0)
+    return;
+
+  // Anything retired before now was filed under this epoch or an earlier one.
+  // So it has been claimed by the time the epoch has advanced by 2 more, and
+  // each limbo list has been drained once the epoch has advanced by 3.
+  const size_t start =
+      atomic_load_explicit(&epoch_state_.epoch, memory_order_seq_cst);
+  backoff_t backoff = {0};
+  while (atomic_load_explicit(&epoch_state_.pending, memory_order_acquire) >
+         0) {
+    const size_t now =
+        atomic_load_explicit(&epoch_state_.epoch, memory_order_seq_cst);
+    if (now - start >= EPOCH_LISTS)
+      break;
+    epoch_try_advance_();
+
+    // if another thread’s guard is holding the epoch back, give it a chance
+    // to run and leave its guard, rather than spinning on it
+    if (atomic_load_explicit(&epoch_state_.epoch, memory_order_seq_cst) == now)
+      backoff_(&backoff);
+  }
+}
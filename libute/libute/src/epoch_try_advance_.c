@@ -0,0 +1,75 @@
+/// @file
+/// @brief Implementation of advancing the global epoch
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "epoch.h"
+#include "sp_ctrl.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+void epoch_try_advance_(void) {
+
+  // Only one thread advances the epoch at a time. Without this, a thread
+  // delayed between advancing the epoch and draining a limbo list could find
+  // the epoch has since moved on and the list now holds newer allocations.
+  if (atomic_flag_test_and_set_explicit(&epoch_state_.advancing,
+                                        memory_order_acquire))
+    return;
+
+  // pair with the fence in `epoch_enter`, so either we see a reader’s
+  // published epoch or it sees the effects of everything retired before now
+  atomic_thread_fence(memory_order_seq_cst);
+
+  const size_t epoch =
+      atomic_load_explicit(&epoch_state_.epoch, memory_order_relaxed);
+
+  // Has every thread inside a guard caught up with the current epoch? These
+  // loads pair with the releases in `epoch_exit`, so that everything a reader
+  // did inside its guard happens before we deallocate what it could have seen.
+  bool quiescent = atomic_load_explicit(&epoch_state_.anonymous,
+                                        memory_order_acquire) == 0;
+  for (epoch_record_t *r = atomic_load_explicit(&epoch_state_.records,
+                                                memory_order_acquire);
+       quiescent && r != NULL; r = r->next) {
+    const size_t e = atomic_load_explicit(&r->epoch, memory_order_acquire);
+    if (e != 0 && e != (epoch << 1 | 1))
+      quiescent = false;
+  }
+
+  // if so, move to the next epoch and claim the allocations retired two
+  // epochs ago, that no guard can still see
+  epoch_node_t *retired = NULL;
+  if (quiescent) {
+    atomic_store_explicit(&epoch_state_.epoch, epoch + 1, memory_order_seq_cst);
+    const size_t oldest = (epoch + 2) % EPOCH_LISTS;
+    retired = atomic_exchange_explicit(&epoch_state_.limbo[oldest], NULL,
+                                       memory_order_acquire);
+  }
+
+  atomic_flag_clear_explicit(&epoch_state_.advancing, memory_order_release);
+
+  if (retired == NULL)
+    return;
+
+  // if destructors are being deferred, leave what we claimed for `sp_reclaim`
+  if (atomic_load_explicit(&sp_deferred_.enabled, memory_order_relaxed)) {
+    epoch_node_t *last = retired;
+    while (last->next != NULL)
+      last = last->next;
+    backoff_t backoff = {0};
+    last->next =
+        atomic_load_explicit(&epoch_state_.deferred, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &epoch_state_.deferred, &last->next, retired, memory_order_release,
+        memory_order_relaxed))
+      backoff_(&backoff);
+    return;
+  }
+
+  // deallocate what we claimed, outside the flag as destructors may
+  // themselves retire further allocations
+  (void)epoch_run(retired);
+}
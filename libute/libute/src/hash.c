@@ -3,83 +3,126 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "hash.h"
 #include <assert.h>
-#include <inttypes.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
-#include <ute/attr.h>
 #include <ute/hash.h>
 
-/// MurmurHash by Austin Appleby
+/// multiply two 64-bit values, yielding the low and high halves of the result
 ///
-/// This implementation of MurmurHash64A is based on the public domain reference
-/// implementation with the following modifications:
-///   • The seed is hard coded to 0; and
-///   • Undefined Behaviour is avoided.
-/// More information on MurmurHash at https://github.com/aappleby/smhasher/.
-///
-/// @param data Data to hash
-/// @param len Number of bytes at `data`
-/// @return A hash digest of the data
-static uint64_t MurmurHash64A(const void *data, size_t len) {
-
-  const uint64_t seed = 0;
-
-  const uint64_t m = UINT64_C(0xc6a4a7935bd1e995);
-  const unsigned r = 47;
+/// @param a [inout] First operand, replaced by the low half of the product
+/// @param b [inout] Second operand, replaced by the high half of the product
+static void mum(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+  const unsigned __int128 r = (unsigned __int128)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  const uint64_t ha = *a >> 32, hb = *b >> 32;
+  const uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+  const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  const uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  const uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
 
-  uint64_t h = seed ^ (len * m);
+/// multiply two 64-bit values and fold the result
+static uint64_t mix(uint64_t a, uint64_t b) {
+  mum(&a, &b);
+  return a ^ b;
+}
 
-  const unsigned char *d = data;
-  const unsigned char *end = d + len / sizeof(uint64_t) * sizeof(uint64_t);
+/// read 8 possibly unaligned bytes
+static uint64_t read8(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
 
-  while (d != end) {
+/// read 4 possibly unaligned bytes
+static uint64_t read4(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
 
-    uint64_t k;
-    memcpy(&k, d, sizeof(k));
-    d += sizeof(k);
+/// read 1–3 bytes
+static uint64_t read3(const unsigned char *p, size_t len) {
+  assert(len > 0 && len < 4);
+  return (uint64_t)p[0] << 16 | (uint64_t)p[len >> 1] << 8 | p[len - 1];
+}
 
-    k *= m;
-    k ^= k >> r;
-    k *= m;
+/// wyhash by Wang Yi
+///
+/// This implementation is based on the public domain final version 4 of
+/// wyhash, with the seed and secret hard coded. It consumes 48 bytes per
+/// iteration using three independent multiply chains, which makes it several
+/// times faster than MurmurHash64A on long inputs. More information on wyhash
+/// at https://github.com/wangyi-fudan/wyhash.
+///
+/// @param data Data to hash
+/// @param len Number of bytes at `data`
+/// @return A hash digest of the data
+static uint64_t wyhash(const void *data, size_t len) {
+  static const uint64_t secret[] = {
+      UINT64_C(0x2d358dccaa6c78a5), UINT64_C(0x8bb84b93962eacc9),
+      UINT64_C(0x4b33a62ed433d4a3), UINT64_C(0x4d5a2da51de1aa47)};
 
-    h ^= k;
-    h *= m;
-  }
+  const unsigned char *p = data;
+  uint64_t seed = mix(secret[0], secret[1]);
+  uint64_t a, b;
 
-  switch (len & 7) {
-  case 7:
-    h ^= (uint64_t)d[6] << 48;
-    FALLTHROUGH;
-  case 6:
-    h ^= (uint64_t)d[5] << 40;
-    FALLTHROUGH;
-  case 5:
-    h ^= (uint64_t)d[4] << 32;
-    FALLTHROUGH;
-  case 4:
-    h ^= (uint64_t)d[3] << 24;
-    FALLTHROUGH;
-  case 3:
-    h ^= (uint64_t)d[2] << 16;
-    FALLTHROUGH;
-  case 2:
-    h ^= (uint64_t)d[1] << 8;
-    FALLTHROUGH;
-  case 1:
-    h ^= (uint64_t)d[0];
-    h *= m;
+  if (len <= 16) {
+    if (len >= 4) {
+      const size_t mid = (len >> 3) << 2;
+      a = read4(p) << 32 | read4(p + mid);
+      b = read4(p + len - 4) << 32 | read4(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = read3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i >= 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i >= 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
   }
 
-  h ^= h >> r;
-  h *= m;
-  h ^= h >> r;
-
-  return h;
+  a ^= secret[1];
+  b ^= seed;
+  mum(&a, &b);
+  return mix(a ^ secret[0] ^ len, b ^ secret[1]);
 }
 
 size_t hash(const void *data, size_t size) {
   assert(data != NULL || size == 0);
-  return (size_t)MurmurHash64A(data, size);
+
+  // common item sizes get a single mixing step, matching `hash_item`
+  if (hash_is_fixed(size))
+    return hash_fixed(data, size);
+
+  return (size_t)wyhash(data, size);
 }
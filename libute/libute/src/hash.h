@@ -0,0 +1,88 @@
+/// @file
+/// @brief Hashing internals
+///
+/// Most items stored in sets and dictionaries are 1, 2, 4 or 8 bytes wide. For
+/// these, the default hash is a single integer mixing function that can be
+/// inlined into callers. Wider data goes through the out-of-line `hash`.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/hash.h>
+
+/// mix the bits of a 64-bit value
+///
+/// This is the finaliser of MurmurHash3 by Austin Appleby. It is a bijection in
+/// which every input bit affects every output bit.
+///
+/// @param x Value to mix
+/// @return A hash digest of `x`
+static inline uint64_t hash_mix64(uint64_t x) {
+  x ^= x >> 33;
+  x *= UINT64_C(0xff51afd7ed558ccd);
+  x ^= x >> 33;
+  x *= UINT64_C(0xc4ceb9fe1a85ec53);
+  x ^= x >> 33;
+  return x;
+}
+
+/// derive a hash of fixed-width data
+///
+/// @param data Data to hash
+/// @param size Number of bytes at `data`, which must be 1, 2, 4 or 8
+/// @return A hash digest of the data
+static inline size_t hash_fixed(const void *data, size_t size) {
+  assert(data != NULL);
+
+  switch (size) {
+  case 1: {
+    uint8_t x;
+    memcpy(&x, data, sizeof(x));
+    return (size_t)hash_mix64(x);
+  }
+  case 2: {
+    uint16_t x;
+    memcpy(&x, data, sizeof(x));
+    return (size_t)hash_mix64(x);
+  }
+  case 4: {
+    uint32_t x;
+    memcpy(&x, data, sizeof(x));
+    return (size_t)hash_mix64(x);
+  }
+  }
+
+  assert(size == 8);
+  uint64_t x;
+  memcpy(&x, data, sizeof(x));
+  return (size_t)hash_mix64(x);
+}
+
+/// can data of this size be hashed with `hash_fixed`?
+static inline bool hash_is_fixed(size_t size) {
+  return size == 1 || size == 2 || size == 4 || size == 8;
+}
+
+/// hash an item with either a user-supplied hash or the default
+///
+/// The result is the same as calling `hash` when `user_hash` is null, but
+/// avoids a function call for common item sizes.
+///
+/// @param user_hash Optional user-supplied hash
+/// @param data Data to hash
+/// @param size Number of bytes at `data`
+/// @return A hash digest of the data
+static inline size_t hash_item(size_t (*user_hash)(const void *, size_t),
+                               const void *data, size_t size) {
+  if (user_hash != NULL)
+    return user_hash(data, size);
+  if (hash_is_fixed(size))
+    return hash_fixed(data, size);
+  return hash(data, size);
+}
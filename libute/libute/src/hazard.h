@@ -0,0 +1,134 @@
+/// @file
+/// @brief Hazard pointer internals
+///
+/// Each thread that publishes hazard pointers owns a record of slots, linked
+/// into a global list that is only ever prepended to. Records are released for
+/// reuse when their thread exits, so the list is bounded by the peak number of
+/// live threads rather than the total number ever created.
+///
+/// Retired allocations go into a bag private to the retiring thread. Once the
+/// bag reaches a threshold, the thread scans every record and deallocates
+/// those allocations that no slot points to. The threshold is kept at twice the
+/// number of allocations that survived the last scan, so a scan always frees
+/// at least as much as it keeps and its cost amortises across retirements.
+/// Bags of exiting threads that are still non-empty are left on a global list
+/// of orphans for later scans to adopt.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "backoff.h"
+#include "counter.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/hazard.h>
+
+/// a thread’s published slots
+///
+/// Records are allocated on a thread’s first publication and never freed. When
+/// the thread exits, its slots are cleared and the record is released for
+/// reuse by a later thread.
+typedef struct hazard_record {
+  alignas(CACHE_LINE) void *_Atomic slot[HAZARD_SLOTS]; ///< protected pointers
+
+  atomic_bool in_use; ///< is this record owned by a live thread?
+
+  struct hazard_record *next; ///< next record in `hazard_state_.records`
+} hazard_record_t;
+
+/// an allocation awaiting deallocation
+typedef struct {
+  void *ptr;                    ///< the allocation
+  void (*dtor)(void *, void *); ///< deallocator to eventually call
+  void *context;                ///< second parameter to `dtor`
+} hazard_retired_t;
+
+/// a collection of allocations awaiting deallocation
+typedef struct hazard_bag {
+  struct hazard_bag *next;  ///< next bag in `hazard_state_.orphans`
+  size_t size;              ///< number of occupied entries in `items`
+  size_t capacity;          ///< number of allocated entries in `items`
+  hazard_retired_t items[]; ///< retired allocations
+} hazard_bag_t;
+
+/// a thread’s private state
+typedef struct {
+  hazard_record_t *record; ///< our published slots, if we have them
+  hazard_bag_t *bag;       ///< allocations we have retired, if any
+  size_t threshold;        ///< bag size at which to scan next
+  bool scanning;           ///< are we within `hazard_scan`?
+
+  /// which slots are standing in for an unavailable record?
+  bool stalling[HAZARD_SLOTS];
+} hazard_thread_t;
+
+/// minimum bag size at which a retiring thread scans
+enum { HAZARD_SCAN_THRESHOLD = 64 };
+
+/// global state of hazard pointers
+typedef struct {
+  /// published slots of every thread that has ever published a pointer
+  alignas(CACHE_LINE) hazard_record_t *_Atomic records;
+
+  /// non-empty bags left behind by exited threads
+  hazard_bag_t *_Atomic orphans;
+
+  /// number of slots in use by threads without a published record
+  ///
+  /// A thread that fails to allocate a record falls back to counting its
+  /// protected pointers here, and nothing is deallocated while this is
+  /// non-zero.
+  atomic_size_t stalled;
+} hazard_state_t;
+
+/// global state of hazard pointers
+extern PRIVATE hazard_state_t hazard_state_;
+
+/// private state of the calling thread
+extern PRIVATE _Thread_local hazard_thread_t hazard_thread_;
+
+/// acquire a published record for the calling thread
+///
+/// This also arranges for the thread’s record and bag to be handed off when it
+/// exits.
+///
+/// @return The acquired record or `NULL` on out-of-memory
+PRIVATE hazard_record_t *hazard_register_(void);
+
+/// might any thread be using an allocation?
+///
+/// The caller must have issued a sequentially consistent fence since making
+/// `ptr` unreachable.
+///
+/// @param ptr Allocation to look for
+/// @return True if any slot protects `ptr` or reclamation is stalled
+PRIVATE bool hazard_is_protected_(const void *ptr);
+
+/// deallocate the unprotected allocations in a bag
+///
+/// Deallocators may retire further allocations into the bag, so it is
+/// re-read through `bag` after every call to one.
+///
+/// @param bag Bag to sweep
+PRIVATE void hazard_sweep_(hazard_bag_t **bag);
+
+/// leave a bag for a later scan to adopt
+///
+/// @param bag Bag to hand off
+static inline void hazard_orphan(hazard_bag_t *bag) {
+  assert(bag != NULL);
+
+  backoff_t backoff = {0};
+  bag->next =
+      atomic_load_explicit(&hazard_state_.orphans, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(&hazard_state_.orphans,
+                                                &bag->next, bag,
+                                                memory_order_release,
+                                                memory_order_relaxed))
+    backoff_(&backoff);
+}
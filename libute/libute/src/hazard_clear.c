@@ -0,0 +1,28 @@
+/// @file
+/// @brief Implementation of clearing a hazard pointer
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/hazard.h>
+
+void hazard_clear(size_t slot) {
+  assert(slot < HAZARD_SLOTS);
+
+  hazard_thread_t *const self = &hazard_thread_;
+
+  // unlike publication, clearing needs no fence because sweepers only need to
+  // see it eventually
+  if (self->record != NULL)
+    atomic_store_explicit(&self->record->slot[slot], NULL,
+                          memory_order_release);
+
+  if (self->stalling[slot]) {
+    (void)atomic_fetch_sub_explicit(&hazard_state_.stalled, 1,
+                                    memory_order_release);
+    self->stalling[slot] = false;
+  }
+}
@@ -0,0 +1,28 @@
+/// @file
+/// @brief Implementation of checking whether an allocation is protected
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/hazard.h>
+
+bool hazard_is_protected_(const void *ptr) {
+
+  // a thread without a record could be protecting anything
+  if (atomic_load_explicit(&hazard_state_.stalled, memory_order_relaxed) > 0)
+    return true;
+
+  for (hazard_record_t *r =
+           atomic_load_explicit(&hazard_state_.records, memory_order_acquire);
+       r != NULL; r = r->next) {
+    for (size_t i = 0; i < HAZARD_SLOTS; ++i) {
+      if (atomic_load_explicit(&r->slot[i], memory_order_relaxed) == ptr)
+        return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,31 @@
+/// @file
+/// @brief Implementation of protecting a loaded pointer
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/hazard.h>
+
+void *hazard_protect(size_t slot, void *_Atomic *src) {
+  assert(slot < HAZARD_SLOTS);
+  assert(src != NULL);
+
+  backoff_t backoff = {0};
+  void *ptr = atomic_load_explicit(src, memory_order_acquire);
+  while (true) {
+    hazard_set(slot, ptr);
+
+    // if the pointer is still reachable, it was not retired before we
+    // published it
+    void *const again = atomic_load_explicit(src, memory_order_acquire);
+    if (again == ptr)
+      return ptr;
+
+    ptr = again;
+    backoff_(&backoff);
+  }
+}
@@ -0,0 +1,124 @@
+/// @file
+/// @brief Implementation of acquiring a per-thread hazard pointer record
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "hazard.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ute/hazard.h>
+
+#if USE_PTHREADS
+#include <pthread.h>
+
+/// key whose destructor hands off a thread’s state when the thread exits
+static pthread_key_t key;
+
+/// was `key` successfully created?
+static bool have_key;
+
+/// guard for creating `key`
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/// release the record and bag of an exiting thread
+///
+/// @param thread State of the exiting thread
+static void release(void *thread) {
+  hazard_thread_t *const self = thread;
+  assert(!self->scanning && "thread exited during a scan");
+
+  // drop any protection we still hold
+  if (self->record != NULL) {
+    for (size_t i = 0; i < HAZARD_SLOTS; ++i)
+      atomic_store_explicit(&self->record->slot[i], NULL,
+                            memory_order_relaxed);
+    atomic_store_explicit(&self->record->in_use, false, memory_order_release);
+    self->record = NULL;
+  }
+  for (size_t i = 0; i < HAZARD_SLOTS; ++i) {
+    if (!self->stalling[i])
+      continue;
+    (void)atomic_fetch_sub_explicit(&hazard_state_.stalled, 1,
+                                    memory_order_release);
+    self->stalling[i] = false;
+  }
+
+  // deallocate what we can and leave the rest for someone else
+  if (self->bag == NULL)
+    return;
+  self->scanning = true;
+  hazard_sweep_(&self->bag);
+  self->scanning = false;
+  hazard_bag_t *const bag = self->bag;
+  self->bag = NULL;
+  if (bag->size == 0) {
+    free(bag);
+  } else {
+    hazard_orphan(bag);
+  }
+}
+
+/// create `key`
+static void make_key(void) {
+  have_key = pthread_key_create(&key, release) == 0;
+}
+#endif
+
+hazard_record_t *hazard_register_(void) {
+  hazard_thread_t *const self = &hazard_thread_;
+
+#if USE_PTHREADS
+  // arrange for our state to be handed off when we exit
+  (void)pthread_once(&key_once, make_key);
+  if (have_key)
+    (void)pthread_setspecific(key, self);
+#endif
+
+  if (self->record != NULL)
+    return self->record;
+
+  // try to reuse a record released by a thread that has since exited
+  hazard_record_t *r =
+      atomic_load_explicit(&hazard_state_.records, memory_order_acquire);
+  for (; r != NULL; r = r->next) {
+    bool in_use = false;
+    if (atomic_compare_exchange_strong_explicit(&r->in_use, &in_use, true,
+                                                memory_order_acq_rel,
+                                                memory_order_relaxed))
+      break;
+  }
+
+  if (r == NULL) {
+    // Records are never freed, so allocate with slack to align them by hand
+    // rather than using `ALIGNED_ALLOC`, whose leak checks would flag them.
+    void *const p = calloc(1, sizeof(*r) + alignof(hazard_record_t));
+    if (p == NULL)
+      return NULL;
+    const uintptr_t aligned = ((uintptr_t)p + alignof(hazard_record_t) - 1) /
+                              alignof(hazard_record_t) *
+                              alignof(hazard_record_t);
+    r = (hazard_record_t *)aligned;
+    for (size_t i = 0; i < HAZARD_SLOTS; ++i)
+      atomic_init(&r->slot[i], NULL);
+    atomic_init(&r->in_use, true);
+
+    // add it to the list of records
+    backoff_t backoff = {0};
+    r->next =
+        atomic_load_explicit(&hazard_state_.records, memory_order_acquire);
+    while (!atomic_compare_exchange_weak_explicit(&hazard_state_.records,
+                                                  &r->next, r,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire))
+      backoff_(&backoff);
+  }
+
+  self->record = r;
+  return r;
+}
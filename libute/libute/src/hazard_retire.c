@@ -0,0 +1,47 @@
+/// @file
+/// @brief Implementation of retiring an allocation protected by hazard pointers
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/hazard.h>
+
+void hazard_retire(void *ptr, void (*dtor)(void *, void *), void *context) {
+  assert(ptr != NULL);
+  assert(dtor != NULL);
+
+  hazard_thread_t *const self = &hazard_thread_;
+
+  // make sure our bag is handed off if we exit
+  if (self->record == NULL)
+    (void)hazard_register_();
+
+  // make room in our bag
+  hazard_bag_t *bag = self->bag;
+  if (bag == NULL || bag->size == bag->capacity) {
+    const size_t c = bag == NULL ? HAZARD_SCAN_THRESHOLD : bag->capacity * 2;
+    hazard_bag_t *const b = realloc(bag, sizeof(*b) + c * sizeof(b->items[0]));
+    if (b == NULL) {
+      // out of memory, so wait for anyone using the allocation instead
+      do {
+        atomic_thread_fence(memory_order_seq_cst);
+      } while (hazard_is_protected_(ptr));
+      dtor(ptr, context);
+      return;
+    }
+    if (bag == NULL)
+      *b = (hazard_bag_t){0};
+    b->capacity = c;
+    self->bag = bag = b;
+  }
+
+  bag->items[bag->size++] =
+      (hazard_retired_t){.ptr = ptr, .dtor = dtor, .context = context};
+
+  if (bag->size >= HAZARD_SCAN_THRESHOLD && bag->size >= self->threshold)
+    hazard_scan();
+}
@@ -0,0 +1,44 @@
+/// @file
+/// @brief Implementation of deallocating retired allocations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/hazard.h>
+
+void hazard_scan(void) {
+  hazard_thread_t *const self = &hazard_thread_;
+
+  // if a deallocator called us, leave the outer scan to finish
+  if (self->scanning)
+    return;
+  self->scanning = true;
+
+  if (self->bag != NULL) {
+    hazard_sweep_(&self->bag);
+
+    // wait until the bag has doubled before scanning again
+    self->threshold = 2 * self->bag->size;
+  }
+
+  // adopt bags left behind by exited threads, putting back whatever survives
+  hazard_bag_t *orphans =
+      atomic_exchange_explicit(&hazard_state_.orphans, NULL,
+                               memory_order_acquire);
+  while (orphans != NULL) {
+    hazard_bag_t *bag = orphans;
+    orphans = bag->next;
+    hazard_sweep_(&bag);
+    if (bag->size == 0) {
+      free(bag);
+    } else {
+      hazard_orphan(bag);
+    }
+  }
+
+  self->scanning = false;
+}
@@ -0,0 +1,42 @@
+/// @file
+/// @brief Implementation of publishing a hazard pointer
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/hazard.h>
+
+void hazard_set(size_t slot, const void *ptr) {
+  assert(slot < HAZARD_SLOTS);
+
+  hazard_thread_t *const self = &hazard_thread_;
+
+  if (self->record == NULL && ptr != NULL)
+    (void)hazard_register_();
+
+  if (self->record != NULL) {
+    atomic_store_explicit(&self->record->slot[slot], (void *)ptr,
+                          memory_order_relaxed);
+  } else if (ptr != NULL && !self->stalling[slot]) {
+    // if we could not get a record, stall reclamation for everyone instead
+    (void)atomic_fetch_add_explicit(&hazard_state_.stalled, 1,
+                                    memory_order_relaxed);
+    self->stalling[slot] = true;
+  }
+
+  // Order our publication before the caller re-reads the pointer’s source. A
+  // thread sweeping the pointer either sees our publication, or unlinked the
+  // pointer before our caller’s re-read and so the caller will not use it.
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // if this slot was previously stalling and no longer needs to, stop
+  if (self->stalling[slot] && (self->record != NULL || ptr == NULL)) {
+    (void)atomic_fetch_sub_explicit(&hazard_state_.stalled, 1,
+                                    memory_order_release);
+    self->stalling[slot] = false;
+  }
+}
@@ -0,0 +1,10 @@
+/// @file
+/// @brief Storage for hazard pointer state
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+
+hazard_state_t hazard_state_;
+
+_Thread_local hazard_thread_t hazard_thread_;
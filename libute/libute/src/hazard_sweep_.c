@@ -0,0 +1,39 @@
+/// @file
+/// @brief Implementation of deallocating unprotected retired allocations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hazard.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+void hazard_sweep_(hazard_bag_t **bag) {
+  assert(bag != NULL);
+  assert(*bag != NULL);
+
+  // Order the unlinking of everything in the bag before our reads of other
+  // threads’ slots. A thread that published a pointer after this either
+  // re-reads its source after we unlinked it or is seen by us.
+  atomic_thread_fence(memory_order_seq_cst);
+  size_t fenced = (*bag)->size;
+
+  // compact the survivors to the front of the bag, as we go
+  size_t kept = 0;
+  for (size_t i = 0; i < (*bag)->size; ++i) {
+
+    // if a deallocator retired something more, fence its unlinking too
+    if (i == fenced) {
+      atomic_thread_fence(memory_order_seq_cst);
+      fenced = (*bag)->size;
+    }
+
+    const hazard_retired_t r = (*bag)->items[i];
+    if (hazard_is_protected_(r.ptr)) {
+      (*bag)->items[kept++] = r;
+      continue;
+    }
+    r.dtor(r.ptr, r.context);
+  }
+  (*bag)->size = kept;
+}
@@ -0,0 +1,395 @@
+/// @file
+/// @brief Unsynchronised hash table internals
+///
+/// This is the backing store for sets and dictionaries declared with
+/// `SET_LOCAL` and `DICT_LOCAL`. These are only ever accessed by one thread at
+/// a time, so none of the machinery the concurrent implementations need
+/// applies. There is no shared pointer to the table, no atomic operations on
+/// its slots and no incremental migration. Entries are stored directly in the
+/// table, regardless of their size, because they never need to be swapped in
+/// or out with a single atomic instruction.
+///
+/// A table looks like:
+///
+///   local_table_t
+///   ┌──────────┐
+///   │   mask   │
+///   ├──────────┤
+///   │   size   │
+///   ├──────────┤
+///   │   used   │
+///   ├──────────┤
+///   │ entries  ├──┐
+///   ├──────────┤  │
+///   │   ctrl   │  │  one byte per slot: empty, deleted or a tag of the hash
+///   │    …     │  │
+///   ├──────────┤  │
+///   │ padding  │  │
+///   ├──────────┤◄─┘
+///   │  entry   │  `stride` bytes per slot: the key, followed by any value
+///   │    …     │
+///   └──────────┘
+///
+/// This is all a single allocation. Collisions are resolved by linear probing.
+/// A slot’s control byte lets most non-matching slots be skipped without
+/// touching the entries themselves.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "hash.h"
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ute/aligned_alloc.h>
+#include <ute/dict.h>
+#include <ute/set.h>
+
+/// how entries are arranged in a table
+typedef struct {
+  size_t alignment;    ///< required alignment of entries
+  size_t stride;       ///< byte distance between consecutive entries
+  size_t key_size;     ///< byte size of the key at the start of each entry
+  size_t value_offset; ///< byte offset of any value following the key
+
+  size_t (*hash)(const void *, size_t);           ///< optional key hasher
+  bool (*eq)(const void *, const void *, size_t); ///< optional key comparator
+  void (*key_dtor)(void *);                       ///< optional key destructor
+  void (*value_dtor)(void *); ///< optional value destructor
+} local_layout_t;
+
+/// a table
+typedef struct {
+  size_t mask; ///< number of slots - 1, where the number of slots is a power
+               ///< of 2
+  size_t size; ///< number of live entries
+  size_t used; ///< number of live entries plus tombstones
+
+  /// arrangement of the entries, for use when the table is freed
+  local_layout_t layout;
+
+  unsigned char *entries; ///< entry storage, `stride` bytes per slot
+  uint8_t ctrl[];         ///< per-slot state
+} local_table_t;
+
+/// control byte of a slot that has never been occupied
+enum { CTRL_EMPTY = 0 };
+
+/// control byte of a slot whose entry has been removed
+enum { CTRL_DELETED = 1 };
+
+/// bit set in the control byte of a slot that has a live entry
+enum { CTRL_FULL = 0x80 };
+
+/// maximum percentage of slots that can be used before the table is resized
+enum { LOAD_FACTOR = 70 };
+
+/// fewest slots a table is created with
+enum { MIN_SLOTS = 8 };
+
+/// construct the layout of a set’s table
+///
+/// @param sig Signature of the set item type
+/// @return A layout in which each entry is an item
+static inline local_layout_t local_set_layout(set_sig_t_ sig) {
+  return (local_layout_t){.alignment = sig.alignment,
+                          .stride = sig.size,
+                          .key_size = sig.size,
+                          .value_offset = sig.size,
+                          .hash = sig.hash,
+                          .eq = sig.eq,
+                          .key_dtor = sig.dtor};
+}
+
+/// get the offset of the value within a dictionary entry
+///
+/// @param sig Signature of the dictionary
+/// @return Byte offset of the value from the start of its entry
+static inline size_t local_dict_value_offset(dict_sig_t_ sig) {
+  assert(sig.value_alignment > 0);
+  return (sig.key_size + sig.value_alignment - 1) / sig.value_alignment *
+         sig.value_alignment;
+}
+
+/// construct the layout of a dictionary’s table
+///
+/// @param sig Signature of the dictionary
+/// @return A layout in which each entry is a key followed by its value
+static inline local_layout_t local_dict_layout(dict_sig_t_ sig) {
+  const size_t alignment = sig.key_alignment > sig.value_alignment
+                               ? sig.key_alignment
+                               : sig.value_alignment;
+  const size_t value_offset = local_dict_value_offset(sig);
+  const size_t end = value_offset + sig.value_size;
+  const size_t stride = (end + alignment - 1) / alignment * alignment;
+
+  // dictionary keys are compared bitwise, so no comparator
+  return (local_layout_t){.alignment = alignment,
+                          .stride = stride,
+                          .key_size = sig.key_size,
+                          .value_offset = value_offset,
+                          .hash = sig.hash,
+                          .key_dtor = sig.key_dtor,
+                          .value_dtor = sig.value_dtor};
+}
+
+/// get the number of slots in a table
+static inline size_t local_slots(const local_table_t *table) {
+  return table->mask + 1;
+}
+
+/// get the entry of a given slot
+///
+/// @param table Table to inspect
+/// @param index Slot index
+/// @param layout Arrangement of the table’s entries
+/// @return Pointer to the slot’s entry
+static inline void *local_entry(const local_table_t *table, size_t index,
+                                local_layout_t layout) {
+  assert(index <= table->mask);
+  return table->entries + index * layout.stride;
+}
+
+/// derive the control byte of a live entry from its hash
+static inline uint8_t local_tag(size_t h) {
+  return (uint8_t)(CTRL_FULL | (h >> (sizeof(h) * CHAR_BIT - 7)));
+}
+
+/// hash a key
+static inline size_t local_hash(const void *key, local_layout_t layout) {
+  return hash_item(layout.hash, key, layout.key_size);
+}
+
+/// compare two keys
+static inline bool local_eq(const void *a, const void *b,
+                            local_layout_t layout) {
+  if (layout.eq != NULL)
+    return layout.eq(a, b, layout.key_size);
+  return layout.key_size == 0 || memcmp(a, b, layout.key_size) == 0;
+}
+
+/// get the number of slots needed to hold `n` entries without reaching the
+/// load factor
+///
+/// @param n Number of entries, at most `SIZE_MAX / 100`
+/// @return A power of 2 number of slots
+static inline size_t local_slots_for(size_t n) {
+  assert(n <= SIZE_MAX / 100);
+
+  size_t slots = MIN_SLOTS;
+  while (slots <= SIZE_MAX / 128 && slots * LOAD_FACTOR <= n * 100)
+    slots *= 2;
+  return slots;
+}
+
+/// does a table need to be resized before another entry is inserted?
+///
+/// @param table Table to inspect, or `NULL` if none has been allocated yet
+/// @return True if an insertion could exceed the load factor
+static inline bool local_needs_resize(const local_table_t *table) {
+  if (table == NULL)
+    return true;
+  return (table->used + 1) * 100 > local_slots(table) * LOAD_FACTOR;
+}
+
+/// find the slot of a key
+///
+/// @param table Table to search, or `NULL` if none has been allocated yet
+/// @param key Key to seek
+/// @param h Hash of `key`
+/// @param layout Arrangement of the table’s entries
+/// @return Index of the slot containing `key` or `SIZE_MAX` if it is absent
+static inline size_t local_find(const local_table_t *table, const void *key,
+                                size_t h, local_layout_t layout) {
+  if (table == NULL)
+    return SIZE_MAX;
+
+  const uint8_t tag = local_tag(h);
+  for (size_t i = 0, index = h & table->mask; i <= table->mask;
+       ++i, index = (index + 1) & table->mask) {
+    const uint8_t ctrl = table->ctrl[index];
+    if (ctrl == CTRL_EMPTY)
+      break;
+    if (ctrl == tag && local_eq(local_entry(table, index, layout), key, layout))
+      return index;
+  }
+
+  return SIZE_MAX;
+}
+
+/// find the slot of a key or the slot it should be inserted into
+///
+/// The table must have room for another entry.
+///
+/// @param table Table to search
+/// @param key Key to seek
+/// @param h Hash of `key`
+/// @param layout Arrangement of the table’s entries
+/// @param found [out] Whether `key` was found
+/// @return Index of the slot containing `key` if it was found, or else the
+///   first free slot on its probe sequence
+static inline size_t local_probe(const local_table_t *table, const void *key,
+                                 size_t h, local_layout_t layout,
+                                 bool *found) {
+  assert(table != NULL);
+  assert(found != NULL);
+
+  const uint8_t tag = local_tag(h);
+  size_t deleted = SIZE_MAX;
+  for (size_t i = 0, index = h & table->mask; i <= table->mask;
+       ++i, index = (index + 1) & table->mask) {
+    const uint8_t ctrl = table->ctrl[index];
+    if (ctrl == CTRL_EMPTY) {
+      *found = false;
+      // prefer reusing a tombstone we passed
+      return deleted != SIZE_MAX ? deleted : index;
+    }
+    if (ctrl == CTRL_DELETED) {
+      if (deleted == SIZE_MAX)
+        deleted = index;
+      continue;
+    }
+    if (ctrl == tag &&
+        local_eq(local_entry(table, index, layout), key, layout)) {
+      *found = true;
+      return index;
+    }
+  }
+
+  // the load factor guarantees we find at least an empty or deleted slot
+  assert(deleted != SIZE_MAX && "no free slots in table");
+  *found = false;
+  return deleted;
+}
+
+/// mark a slot as occupied by a new entry
+///
+/// @param table Table to update
+/// @param index Slot that was returned by `local_probe`
+/// @param h Hash of the entry’s key
+static inline void local_occupy(local_table_t *table, size_t index, size_t h) {
+  assert(index <= table->mask);
+  assert((table->ctrl[index] & CTRL_FULL) == 0);
+
+  if (table->ctrl[index] == CTRL_EMPTY)
+    ++table->used;
+  table->ctrl[index] = local_tag(h);
+  ++table->size;
+}
+
+/// mark a slot as no longer occupied
+///
+/// @param table Table to update
+/// @param index Slot whose entry has been removed
+static inline void local_vacate(local_table_t *table, size_t index) {
+  assert(index <= table->mask);
+  assert((table->ctrl[index] & CTRL_FULL) != 0);
+
+  // if the next slot is empty, no probe sequence continues past this one and
+  // it can be marked empty instead of leaving a tombstone
+  if (table->ctrl[(index + 1) & table->mask] == CTRL_EMPTY) {
+    table->ctrl[index] = CTRL_EMPTY;
+    --table->used;
+  } else {
+    table->ctrl[index] = CTRL_DELETED;
+  }
+  --table->size;
+}
+
+/// is this slot occupied by a live entry?
+static inline bool local_is_full_slot(const local_table_t *table,
+                                      size_t index) {
+  assert(index <= table->mask);
+  return (table->ctrl[index] & CTRL_FULL) != 0;
+}
+
+/// move a table’s entries into a new table with a given number of slots
+///
+/// If `*table` is `NULL`, a new empty table is allocated. On failure, `*table`
+/// is left unchanged.
+///
+/// @param table [inout] Table to resize
+/// @param slots Number of slots for the new table, a power of 2 that is large
+///   enough to hold the existing entries
+/// @param layout Arrangement of the table’s entries
+/// @return 0 on success or an errno on failure
+PRIVATE int local_table_resize_(local_table_t **table, size_t slots,
+                                local_layout_t layout);
+
+/// make room in a table for another entry
+///
+/// If the table is at its load factor, it is resized. When its live entries
+/// alone have outgrown it, it is doubled. Otherwise tombstones are what filled
+/// it, and it is resized such that its live entries fill at most half the load
+/// factor, which may grow or shrink it. Either way, tombstones are dropped.
+///
+/// @param table [inout] Table to operate on, which may point to `NULL`
+/// @param layout Arrangement of the table’s entries
+/// @return 0 on success or an errno on failure
+static inline int local_make_room(local_table_t **table,
+                                  local_layout_t layout) {
+  assert(table != NULL);
+
+  if (!local_needs_resize(*table))
+    return 0;
+
+  const size_t live = *table == NULL ? 0 : (*table)->size;
+  if (live >= SIZE_MAX / 200)
+    return ENOMEM;
+
+  // if the table has only filled up because of tombstones, leave headroom
+  // after reclaiming them so we do not immediately need to resize again
+  size_t slots = local_slots_for(live + 1);
+  if (*table != NULL && slots <= local_slots(*table))
+    slots = local_slots_for((live + 1) * 2);
+
+  return local_table_resize_(table, slots, layout);
+}
+
+/// deallocate a table
+///
+/// This does not destroy the table’s entries.
+///
+/// @param table Table to deallocate, or `NULL`
+static inline void local_table_free(local_table_t *table) {
+  if (table == NULL)
+    return;
+
+  // must match the allocation in `local_table_resize_`
+  if (table->layout.alignment > alignof(max_align_t)) {
+    ALIGNED_FREE(table);
+  } else {
+    free(table);
+  }
+}
+
+/// destroy a table’s entries and deallocate it
+///
+/// @param table Table to destroy, or `NULL`
+static inline void local_table_destroy(local_table_t *table) {
+  if (table == NULL)
+    return;
+
+  const local_layout_t layout = table->layout;
+  if (layout.key_dtor != NULL || layout.value_dtor != NULL) {
+    for (size_t i = 0; i < local_slots(table); ++i) {
+      if (!local_is_full_slot(table, i))
+        continue;
+      unsigned char *const entry = local_entry(table, i, layout);
+      if (layout.key_dtor != NULL)
+        layout.key_dtor(entry);
+      if (layout.value_dtor != NULL)
+        layout.value_dtor(entry + layout.value_offset);
+    }
+  }
+
+  local_table_free(table);
+}
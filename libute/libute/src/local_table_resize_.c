@@ -0,0 +1,78 @@
+/// @file
+/// @brief Implementation of resizing an unsynchronised hash table
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ute/aligned_alloc.h>
+
+int local_table_resize_(local_table_t **table, size_t slots,
+                        local_layout_t layout) {
+  assert(table != NULL);
+  assert(slots > 0 && (slots & (slots - 1)) == 0);
+  assert(*table == NULL || (*table)->size * 100 < slots * LOAD_FACTOR);
+  assert(layout.alignment > 0 && (layout.alignment & (layout.alignment - 1)) ==
+                                     0);
+
+  // how large is the header and control bytes, rounded up to the alignment of
+  // the entries that follow them?
+  const size_t header = offsetof(local_table_t, ctrl);
+  if (slots > SIZE_MAX - header - layout.alignment)
+    return ENOMEM;
+  const size_t offset = (header + slots + layout.alignment - 1) /
+                        layout.alignment * layout.alignment;
+  if (layout.stride > 0 && slots > (SIZE_MAX - offset) / layout.stride)
+    return ENOMEM;
+  size_t size = offset + slots * layout.stride;
+
+  // allocate the new table, using the regular allocator if possible
+  local_table_t *t;
+  if (layout.alignment > alignof(max_align_t)) {
+    const size_t alignment = layout.alignment;
+    if (size > SIZE_MAX - alignment)
+      return ENOMEM;
+    size = (size + alignment - 1) / alignment * alignment;
+    t = ALIGNED_ALLOC(alignment, size);
+  } else {
+    t = malloc(size);
+  }
+  if (t == NULL)
+    return ENOMEM;
+
+  *t = (local_table_t){.mask = slots - 1,
+                       .layout = layout,
+                       .entries = (unsigned char *)t + offset};
+  memset(t->ctrl, CTRL_EMPTY, slots);
+
+  // move across the live entries of the old table, dropping tombstones
+  local_table_t *const old = *table;
+  if (old != NULL) {
+    for (size_t i = 0; i < local_slots(old); ++i) {
+      if (!local_is_full_slot(old, i))
+        continue;
+      const void *const entry = local_entry(old, i, layout);
+      const size_t h = local_hash(entry, layout);
+
+      // all entries are distinct, so we only need to find an empty slot
+      size_t index = h & t->mask;
+      while (t->ctrl[index] != CTRL_EMPTY)
+        index = (index + 1) & t->mask;
+
+      if (layout.stride > 0)
+        memcpy(local_entry(t, index, layout), entry, layout.stride);
+      local_occupy(t, index, h);
+    }
+    local_table_free(old);
+  }
+
+  *table = t;
+  return 0;
+}
@@ -0,0 +1,82 @@
+/// @file
+/// @brief Bounded queue internals
+///
+/// The backing storage of a queue is a header followed by a ring of slots. The
+/// header holds the positions pushes and pops will next claim, each on its own
+/// cache line so producers and consumers do not contend with each other.
+/// Positions only ever increase, and a position p corresponds to the slot at
+/// index p modulo the capacity.
+///
+/// Each slot holds a sequence number followed by an item. A slot whose
+/// sequence number is p is waiting to be pushed to by whoever claims position
+/// p. Once the item has been written, its sequence number becomes p + 1 and it
+/// is waiting to be popped by whoever claims position p. Once the item has been
+/// read, its sequence number becomes p + capacity, the next position that will
+/// use it. Because positions never repeat (modulo wrapping a `size_t`), a
+/// thread that is delayed between reading a position and claiming it cannot be
+/// fooled by the queue having cycled back round to the same state.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "counter.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/queue.h>
+
+/// backing storage of a queue
+typedef struct {
+  size_t mask;   ///< capacity - 1
+  size_t base;   ///< byte offset from the start of this to the first slot
+  size_t stride; ///< byte size of a slot
+  size_t offset; ///< byte offset within a slot to its item
+  size_t size;   ///< byte size of an item
+
+  alignas(CACHE_LINE) atomic_size_t tail; ///< next position to push to
+  alignas(CACHE_LINE) atomic_size_t head; ///< next position to pop from
+} queue_impl_t;
+
+/// get the sequence number of the slot for a given position
+///
+/// @param q Queue to inspect
+/// @param pos Position whose slot to look up
+/// @return The slot’s sequence number
+static inline atomic_size_t *queue_seq(queue_impl_t *q, size_t pos) {
+  unsigned char *const base = (unsigned char *)q + q->base;
+  return (void *)(base + (pos & q->mask) * q->stride);
+}
+
+/// get the item of the slot for a given position
+///
+/// @param q Queue to inspect
+/// @param pos Position whose slot to look up
+/// @return The slot’s item
+static inline void *queue_item(queue_impl_t *q, size_t pos) {
+  return (unsigned char *)queue_seq(q, pos) + q->offset;
+}
+
+/// get the backing storage of a queue, allocating it if necessary
+///
+/// @param queue Queue to operate on
+/// @param sig Signature of the queue
+/// @return Backing storage on success or `NULL` if out of memory
+PRIVATE queue_impl_t *queue_storage_(queue_t_ *queue, queue_sig_t_ sig);
+
+/// push a run of items
+///
+/// @param q Queue to operate on
+/// @param items Items to push
+/// @param n Number of items in `items`, at least 1
+/// @return Number of items pushed
+PRIVATE size_t queue_enqueue_(queue_impl_t *q, const void *items, size_t n);
+
+/// pop a run of items
+///
+/// @param q Queue to operate on
+/// @param items [out] Popped items
+/// @param n Maximum number of items to pop, at least 1
+/// @return Number of items popped
+PRIVATE size_t queue_dequeue_(queue_impl_t *q, void *items, size_t n);
@@ -0,0 +1,61 @@
+/// @file
+/// @brief Implementation of popping a run of items from a queue
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "queue.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+size_t queue_dequeue_(queue_impl_t *q, void *items, size_t n) {
+  assert(q != NULL);
+  assert(items != NULL || q->size == 0);
+  assert(n > 0);
+
+  backoff_t backoff = {0};
+  size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+  size_t k;
+  while (true) {
+    // count how many slots from `pos` onwards are waiting to be popped from
+    size_t seq = 0;
+    for (k = 0; k < n; ++k) {
+      seq = atomic_load_explicit(queue_seq(q, pos + k), memory_order_acquire);
+      if (seq != pos + k + 1)
+        break;
+    }
+
+    if (k == 0) {
+      // has the first slot not yet been pushed to?
+      if ((intptr_t)(seq - (pos + 1)) < 0)
+        return 0;
+
+      // otherwise another consumer has claimed it
+      backoff_(&backoff);
+      pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+      continue;
+    }
+
+    // try to claim the slots we found
+    if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + k,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed))
+      break;
+    backoff_(&backoff);
+  }
+
+  // empty the slots and hand each one over to producers on the next lap
+  unsigned char *const it = items;
+  for (size_t i = 0; i < k; ++i) {
+    if (q->size > 0)
+      memcpy(it + i * q->size, queue_item(q, pos + i), q->size);
+    atomic_store_explicit(queue_seq(q, pos + i), pos + i + q->mask + 1,
+                          memory_order_release);
+  }
+
+  return k;
+}
@@ -0,0 +1,19 @@
+/// @file
+/// @brief Implementation of queue deallocation
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/aligned_alloc.h>
+#include <ute/queue.h>
+
+void queue_free_(queue_t_ *queue) {
+  assert(queue != NULL);
+
+  void *const q = atomic_load_explicit(&queue->storage, memory_order_acquire);
+  ALIGNED_FREE(q);
+  atomic_store_explicit(&queue->storage, NULL, memory_order_release);
+}
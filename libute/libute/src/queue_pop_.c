@@ -0,0 +1,26 @@
+/// @file
+/// @brief Implementation of queue pop
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/queue.h>
+
+bool queue_pop_(queue_t_ *queue, void *item, queue_sig_t_ sig UNUSED) {
+  assert(queue != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  queue_impl_t *const q =
+      atomic_load_explicit(&queue->storage, memory_order_acquire);
+
+  // if the queue is unallocated, it is semantically empty
+  if (q == NULL)
+    return false;
+
+  return queue_dequeue_(q, item, 1) > 0;
+}
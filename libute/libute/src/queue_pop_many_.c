@@ -0,0 +1,29 @@
+/// @file
+/// @brief Implementation of batched queue pop
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/queue.h>
+
+size_t queue_pop_many_(queue_t_ *queue, void *items, size_t n,
+                       queue_sig_t_ sig UNUSED) {
+  assert(queue != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+
+  if (n == 0)
+    return 0;
+
+  queue_impl_t *const q =
+      atomic_load_explicit(&queue->storage, memory_order_acquire);
+
+  // if the queue is unallocated, it is semantically empty
+  if (q == NULL)
+    return 0;
+
+  return queue_dequeue_(q, items, n);
+}
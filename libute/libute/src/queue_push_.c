@@ -0,0 +1,27 @@
+/// @file
+/// @brief Implementation of queue push
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <ute/queue.h>
+
+int queue_push_(queue_t_ *queue, const void *item, queue_sig_t_ sig) {
+  assert(queue != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  if (sig.capacity == 0)
+    return EINVAL;
+
+  queue_impl_t *const q = queue_storage_(queue, sig);
+  if (q == NULL)
+    return ENOMEM;
+
+  if (queue_enqueue_(q, item, 1) == 0)
+    return EAGAIN;
+
+  return 0;
+}
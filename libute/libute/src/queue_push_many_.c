@@ -0,0 +1,26 @@
+/// @file
+/// @brief Implementation of batched queue push
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/queue.h>
+
+size_t queue_push_many_(queue_t_ *queue, const void *items, size_t n,
+                        queue_sig_t_ sig) {
+  assert(queue != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+
+  if (n == 0 || sig.capacity == 0)
+    return 0;
+
+  queue_impl_t *const q = queue_storage_(queue, sig);
+  if (q == NULL)
+    return 0;
+
+  // claim as many slots as there is room for in one go, so our items are kept
+  // together
+  return queue_enqueue_(q, items, n);
+}
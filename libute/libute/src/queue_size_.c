@@ -0,0 +1,31 @@
+/// @file
+/// @brief Implementation of queue size retrieval
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "queue.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/queue.h>
+
+size_t queue_size_(queue_t_ *queue) {
+  assert(queue != NULL);
+
+  queue_impl_t *const q =
+      atomic_load_explicit(&queue->storage, memory_order_acquire);
+
+  // if the queue is unallocated, it is semantically empty
+  if (q == NULL)
+    return 0;
+
+  // Read the head first. The tail can only have moved forwards by the time we
+  // read it, so will not be behind this. But it may have moved forwards far
+  // enough for the difference to exceed the capacity.
+  const size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+  const size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+  const size_t size = tail - head;
+  if (size > q->mask + 1)
+    return q->mask + 1;
+  return size;
+}
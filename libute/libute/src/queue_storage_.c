@@ -0,0 +1,86 @@
+/// @file
+/// @brief Implementation of lazily allocating a queue’s backing storage
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "counter.h"
+#include "queue.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/aligned_alloc.h>
+#include <ute/queue.h>
+
+/// round up to a multiple of a power of 2
+///
+/// @param n Value to round
+/// @param align Power of 2 to round to
+/// @return The rounded value
+static size_t round_up(size_t n, size_t align) {
+  return (n + align - 1) & ~(align - 1);
+}
+
+queue_impl_t *queue_storage_(queue_t_ *queue, queue_sig_t_ sig) {
+  assert(queue != NULL);
+  assert(sig.capacity > 0);
+
+  {
+    queue_impl_t *const q =
+        atomic_load_explicit(&queue->storage, memory_order_acquire);
+    if (q != NULL)
+      return q;
+  }
+
+  // round the capacity up to a power of 2, so positions can be mapped to slots
+  // with a mask and `SIZE_MAX + 1` is a multiple of it
+  size_t capacity = 2;
+  while (capacity < sig.capacity) {
+    if (capacity > SIZE_MAX / 2)
+      return NULL;
+    capacity *= 2;
+  }
+
+  // lay out a slot as a sequence number followed by the item
+  const size_t slot_align = sig.alignment > alignof(atomic_size_t)
+                                ? sig.alignment
+                                : alignof(atomic_size_t);
+  const size_t offset = round_up(sizeof(atomic_size_t), sig.alignment);
+  if (sig.size > SIZE_MAX - offset - slot_align)
+    return NULL;
+  const size_t stride = round_up(offset + sig.size, slot_align);
+
+  const size_t align = slot_align > alignof(queue_impl_t)
+                           ? slot_align
+                           : alignof(queue_impl_t);
+  const size_t base = round_up(sizeof(queue_impl_t), align);
+  if (capacity > (SIZE_MAX - base) / stride)
+    return NULL;
+  const size_t size = round_up(base + capacity * stride, align);
+
+  queue_impl_t *const q = ALIGNED_ALLOC(align, size);
+  if (q == NULL)
+    return NULL;
+
+  q->mask = capacity - 1;
+  q->base = base;
+  q->stride = stride;
+  q->offset = offset;
+  q->size = sig.size;
+  atomic_init(&q->tail, 0);
+  atomic_init(&q->head, 0);
+  for (size_t i = 0; i < capacity; ++i)
+    atomic_init(queue_seq(q, i), i);
+
+  // install our storage, unless someone else beat us to it
+  void *expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&queue->storage, &expected, q,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire)) {
+    ALIGNED_FREE(q);
+    return expected;
+  }
+
+  return q;
+}
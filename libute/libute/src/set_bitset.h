@@ -8,12 +8,27 @@
 
 #pragma once
 
+#include "epoch.h"
+#include "sp_ctrl.h"
 #include <limits.h>
 #include <stdatomic.h>
 #include <stdint.h>
 
 enum { WORD_SIZE = sizeof(uintptr_t) * CHAR_BIT };
 
+/// storage for a bitset
+///
+/// Lookups read the bitset without acquiring a reference to it, from within an
+/// epoch guard (see ./epoch.h). So the bitset is allocated together with the
+/// control block of its shared pointer, and retired rather than deallocated
+/// immediately when the last reference is released. The shared pointer itself
+/// points at `words`.
+typedef struct {
+  sp_ctrl_t ctrl;           ///< control block of the shared pointer to `words`
+  epoch_node_t retired;     ///< tracking for deferred deallocation
+  atomic_uintptr_t words[]; ///< the bits of the set
+} bitset_t;
+
 static inline uintptr_t slot_load(const atomic_uintptr_t *slot) {
   return atomic_load_explicit(slot, memory_order_acquire);
 }
@@ -4,6 +4,7 @@
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #include "set_bitset.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -11,6 +12,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <ute/asp.h>
+#include <ute/epoch.h>
 #include <ute/set.h>
 
 bool set_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
@@ -19,11 +21,15 @@ bool set_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
   assert(sig.size <= 2);
   assert(sig.dtor == NULL);
 
-  sp_t sp = sp_acq(&set->root);
+  // guard the bitset against being deallocated while we read it
+  epoch_enter();
+  const atomic_uintptr_t *const s = sp_peek_(&set->root);
 
   // if the bitset is not yet allocated, the set is empty
-  if (sp.ptr == NULL)
+  if (s == NULL) {
+    epoch_exit();
     return false;
+  }
 
   // materialise the value to find
   uintptr_t value = 0;
@@ -33,10 +39,9 @@ bool set_bitset_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
   // load its containing word
   const size_t word_offset = value / WORD_SIZE;
   const size_t bit_offset = value % WORD_SIZE;
-  atomic_uintptr_t *const s = sp.ptr;
   const uintptr_t word = slot_load(&s[word_offset]);
 
-  sp_rel(sp);
+  epoch_exit();
 
   // is it present?
   return (word & ((uintptr_t)1 << bit_offset)) != 0;
@@ -0,0 +1,58 @@
+/// @file
+/// @brief Implementation of batched set existence check, for bitset-backed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_bitset.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/asp.h>
+#include <ute/epoch.h>
+#include <ute/set.h>
+
+size_t set_bitset_contains_many_(set_t_ *set, const void *items, size_t n,
+                                 bool *found, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  // guard the bitset against being deallocated while we read it, across all
+  // items
+  epoch_enter();
+  const atomic_uintptr_t *const s = sp_peek_(&set->root);
+
+  const unsigned char *const it = items;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+
+    // if the bitset is not yet allocated, the set is empty
+    bool f = false;
+    if (s != NULL) {
+
+      // materialise the value to find
+      uintptr_t value = 0;
+      if (sig.size > 0)
+        memcpy(&value, it + i * sig.size, sig.size);
+
+      // load its containing word and check whether it is present
+      const size_t word_offset = value / WORD_SIZE;
+      const size_t bit_offset = value % WORD_SIZE;
+      const uintptr_t word = slot_load(&s[word_offset]);
+      f = (word & ((uintptr_t)1 << bit_offset)) != 0;
+    }
+
+    if (found != NULL)
+      found[i] = f;
+    count += f;
+  }
+
+  epoch_exit();
+
+  return count;
+}
@@ -0,0 +1,48 @@
+/// @file
+/// @brief Implementation of set iteration, for bitset-backed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_bitset.h"
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_bitset_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                        void *context, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(callback != NULL);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  sp_t sp = sp_acq(&set->root);
+
+  // if the bitset has not yet been allocated, the set is empty
+  if (sp.ptr == NULL)
+    return 0;
+
+  // how wide is the bitset?
+  const size_t bits = (size_t)1 << (sig.size * CHAR_BIT);
+  const size_t words = bits / WORD_SIZE + (bits % WORD_SIZE == 0 ? 0 : 1);
+
+  const atomic_uintptr_t *const s = sp.ptr;
+  int rc = 0;
+  for (size_t i = 0; i < words && rc == 0; ++i) {
+    uintptr_t slot = slot_load(&s[i]);
+    while (slot != 0 && rc == 0) {
+      const size_t bit = (size_t)__builtin_ctzll(slot);
+      slot &= slot - 1;
+
+      // the value this bit represents is also the representation of its item
+      const uintptr_t value = i * WORD_SIZE + bit;
+
+      rc = callback(&value, context);
+    }
+  }
+
+  sp_rel(sp);
+  return rc;
+}
@@ -3,7 +3,9 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "epoch.h"
 #include "set_bitset.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <errno.h>
 #include <limits.h>
@@ -17,6 +19,15 @@
 
 static void dtor(void *s, void *ignored UNUSED) { free(s); }
 
+/// retire a bitset whose last reference has been released
+///
+/// @param words Ignored
+/// @param bitset Storage of the bitset
+static void retire(void *words UNUSED, void *bitset) {
+  bitset_t *const b = bitset;
+  epoch_retire_(&b->retired, dtor, b, NULL);
+}
+
 int set_bitset_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig) {
   assert(set != NULL);
   assert(item != NULL || sig.size == 0);
@@ -31,16 +42,11 @@ retry:;
   if (sp.ptr == NULL) {
     const size_t bits = (size_t)1 << (sig.size * CHAR_BIT);
     const size_t words = bits / WORD_SIZE + (bits % WORD_SIZE == 0 ? 0 : 1);
-    atomic_uintptr_t *const s = calloc(words, sizeof(s[0]));
-    if (s == NULL)
+    bitset_t *const b = calloc(1, sizeof(*b) + words * sizeof(b->words[0]));
+    if (b == NULL)
       return ENOMEM;
 
-    sp_t new_sp = sp_new(s, dtor, NULL);
-    if (new_sp.ptr == NULL) {
-      dtor(s, NULL);
-      sp_rel(sp);
-      return ENOMEM;
-    }
+    sp_t new_sp = sp_new_in_(&b->ctrl, b->words, retire, b);
 
     if (!sp_cas(&set->root, sp, new_sp))
       sp_rel(new_sp);
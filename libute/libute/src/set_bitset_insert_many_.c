@@ -0,0 +1,71 @@
+/// @file
+/// @brief Implementation of batched set insertion, for bitset-backed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_bitset.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_bitset_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                            set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  if (n == 0)
+    return 0;
+
+  // insert the first item through the regular path, which takes care of
+  // allocating the bitset if necessary
+  unsigned char *const it = items;
+  {
+    const int rc = set_bitset_insert_(set, it, exists, sig);
+    if (rc != 0)
+      return rc;
+  }
+
+  // the bitset, once allocated, is never replaced so we can use a single
+  // reference to it for all remaining items
+  sp_t sp = sp_acq(&set->root);
+  atomic_uintptr_t *const s = sp.ptr;
+
+  // if someone freed the set in the meantime, fall back to inserting items
+  // one at a time
+  if (s == NULL) {
+    for (size_t i = 1; i < n; ++i) {
+      bool *const e = exists == NULL ? NULL : &exists[i];
+      const int rc = set_bitset_insert_(set, it + i * sig.size, e, sig);
+      if (rc != 0)
+        return rc;
+    }
+    return 0;
+  }
+
+  for (size_t i = 1; i < n; ++i) {
+
+    // materialise the value to insert
+    uintptr_t value = 0;
+    if (sig.size > 0)
+      memcpy(&value, it + i * sig.size, sig.size);
+
+    // insert it
+    const size_t word_offset = value / WORD_SIZE;
+    const size_t bit_offset = value % WORD_SIZE;
+    const uintptr_t old = slot_or(&s[word_offset], (uintptr_t)1 << bit_offset);
+
+    if (exists != NULL)
+      exists[i] = (old & ((uintptr_t)1 << bit_offset)) != 0;
+  }
+
+  sp_rel(sp);
+
+  return 0;
+}
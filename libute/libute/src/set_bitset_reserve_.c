@@ -0,0 +1,17 @@
+/// @file
+/// @brief Implementation of set pre-sizing, for bitset-backed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+int set_bitset_reserve_(set_t_ *set UNUSED, size_t n UNUSED,
+                        set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+
+  // this implementation has a fixed size, so there is nothing to do
+  return 0;
+}
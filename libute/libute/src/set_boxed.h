@@ -1,13 +1,18 @@
 /// @file
 /// @brief Boxed set internals
 ///
-/// The set implemented below stores its elements out-of-line in heap-allocated
-/// memory.
+/// The set implemented below stores its elements out-of-line, in blocks carved
+/// from a per-set slab (see ./slab.h).
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #pragma once
 
+#include "attr.h"
+#include "counter.h"
+#include "epoch.h"
+#include "slab.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -26,17 +31,58 @@
 ///   ┌───────┐   ┌──────────┐   ┌──────┬──────┬──────┬──
 ///   │ root¹ ├──►│   base   ├──►│  0   │  1   │  2   │ …
 ///   │       │   ├──────────┤   └──┬───┴──────┴──┬───┴──
-///   └───────┘   │   used   │      │             │
+///   └───────┘   │  next¹   │      │             │
 ///               ├──────────┤      ▼             ▼
-///               │ deleted  │   ┌──────┐      ┌──────┐
+///               │  stage   │   ┌──────┐      ┌──────┐
 ///               ├──────────┤   │ item │      │ item │
-///               │ capacity │   └──────┘      └──────┘
+///               │ claimed  │   └──────┘      └──────┘
+///               ├──────────┤
+///               │ migrated │
+///               ├──────────┤
+///               │   full   │
+///               ├──────────┤
+///               │ capacity │
+///               ├──────────┤
+///               │  used²   │
+///               ├──────────┤
+///               │ deleted² │
+///               ├──────────┤
+///               │   slab   │
+///               ├──────────┤
+///               │   ctrl   │
+///               ├──────────┤
+///               │ retired  │
 ///               └──────────┘
 ///
 /// `set_impl_t` carries no information about the size of set items. This is
 /// expected to be passed in by callers.
 ///
+/// Growing the set follows the same cooperative protocol as the unboxed set
+/// (see ./set_unboxed.h). Migrated items are shared between the old and new
+/// tables, rather than copied.
+///
+/// Each item is a single slab block that holds both the item and the control
+/// block of the shared pointer managing it:
+///
+///   ┌──────────┬─────┬──────┐
+///   │ sp_ctrl  │ pad │ item │
+///   └──────────┴─────┴──────┘
+///
+/// This means inserting an item usually needs no call to the system allocator
+/// and places the item’s reference count on the same cache line as its start.
+/// Successor tables share their predecessor’s slab. A slab is kept alive by
+/// the tables and items using it, so its memory is returned when the last of
+/// these is gone.
+///
+/// As with the unboxed set, lookups read the set from within an epoch guard
+/// rather than acquiring a reference to it, so the set embeds its own control
+/// block (`ctrl`) and is retired (`retired`) when its last reference is
+/// released. Items need no protection of their own, as a table holds a
+/// reference to every item it has ever contained until it is deallocated.
+///
 /// ¹ This is an atomic shared pointer, 2 words wide.
+/// ² These are striped counters (see ./counter.h), each stripe occupying its
+///   own cache line.
 typedef struct {
   /// backing storage of set slots
   ///
@@ -55,15 +101,39 @@ typedef struct {
   ///                               has been deleted? ─┘
   atomic_dword_t *base;
 
-  atomic_size_t used;    ///< how many slots are non-empty?
-  atomic_size_t deleted; ///< how many slots contain deleted items?
-  size_t capacity;       ///< exponent + 1 of how many total slots at `base`?
+  asp_t next; ///< set being migrated into, if any
+
+  atomic_int stage;       ///< migration status (see below)
+  atomic_size_t claimed;  ///< how many slots have been claimed by migrators?
+  atomic_size_t migrated; ///< how many slots have been moved to `next`?
+
+  atomic_bool full; ///< has the set reached its load factor?
+  size_t capacity;  ///< exponent + 1 of how many total slots at `base`?
+
+  counter_t used;    ///< how many slots are non-empty?
+  counter_t deleted; ///< how many slots contain deleted items?
+
+  slab_t *_Atomic slab; ///< allocator for items, created on first use
+
+  sp_ctrl_t ctrl;       ///< control block of the shared pointer to this set
+  epoch_node_t retired; ///< tracking for deferred deallocation
 } set_impl_t;
 
-/// get the capacity (in slots) of a set
-static inline size_t set_capacity(const set_impl_t set) {
-  return (size_t)1 << set.capacity >> 1;
-}
+/// values of `set_impl_t.stage`
+enum {
+  LIVE = 0,      ///< no migration has been started
+  GROWING = 1,   ///< a thread is allocating `next`
+  MIGRATING = 2, ///< `next` is published and slots are being moved to it
+};
+
+/// number of slots a migrator claims at once
+enum { MIGRATION_CHUNK = 64 };
+
+/// number of items hashed and prefetched ahead in batched operations
+enum { BATCH = 16 };
+
+// occupancy accounting, written in terms of the `set_impl_t` defined above
+#include "set_load.h"
 
 /// atomically read a slot from a hash table
 static inline dword_t slot_load(atomic_dword_t *slotptr) {
@@ -182,3 +252,117 @@ static inline bool eq(const void *a, const void *b, set_sig_t_ sig) {
     return sig.eq(a, b, sig.size);
   return memcmp(a, b, sig.size) == 0;
 }
+
+/// prefetch the slot an item with the given hash will be probed from
+///
+/// @param set Set to be probed
+/// @param h Hash of the sought item
+static inline void probe_prefetch(const set_impl_t *set, size_t h) {
+  assert(set != NULL);
+
+#ifdef __GNUC__
+  __builtin_prefetch((const void *)&set->base[h % set_capacity(set)]);
+#else
+  (void)h;
+#endif
+}
+
+/// find an item in a set table
+///
+/// @param set Set to search
+/// @param item Item to seek
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return True if the item was found
+static inline bool lookup(set_impl_t *set, const void *item, size_t h,
+                          set_sig_t_ sig) {
+  assert(set != NULL);
+
+  for (size_t i = 0; i < set_capacity(set); ++i) {
+    const size_t index = (h + i) % set_capacity(set);
+    const uintptr_t slot = half_slot_load(&set->base[index]);
+
+    // skip checking whether this slot is moved or not, because we do not care
+    // if we are racing with a rehashing and reading an older stale copy of the
+    // table
+
+    // if we see an empty slot, we have probed as far as this item would be
+    if (half_slot_is_free(slot))
+      break;
+
+    // skip tombstones
+    if (half_slot_is_deleted(slot))
+      continue;
+
+    // check if this is the item we are seeking
+    const void *const p = half_slot_to_ptr(slot);
+    if (eq(item, p, sig))
+      return true;
+  }
+
+  return false;
+}
+
+/// copy an item into a new slab block, ready for insertion into a set
+///
+/// The item is “consumed” regardless of whether this succeeds. That is, on
+/// failure the user-supplied destructor is run on `item`.
+///
+/// @param set Set table whose slab to allocate from
+/// @param item Item to copy
+/// @param sig Signature of the set item type
+/// @return A shared pointer to the copy or `(sp_t){0}` on out of memory
+PRIVATE sp_t set_boxed_box_(set_impl_t *set, void *item, set_sig_t_ sig);
+
+/// create a new, empty set
+///
+/// @param capacity Exponent + 1 of the number of slots to allocate
+/// @param slab Slab to allocate items from, or `NULL` to create one on demand
+/// @return A shared pointer to the set or `(sp_t){0}` on out of memory
+PRIVATE sp_t set_boxed_new_(size_t capacity, slab_t *slab);
+
+/// insert an item into a set table
+///
+/// The return value means:
+///   • 0 – the item was inserted
+///   • `EEXIST` – the item was already present
+///   • `ENOMEM` – not enough space to insert the item or a migration has begun
+///
+/// On success, the set takes ownership of `item`.
+///
+/// @param set Set to operate on
+/// @param item Copy to insert
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_boxed_put_(set_impl_t *set, sp_t item, size_t h,
+                           set_sig_t_ sig);
+
+/// begin migrating a set into a new table
+///
+/// If the set is uninitialised (`sp.ptr == NULL`), a new table is installed as
+/// the root directly.
+///
+/// The return value means:
+///   • 0 – a migration was started or the root was initialised
+///   • `EALREADY` – someone else is already migrating this set
+///   • `ENOMEM` – out of memory
+///
+/// @param set Set to operate on
+/// @param sp Reference to the current root of the set
+/// @param capacity Exponent + 1 of the number of slots in the new table
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_boxed_resize_(set_t_ *set, sp_t sp, size_t capacity);
+
+/// contribute to any in-progress migration of a set
+///
+/// If the table `sp` is being migrated, this claims and moves chunks of slots
+/// until there are none left, and then waits for any other migrators to finish
+/// theirs. The caller is expected to then re-acquire the root and retry its
+/// operation.
+///
+/// @param set Set to operate on
+/// @param sp Reference to the table to help migrate
+/// @param sig Signature of the set item type
+/// @return True if a migration was in progress
+PRIVATE bool set_boxed_help_(set_t_ *set, sp_t sp, set_sig_t_ sig);
@@ -0,0 +1,125 @@
+/// @file
+/// @brief Implementation of copying an item for insertion, for boxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_boxed.h"
+#include "slab.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+/// get the alignment of the slab blocks backing a set’s items
+///
+/// @param sig Signature of the set item type
+/// @return Block alignment in bytes
+static size_t block_alignment(set_sig_t_ sig) {
+  size_t alignment = alignof(sp_ctrl_t);
+
+  // We need ≥ 4 byte alignment (see ./set.h), so be explicit about this.
+  if (alignment < 4)
+    alignment = 4;
+
+  if (alignment < sig.alignment)
+    alignment = sig.alignment;
+
+  return alignment;
+}
+
+/// get the offset of an item from the start of its slab block
+///
+/// @param alignment Alignment of slab blocks
+/// @return Offset in bytes
+static size_t item_offset(size_t alignment) {
+  // place the item after the control block, padded to the block alignment
+  return (sizeof(sp_ctrl_t) + alignment - 1) / alignment * alignment;
+}
+
+/// run the optional user-supplied destructor on a set element
+///
+/// @param ptr Pointer to the element
+/// @param user_dtor Optional user-supplied destructor
+static void slot_dtor_core(void *ptr, void (*user_dtor)(void *)) {
+  assert(ptr != NULL);
+
+  if (user_dtor != NULL && ptr != NULL)
+    user_dtor(ptr);
+}
+
+/// deallocate a set element that is going out of scope
+///
+/// @param ptr Pointer to the element
+/// @param context The slab block containing the element
+static void slot_dtor(void *ptr, void *context) {
+  assert(ptr != NULL);
+  assert(context != NULL);
+
+  // the slab was created with the user-supplied destructor as its context
+  const slab_t *const slab = slab_owner(context);
+  void (*user_dtor)(void *) = slab->context;
+
+  slot_dtor_core(ptr, user_dtor);
+
+  // this also releases the element’s control block, which lives in the block
+  slab_free_(context);
+}
+
+/// get the slab for a set’s items, creating it if necessary
+///
+/// @param set Set table to operate on
+/// @param sig Signature of the set item type
+/// @return The slab or `NULL` on out of memory
+static slab_t *get_slab(set_impl_t *set, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  slab_t *slab = atomic_load_explicit(&set->slab, memory_order_acquire);
+  if (slab != NULL)
+    return slab;
+
+  const size_t alignment = block_alignment(sig);
+  if (sig.size > SIZE_MAX - item_offset(alignment))
+    return NULL;
+  const size_t size = item_offset(alignment) + sig.size;
+  slab_t *const s = slab_new_(size, alignment, (void *)sig.dtor);
+  if (s == NULL)
+    return NULL;
+
+  // install our slab, unless someone else beat us to it
+  if (!atomic_compare_exchange_strong_explicit(&set->slab, &slab, s,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire)) {
+    slab_release_(s);
+    return slab;
+  }
+
+  return s;
+}
+
+sp_t set_boxed_box_(set_impl_t *set, void *item, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  slab_t *const slab = get_slab(set, sig);
+  if (slab == NULL) {
+    slot_dtor_core(item, sig.dtor);
+    return (sp_t){0};
+  }
+
+  void *const block = slab_alloc_(slab);
+  if (block == NULL) {
+    slot_dtor_core(item, sig.dtor);
+    return (sp_t){0};
+  }
+
+  void *const item_copy = (char *)block + item_offset(block_alignment(sig));
+  if (sig.size > 0)
+    memcpy(item_copy, item, sig.size);
+
+  return sp_new_in_(block, item_copy, slot_dtor, block);
+}
@@ -0,0 +1,46 @@
+/// @file
+/// @brief Implementation of set iteration, for boxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_boxed.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+int set_boxed_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                       void *context, set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+  assert(callback != NULL);
+
+  // acquire a reference to the set, which keeps every item in it alive
+  sp_t sp = sp_acq(&set->root);
+
+  // if the set is uninitialised, it is semantically empty
+  if (sp.ptr == NULL)
+    return 0;
+
+  set_impl_t *const s = sp.ptr;
+
+  // Walk only the table we hold. If it is being migrated, slots that have been
+  // moved retain their items, so we still see everything that was present when
+  // the migration began.
+  int rc = 0;
+  for (size_t i = 0; i < set_capacity(s); ++i) {
+    const uintptr_t slot = half_slot_load(&s->base[i]);
+
+    // skip empty slots and tombstones
+    if (half_slot_is_free(slot) || half_slot_is_deleted(slot))
+      continue;
+
+    rc = callback(half_slot_to_ptr(slot), context);
+    if (rc != 0)
+      break;
+  }
+
+  sp_rel(sp);
+  return rc;
+}
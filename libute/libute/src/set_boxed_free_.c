@@ -3,6 +3,7 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "epoch.h"
 #include <assert.h>
 #include <stddef.h>
 #include <ute/asp.h>
@@ -11,7 +12,11 @@
 void set_boxed_free_(set_t_ *set) {
   assert(set != NULL);
 
-  // overwriting the root with a null pointer is enough to free the set
+  // overwriting the root with a null pointer is enough to release the set
   sp_t null = sp_new(0, NULL, NULL);
   sp_store(&set->root, null);
+
+  // its deallocation is deferred until no lookup can be reading it, so wait
+  // for this rather than leaving it outstanding after we return
+  epoch_synchronize_();
 }
@@ -0,0 +1,109 @@
+/// @file
+/// @brief Implementation of batched set insertion, for boxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "hash.h"
+#include "set_boxed.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_boxed_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                           set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+
+  unsigned char *const it = items;
+
+  // acquire a reference to the set, which we hold across the whole batch
+  // unless we need to move to a successor table
+  sp_t sp = sp_acq(&set->root);
+
+  backoff_t backoff = {0};
+  for (size_t base = 0; base < n; base += BATCH) {
+    const size_t m = n - base < BATCH ? n - base : BATCH;
+
+    // hash this block of items up front and start pulling in the slots they
+    // will be probed from
+    size_t hashes[BATCH];
+    for (size_t i = 0; i < m; ++i) {
+      const void *const item = it + (base + i) * sig.size;
+      hashes[i] = hash_item(sig.hash, item, sig.size);
+      if (sp.ptr != NULL)
+        probe_prefetch(sp.ptr, hashes[i]);
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+      void *const item = it + (base + i) * sig.size;
+
+      // the copy we will insert, made once we know which table’s slab to use
+      sp_t copy = {0};
+
+    retry:
+      // if someone is migrating the set, help them and then move to the
+      // successor
+      if (set_boxed_help_(set, sp, sig)) {
+        sp_rel(sp);
+        sp = sp_acq(&set->root);
+        backoff_(&backoff);
+        goto retry;
+      }
+
+      set_impl_t *const s = sp.ptr;
+
+      // do we need to expand or compact the backing storage?
+      if (set_is_full(s)) {
+        const size_t c = set_resize_capacity(s, false);
+        const int rc = set_boxed_resize_(set, sp, c);
+        sp_rel(sp);
+        if (rc == ENOMEM) {
+          if (copy.ptr != NULL) {
+            sp_rel(copy);
+          } else if (sig.dtor != NULL) {
+            sig.dtor(item);
+          }
+          // consume the items we will not get to
+          for (size_t j = base + i + 1; j < n && sig.dtor != NULL; ++j)
+            sig.dtor(it + j * sig.size);
+          return ENOMEM;
+        }
+        sp = sp_acq(&set->root);
+        goto retry;
+      }
+
+      // copy the item for insertion
+      if (copy.ptr == NULL) {
+        copy = set_boxed_box_(s, item, sig);
+        if (copy.ptr == NULL) {
+          sp_rel(sp);
+          // consume the items we will not get to
+          for (size_t j = base + i + 1; j < n && sig.dtor != NULL; ++j)
+            sig.dtor(it + j * sig.size);
+          return ENOMEM;
+        }
+      }
+
+      const int rc = set_boxed_put_(s, copy, hashes[i], sig);
+      if (rc != 0 && rc != EEXIST) {
+        // we raced with the start of a migration
+        sp_rel(sp);
+        sp = sp_acq(&set->root);
+        backoff_(&backoff);
+        goto retry;
+      }
+      if (rc == EEXIST)
+        sp_rel(copy);
+      if (exists != NULL)
+        exists[base + i] = rc == EEXIST;
+    }
+  }
+
+  sp_rel(sp);
+  return 0;
+}
@@ -0,0 +1,273 @@
+/// @file
+/// @brief Implementation of set expansion and migration, for boxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "epoch.h"
+#include "hash.h"
+#include "set_boxed.h"
+#include "slab.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/aligned_alloc.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/dword.h>
+#include <ute/set.h>
+
+/// `aligned_alloc` equivalent of `calloc`
+static void *aligned_calloc(size_t alignment, size_t n, size_t size) {
+  if (n > 0 && SIZE_MAX / n < size)
+    return NULL;
+  void *const p = ALIGNED_ALLOC(alignment, n * size);
+  if (p != NULL)
+    memset(p, 0, n * size);
+  return p;
+}
+
+/// deallocate a set that is going out of scope
+///
+/// @param set Set to operate on
+/// @param context Ignored
+static void set_dtor(void *set, void *context UNUSED) {
+  assert(set != NULL);
+
+  set_impl_t *const s = set;
+
+  // free our slots
+  for (size_t i = 0; i < set_capacity(s); ++i) {
+    const dword_t slot = slot_load(&s->base[i]);
+    sp_t sp = slot_decode(slot);
+    sp.ptr = slot_to_ptr(slot); // clear MIGRATED|DELETED
+    sp_rel(sp);
+  }
+
+  // drop our reference to the slab, after any items we released above have
+  // dropped theirs
+  slab_release_(atomic_load_explicit(&s->slab, memory_order_acquire));
+
+  ALIGNED_FREE(s->base);
+  ALIGNED_FREE(s);
+}
+
+/// retire a set whose last reference has been released
+///
+/// Lookups may still be reading the set, so its deallocation is deferred until
+/// they are done.
+///
+/// @param set Set to operate on
+/// @param context Passed on to the deallocator
+static void retire(void *set, void *context) {
+  assert(set != NULL);
+
+  set_impl_t *const s = set;
+
+  // Drop our reference to any successor we were migrated into. Lookups never
+  // follow this, so there is no need to wait. Doing it now means a successor
+  // that is itself unreferenced is retired alongside us, not only once we are
+  // deallocated.
+  sp_store(&s->next, (sp_t){0});
+
+  epoch_retire_(&s->retired, set_dtor, s, context);
+}
+
+sp_t set_boxed_new_(size_t capacity, slab_t *slab) {
+  assert(capacity > 0);
+
+  atomic_dword_t *const b = aligned_calloc(
+      alignof(atomic_dword_t), (size_t)1 << capacity >> 1, sizeof(b[0]));
+  if (b == NULL)
+    return (sp_t){0};
+
+  set_impl_t *const s = ALIGNED_ALLOC(alignof(set_impl_t), sizeof(*s));
+  if (s == NULL) {
+    ALIGNED_FREE(b);
+    return (sp_t){0};
+  }
+  *s = (set_impl_t){.base = b, .capacity = capacity};
+  if (slab != NULL) {
+    slab_retain(slab);
+    atomic_init(&s->slab, slab);
+  }
+
+  return sp_new_in_(&s->ctrl, s, retire, NULL);
+}
+
+int set_boxed_put_(set_impl_t *set, sp_t item, size_t h, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  backoff_t backoff = {0};
+  for (size_t i = 0; i < set_capacity(set); ++i) {
+    const size_t index = (h + i) % set_capacity(set);
+    dword_t slot = slot_load(&set->base[index]);
+  retry:
+
+    // has someone else begun a migration?
+    if (slot_is_moved(slot))
+      return ENOMEM;
+
+    // if this slot is unoccupied, try to insert our item
+    if (slot_is_free(slot)) {
+      if (!slot_cas(&set->base[index], &slot, slot_encode(item))) {
+        backoff_(&backoff);
+        goto retry;
+      }
+      set_add_used(set);
+      return 0;
+    }
+
+    // if this is a deleted item, skip over it
+    if (slot_is_deleted(slot))
+      continue;
+
+    // otherwise, check if this is our item already present
+    void *const p = slot_to_ptr(slot);
+    if (eq(p, item.ptr, sig))
+      return EEXIST;
+  }
+
+  return ENOMEM;
+}
+
+int set_boxed_resize_(set_t_ *set, sp_t sp, size_t capacity) {
+  assert(set != NULL);
+
+  set_impl_t *const s = sp.ptr;
+
+  // if the set is uninitialised, there is nothing to migrate and we can try to
+  // install a new table directly
+  if (s == NULL) {
+    sp_t new_sp = set_boxed_new_(capacity, NULL);
+    if (new_sp.ptr == NULL)
+      return ENOMEM;
+    if (!sp_cas(&set->root, sp, new_sp))
+      sp_rel(new_sp);
+    return 0;
+  }
+
+  // claim the right to allocate a successor, so that racing threads do not
+  // each allocate their own table that all but one of them would discard
+  int stage = LIVE;
+  if (!atomic_compare_exchange_strong_explicit(&s->stage, &stage, GROWING,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire))
+    return EALREADY;
+
+  // share our slab with the successor, so items allocated before and after the
+  // migration come from the same chunks
+  slab_t *const slab = atomic_load_explicit(&s->slab, memory_order_acquire);
+  sp_t new_sp = set_boxed_new_(capacity, slab);
+  if (new_sp.ptr == NULL) {
+    atomic_store_explicit(&s->stage, LIVE, memory_order_release);
+    return ENOMEM;
+  }
+
+  // publish the successor so others can begin moving slots into it
+  const bool r = sp_cas(&s->next, (sp_t){0}, new_sp);
+  assert(r && "successor published without claiming the right to grow");
+  if (!r)
+    sp_rel(new_sp);
+  atomic_store_explicit(&s->stage, MIGRATING, memory_order_release);
+
+  return 0;
+}
+
+/// move a range of slots from a set into its successor
+///
+/// @param dst Successor set
+/// @param src Set being migrated
+/// @param start Index of the first slot to move
+/// @param end Index one past the last slot to move
+/// @param sig Signature of the set item type
+static void migrate(set_impl_t *dst, set_impl_t *src, size_t start, size_t end,
+                    set_sig_t_ sig) {
+  assert(dst != NULL);
+  assert(src != NULL);
+  assert(start <= end);
+  assert(end <= set_capacity(src));
+
+  backoff_t backoff = {0};
+  for (size_t i = start; i < end; ++i) {
+    dword_t slot = slot_load(&src->base[i]);
+  retry:
+
+    // claiming a chunk gives us exclusive rights to migrate its slots
+    assert(!slot_is_moved(slot) && "another migrator moved our slot");
+
+    if (!slot_cas(&src->base[i], &slot, slot_moved(slot))) {
+      // an inserter or deleter beat us
+      backoff_(&backoff);
+      goto retry;
+    }
+
+    if (slot_is_free(slot) || slot_is_deleted(slot))
+      continue;
+
+    const sp_t item = slot_decode(slot);
+    const sp_t copy = sp_dup(item);
+    const size_t h = hash_item(sig.hash, copy.ptr, sig.size);
+    const int rc UNUSED = set_boxed_put_(dst, copy, h, sig);
+    assert(rc == 0 && "migration destination too small?");
+  }
+}
+
+bool set_boxed_help_(set_t_ *set, sp_t sp, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  set_impl_t *const s = sp.ptr;
+  if (s == NULL)
+    return false;
+
+  switch (atomic_load_explicit(&s->stage, memory_order_acquire)) {
+  case LIVE:
+    return false;
+  case GROWING:
+    // someone is allocating the successor; let our caller retry until it
+    // appears
+    return true;
+  }
+
+  sp_t next = sp_acq(&s->next);
+  set_impl_t *const n = next.ptr;
+  assert(n != NULL && "migrating set with no successor");
+
+  const size_t capacity = set_capacity(s);
+  while (true) {
+    const size_t start = atomic_fetch_add_explicit(
+        &s->claimed, MIGRATION_CHUNK, memory_order_acq_rel);
+    if (start >= capacity)
+      break;
+    const size_t end =
+        capacity - start < MIGRATION_CHUNK ? capacity : start + MIGRATION_CHUNK;
+
+    migrate(n, s, start, end, sig);
+
+    // if we moved the last slots, promote the successor to be the new root
+    const size_t done = atomic_fetch_add_explicit(&s->migrated, end - start,
+                                                  memory_order_acq_rel);
+    if (done + (end - start) == capacity) {
+      const bool r = sp_cas(&set->root, sp, next);
+      assert(r && "root changed during migration");
+      if (r)
+        next = (sp_t){0};
+      break;
+    }
+  }
+
+  // wait for any other migrators to finish their chunks, yielding if one of
+  // them has been descheduled mid-chunk
+  backoff_t backoff = {0};
+  while (atomic_load_explicit(&s->migrated, memory_order_acquire) < capacity)
+    backoff_(&backoff);
+
+  sp_rel(next);
+  return true;
+}
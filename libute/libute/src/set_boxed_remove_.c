@@ -3,6 +3,8 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
+#include "hash.h"
 #include "set_boxed.h"
 #include <assert.h>
 #include <stdatomic.h>
@@ -10,15 +12,15 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <ute/asp.h>
-#include <ute/hash.h>
 #include <ute/set.h>
 
 bool set_boxed_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
   assert(set != NULL);
   assert(item != NULL || sig.size == 0);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(item, sig.size);
+  const size_t h = hash_item(sig.hash, item, sig.size);
 
+  backoff_t backoff = {0};
 retry1:;
   // acquire a reference to the set
   sp_t sp = sp_acq(&set->root);
@@ -29,14 +31,16 @@ retry1:;
 
   set_impl_t *const s = sp.ptr;
 
-  for (size_t i = 0; i < set_capacity(*s); ++i) {
-    const size_t index = (h + i) % set_capacity(*s);
+  for (size_t i = 0; i < set_capacity(s); ++i) {
+    const size_t index = (h + i) % set_capacity(s);
     uintptr_t slot = half_slot_load(&s->base[index]);
 
   retry2:
     if (half_slot_is_moved(slot)) {
-      // someone is rehashing the set into new storage
+      // someone is rehashing the set into new storage, so help them
+      (void)set_boxed_help_(set, sp, sig);
       sp_rel(sp);
+      backoff_(&backoff);
       goto retry1;
     }
 
@@ -52,9 +56,18 @@ retry1:;
     const void *const p = half_slot_decode(slot);
     if (eq(item, p, sig)) {
       // mark as deleted
-      if (!half_slot_cas(&s->base[index], &slot, half_slot_deleted(slot)))
+      if (!half_slot_cas(&s->base[index], &slot, half_slot_deleted(slot))) {
+        backoff_(&backoff);
         goto retry2;
-      (void)atomic_fetch_add_explicit(&s->deleted, 1, memory_order_acq_rel);
+      }
+
+      // if tombstones are accumulating, rehash to reclaim them
+      if (set_add_deleted(s)) {
+        const size_t c = set_resize_capacity(s, true);
+        if (set_boxed_resize_(set, sp, c) == 0)
+          (void)set_boxed_help_(set, sp, sig);
+      }
+
       sp_rel(sp);
       return true;
     }
@@ -0,0 +1,57 @@
+/// @file
+/// @brief Implementation of set pre-sizing, for boxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "set_boxed.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_boxed_reserve_(set_t_ *set, size_t n, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  if (n > SIZE_MAX / 100)
+    return ENOMEM;
+
+  const size_t c = set_capacity_for(n);
+
+  backoff_t backoff = {0};
+retry:;
+
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // finish any migration that is already in progress
+  if (set_boxed_help_(set, sp, sig)) {
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry;
+  }
+
+  // is the backing storage already large enough?
+  const set_impl_t *const s = sp.ptr;
+  if (s != NULL && s->capacity >= c) {
+    sp_rel(sp);
+    return 0;
+  }
+
+  const int rc = set_boxed_resize_(set, sp, c);
+  if (rc == ENOMEM) {
+    sp_rel(sp);
+    return ENOMEM;
+  }
+
+  // move everything into the new table
+  if (rc == 0)
+    (void)set_boxed_help_(set, sp, sig);
+
+  sp_rel(sp);
+
+  // whether we or someone else replaced the root, check it again
+  goto retry;
+}
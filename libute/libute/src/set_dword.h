@@ -0,0 +1,323 @@
+/// @file
+/// @brief Double-word set internals
+///
+/// The set implemented below stores its elements inline in double-word set
+/// slots, alongside the slot’s state. It can handle items that are up to the
+/// size of `uintptr_t` and the same or weaker aligned. This covers word-sized
+/// items like pointers, that are too large for the unboxed set, without the
+/// per-item allocations of the boxed set.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "counter.h"
+#include "epoch.h"
+#include "hash.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/asp.h>
+#include <ute/dword.h>
+#include <ute/set.h>
+
+/// internal implementation of a set
+///
+/// A set data structure looks like:
+///
+///   set_t_      set_impl_t     slots
+///   ┌───────┐   ┌──────────┐   ┌──────┬──────┬──────┬──
+///   │ root¹ ├──►│   base   ├──►│ item │      │ item │ …
+///   │       │   ├──────────┤   ├──────┼──────┼──────┼──
+///   └───────┘   │  next¹   │   │state │state │state │ …
+///               ├──────────┤   └──────┴──────┴──────┴──
+///               │  stage   │
+///               ├──────────┤
+///               │ claimed  │
+///               ├──────────┤
+///               │ migrated │
+///               ├──────────┤
+///               │   full   │
+///               ├──────────┤
+///               │ capacity │
+///               ├──────────┤
+///               │  used²   │
+///               ├──────────┤
+///               │ deleted² │
+///               ├──────────┤
+///               │   ctrl   │
+///               ├──────────┤
+///               │ retired  │
+///               └──────────┘
+///
+/// `set_impl_t` carries no information about the size of set items. This is
+/// expected to be passed in by callers.
+///
+/// A slot’s item is written together with its state, in a single double-word
+/// compare-and-swap, and never changes thereafter. Later transitions only
+/// update the state word. So readers can check the state word and then read
+/// the item word separately, without needing a double-word load.
+///
+/// Growing the set follows the same cooperative protocol as the unboxed set
+/// (see ./set_unboxed.h).
+///
+/// Lookups read the set without acquiring a reference to it, from within an
+/// epoch guard (see ./epoch.h). So the set embeds the control block of its own
+/// shared pointer (`ctrl`), to keep it readable for as long as the set. When
+/// the last reference is released, the set is retired (`retired`) rather than
+/// deallocated immediately.
+///
+/// ¹ This is an atomic shared pointer, 2 words wide.
+/// ² These are striped counters (see ./counter.h), each stripe occupying its
+///   own cache line.
+typedef struct {
+  /// backing storage of set slots
+  ///
+  /// Each slot is two words. The lower word holds the item, zero-padded to
+  /// the size of a word. The upper word indicates the state of the slot:
+  ///
+  ///                   ┌─ sizeof(uintptr_t) * CHAR_BIT - 1
+  ///                   │                            2 1 0
+  ///                   ▼                            ▼ ▼ ▼
+  ///   base[i] state: ┌────────────────────────────┬─┬─┬─┐
+  ///                  └────────────────────────────┴─┴─┴─┘
+  ///                            (unused)            ▲ ▲ ▲
+  ///                                                │ │ │
+  ///                            has been migrated? ─┘ │ │
+  ///                               has been deleted? ─┘ │
+  ///                              contains an item? ────┘
+  atomic_dword_t *base;
+
+  asp_t next; ///< set being migrated into, if any
+
+  atomic_int stage;       ///< migration status (see below)
+  atomic_size_t claimed;  ///< how many slots have been claimed by migrators?
+  atomic_size_t migrated; ///< how many slots have been moved to `next`?
+
+  atomic_bool full; ///< has the set reached its load factor?
+  size_t capacity;  ///< exponent + 1 of how many total slots at `base`?
+
+  counter_t used;    ///< how many slots are non-empty?
+  counter_t deleted; ///< how many slots contain deleted items?
+
+  sp_ctrl_t ctrl;       ///< control block of the shared pointer to this set
+  epoch_node_t retired; ///< tracking for deferred deallocation
+} set_impl_t;
+
+/// values of `set_impl_t.stage`
+enum {
+  LIVE = 0,      ///< no migration has been started
+  GROWING = 1,   ///< a thread is allocating `next`
+  MIGRATING = 2, ///< `next` is published and slots are being moved to it
+};
+
+/// number of slots a migrator claims at once
+enum { MIGRATION_CHUNK = 64 };
+
+/// number of items hashed and prefetched ahead in batched operations
+enum { BATCH = 16 };
+
+// occupancy accounting, written in terms of the `set_impl_t` defined above
+#include "set_load.h"
+
+enum {
+  MIGRATED = (uintptr_t)4, ///< mask for migration bit (see above)
+  DELETED = (uintptr_t)2,  ///< mask for deletion bit (see above)
+  OCCUPIED = (uintptr_t)1, ///< mask for occupancy bit (see above)
+};
+
+/// atomically read the item word of a slot from a hash table
+static inline uintptr_t item_load(atomic_dword_t *slotptr) {
+  return dword_atomic_load_lo(slotptr);
+}
+
+/// atomically read the state word of a slot from a hash table
+static inline uintptr_t state_load(atomic_dword_t *slotptr) {
+  return dword_atomic_load_hi(slotptr);
+}
+
+/// atomically compare-and-swap into a hash table slot
+static inline bool slot_cas(atomic_dword_t *slotptr, dword_t *expected,
+                            dword_t desired) {
+  return dword_atomic_cas(slotptr, expected, desired);
+}
+
+/// atomically compare-and-swap into the state word of a hash table slot
+static inline bool state_cas(atomic_dword_t *slotptr, uintptr_t *expected,
+                             uintptr_t desired) {
+  return dword_atomic_cas_hi(slotptr, expected, desired);
+}
+
+/// serialise an item word and state word into a slot
+static inline dword_t slot_encode(uintptr_t item, uintptr_t state) {
+  const uintptr_t words[] = {item, state};
+  dword_t encoded;
+  assert(sizeof(encoded) == sizeof(words));
+  memcpy(&encoded, words, sizeof(encoded));
+  return encoded;
+}
+
+/// extract the state word from a slot
+static inline uintptr_t slot_state(dword_t slot) {
+  uintptr_t words[2];
+  assert(sizeof(words) == sizeof(slot));
+  memcpy(words, &slot, sizeof(words));
+  return words[1];
+}
+
+/// is this set slot unoccupied?
+static inline bool state_is_free(uintptr_t state) {
+  return (state & OCCUPIED) == 0;
+}
+
+/// does this set slot contain an item that was deleted?
+static inline bool state_is_deleted(uintptr_t state) {
+  return (state & DELETED) != 0;
+}
+
+/// derive the equivalent deleted representation of a slot state
+static inline uintptr_t state_deleted(uintptr_t state) {
+  assert(!state_is_deleted(state));
+  return state | DELETED;
+}
+
+/// has this slot been migrated to a new set?
+static inline bool state_is_moved(uintptr_t state) {
+  return (state & MIGRATED) != 0;
+}
+
+/// derive the equivalent moved representation of a slot state
+static inline uintptr_t state_moved(uintptr_t state) {
+  assert(!state_is_moved(state));
+  return state | MIGRATED;
+}
+
+/// convert an item to its representation within a slot
+static inline uintptr_t item_to_word(const void *item, set_sig_t_ sig) {
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= sizeof(uintptr_t));
+
+  uintptr_t word = 0;
+  if (sig.size > 0)
+    memcpy(&word, item, sig.size);
+  return word;
+}
+
+/// are two set items equal?
+static inline bool eq(uintptr_t a, uintptr_t b, set_sig_t_ sig) {
+  // items are zero-padded, so they can be compared as whole words
+  if (sig.eq != NULL)
+    return sig.eq(&a, &b, sig.size);
+  return a == b;
+}
+
+/// hash an item in its slot representation
+static inline size_t hash_word(uintptr_t item, set_sig_t_ sig) {
+  // the item occupies the leading bytes of the word
+  return hash_item(sig.hash, &item, sig.size);
+}
+
+/// prefetch the slot an item with the given hash will be probed from
+///
+/// @param set Set to be probed
+/// @param h Hash of the sought item
+static inline void probe_prefetch(const set_impl_t *set, size_t h) {
+  assert(set != NULL);
+
+#ifdef __GNUC__
+  __builtin_prefetch((const void *)&set->base[h & (set_capacity(set) - 1)]);
+#else
+  (void)h;
+#endif
+}
+
+/// find an item in a set table
+///
+/// @param set Set to search
+/// @param item Item to seek, in its slot representation
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return True if the item was found
+static inline bool lookup(set_impl_t *set, uintptr_t item, size_t h,
+                          set_sig_t_ sig) {
+  assert(set != NULL);
+
+  const size_t mask = set_capacity(set) - 1;
+  for (size_t i = 0; i < set_capacity(set); ++i) {
+    const size_t index = (h + i) & mask;
+    const uintptr_t state = state_load(&set->base[index]);
+
+    // skip checking whether this slot is moved or not, because we do not care
+    // if we are racing with a rehashing and reading an older stale copy of the
+    // table
+
+    // if we see an empty slot, we have probed as far as this item would be
+    if (state_is_free(state))
+      break;
+
+    // skip tombstones
+    if (state_is_deleted(state))
+      continue;
+
+    // check if this is the item we are seeking
+    if (eq(item, item_load(&set->base[index]), sig))
+      return true;
+  }
+
+  return false;
+}
+
+/// create a new, empty set
+///
+/// @param capacity Exponent + 1 of the number of slots to allocate
+/// @return A shared pointer to the set or `(sp_t){0}` on out of memory
+PRIVATE sp_t set_dword_new_(size_t capacity);
+
+/// insert an item into a set table
+///
+/// The return value means:
+///   • 0 – the item was inserted
+///   • `EEXIST` – the item was already present
+///   • `ENOMEM` – not enough space to insert the item or a migration has begun
+///
+/// @param set Set to operate on
+/// @param item Item to insert, in its slot representation
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_dword_put_(set_impl_t *set, uintptr_t item, size_t h,
+                           set_sig_t_ sig);
+
+/// begin migrating a set into a new table
+///
+/// If the set is uninitialised (`sp.ptr == NULL`), a new table is installed as
+/// the root directly.
+///
+/// The return value means:
+///   • 0 – a migration was started or the root was initialised
+///   • `EALREADY` – someone else is already migrating this set
+///   • `ENOMEM` – out of memory
+///
+/// @param set Set to operate on
+/// @param sp Reference to the current root of the set
+/// @param capacity Exponent + 1 of the number of slots in the new table
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_dword_resize_(set_t_ *set, sp_t sp, size_t capacity);
+
+/// contribute to any in-progress migration of a set
+///
+/// If the table `sp` is being migrated, this claims and moves chunks of slots
+/// until there are none left, and then waits for any other migrators to finish
+/// theirs. The caller is expected to then re-acquire the root and retry its
+/// operation.
+///
+/// @param set Set to operate on
+/// @param sp Reference to the table to help migrate
+/// @param sig Signature of the set item type
+/// @return True if a migration was in progress
+PRIVATE bool set_dword_help_(set_t_ *set, sp_t sp, set_sig_t_ sig);
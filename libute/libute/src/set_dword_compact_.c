@@ -0,0 +1,61 @@
+/// @file
+/// @brief Implementation of set compaction, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "set_dword.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_dword_compact_(set_t_ *set, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  backoff_t backoff = {0};
+retry:;
+
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // an uninitialised set has nothing to compact
+  if (sp.ptr == NULL)
+    return 0;
+
+  // finish any migration that is already in progress
+  if (set_dword_help_(set, sp, sig)) {
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry;
+  }
+
+  set_impl_t *const s = sp.ptr;
+
+  // if there are no tombstones and we would not shrink, there is nothing to do
+  const size_t c = set_resize_capacity(s, true);
+  if (counter_read(&s->deleted) == 0 && c >= s->capacity) {
+    sp_rel(sp);
+    return 0;
+  }
+
+  const int rc = set_dword_resize_(set, sp, c);
+  if (rc == EALREADY) {
+    // someone else started a migration in the meantime
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry;
+  }
+  if (rc != 0) {
+    sp_rel(sp);
+    return rc;
+  }
+
+  // move everything into the new table
+  (void)set_dword_help_(set, sp, sig);
+
+  sp_rel(sp);
+  return 0;
+}
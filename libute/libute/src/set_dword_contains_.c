@@ -0,0 +1,33 @@
+/// @file
+/// @brief Implementation of set existence check, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hash.h"
+#include "set_dword.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/epoch.h>
+#include <ute/set.h>
+
+bool set_dword_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  const size_t h = hash_item(sig.hash, item, sig.size);
+
+  // guard the set against being deallocated while we read it
+  epoch_enter();
+  set_impl_t *const s = sp_peek_(&set->root);
+
+  // if the set is uninitialised, it is semantically empty
+  const bool found = s != NULL && lookup(s, item_to_word(item, sig), h, sig);
+
+  epoch_exit();
+  return found;
+}
@@ -0,0 +1,22 @@
+/// @file
+/// @brief Implementation of set destruction, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "epoch.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+void set_dword_free_(set_t_ *set) {
+  assert(set != NULL);
+
+  // overwriting the root with a null pointer is enough to release the set
+  sp_t null = sp_new(0, NULL, NULL);
+  sp_store(&set->root, null);
+
+  // its deallocation is deferred until no lookup can be reading it, so wait
+  // for this rather than leaving it outstanding after we return
+  epoch_synchronize_();
+}
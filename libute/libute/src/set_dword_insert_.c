@@ -0,0 +1,67 @@
+/// @file
+/// @brief Implementation of set insertion, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "hash.h"
+#include "set_dword.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_dword_insert_(set_t_ *set, void *item, bool *exists, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= sizeof(uintptr_t));
+  assert(sig.alignment <= alignof(uintptr_t));
+  assert(sig.dtor == NULL);
+
+  const uintptr_t word = item_to_word(item, sig);
+  const size_t h = hash_item(sig.hash, item, sig.size);
+
+  backoff_t backoff = {0};
+retry:;
+
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // if someone is migrating the set, help them before retrying
+  if (set_dword_help_(set, sp, sig)) {
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry;
+  }
+
+  set_impl_t *const s = sp.ptr;
+
+  // do we need to expand or compact the backing storage?
+  if (set_is_full(s)) {
+    const size_t c = set_resize_capacity(s, false);
+    const int rc = set_dword_resize_(set, sp, c);
+    sp_rel(sp);
+    if (rc == ENOMEM)
+      return ENOMEM;
+    goto retry;
+  }
+
+  // insert the new item
+  {
+    const int rc = set_dword_put_(s, word, h, sig);
+    sp_rel(sp);
+    if (rc != 0) {
+      if (rc != EEXIST) {
+        backoff_(&backoff);
+        goto retry;
+      }
+    }
+    if (exists != NULL)
+      *exists = rc == EEXIST;
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+/// @file
+/// @brief Implementation of set removal, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "hash.h"
+#include "set_dword.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+bool set_dword_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= sizeof(uintptr_t));
+  assert(sig.alignment <= alignof(uintptr_t));
+  assert(sig.dtor == NULL);
+
+  const uintptr_t word = item_to_word(item, sig);
+  const size_t h = hash_item(sig.hash, item, sig.size);
+
+  backoff_t backoff = {0};
+retry1:;
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // if the set is uninitialised, it is semantically empty
+  if (sp.ptr == NULL)
+    return false;
+
+  set_impl_t *const s = sp.ptr;
+
+  const size_t mask = set_capacity(s) - 1;
+  for (size_t i = 0; i < set_capacity(s); ++i) {
+    const size_t index = (h + i) & mask;
+    uintptr_t state = state_load(&s->base[index]);
+
+  retry2:
+    if (state_is_moved(state)) {
+      // someone is rehashing the set into new storage, so help them
+      (void)set_dword_help_(set, sp, sig);
+      sp_rel(sp);
+      backoff_(&backoff);
+      goto retry1;
+    }
+
+    // if this slot is unoccupied, we have probed as far as the item could be
+    if (state_is_free(state))
+      break;
+
+    // skip tombstones
+    if (state_is_deleted(state))
+      continue;
+
+    // is this our sought item?
+    if (eq(word, item_load(&s->base[index]), sig)) {
+      // mark as deleted
+      if (!state_cas(&s->base[index], &state, state_deleted(state))) {
+        backoff_(&backoff);
+        goto retry2;
+      }
+
+      // if tombstones are accumulating, rehash to reclaim them
+      if (set_add_deleted(s)) {
+        const size_t c = set_resize_capacity(s, true);
+        if (set_dword_resize_(set, sp, c) == 0)
+          (void)set_dword_help_(set, sp, sig);
+      }
+
+      sp_rel(sp);
+      return true;
+    }
+  }
+
+  sp_rel(sp);
+  return false;
+}
@@ -0,0 +1,29 @@
+/// @file
+/// @brief Implementation of set size, for double-word set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_dword.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+size_t set_dword_size_(set_t_ *set, set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // an uninitialised set is semantically empty
+  if (sp.ptr == NULL)
+    return 0;
+
+  set_impl_t *const s = sp.ptr;
+  const size_t size = set_live(s);
+
+  sp_rel(sp);
+
+  return size;
+}
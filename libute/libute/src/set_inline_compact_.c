@@ -0,0 +1,16 @@
+/// @file
+/// @brief Implementation of set compaction, for inline set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+int set_inline_compact_(set_t_ *set UNUSED, set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+
+  // this implementation has no tombstones, so there is nothing to reclaim
+  return 0;
+}
@@ -0,0 +1,29 @@
+/// @file
+/// @brief Implementation of batched set existence check, for inline set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+size_t set_inline_contains_many_(set_t_ *set, const void *items, size_t n,
+                                 bool *found, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.count <= sizeof(set->raw) * CHAR_BIT);
+
+  // the inline set involves no shared pointer, so there is nothing to amortise
+  const unsigned char *const it = items;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const bool f = set_inline_contains_(set, it + i * sig.size, sig);
+    if (found != NULL)
+      found[i] = f;
+    count += f;
+  }
+
+  return count;
+}
@@ -0,0 +1,36 @@
+/// @file
+/// @brief Implementation of set iteration, for inline set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_inline.h"
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+int set_inline_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                        void *context, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(callback != NULL);
+  assert(sig.count <= sizeof(set->raw) * CHAR_BIT);
+  (void)sig;
+
+  for (size_t i = 0; i < sizeof(set->raw) / sizeof(set->raw[0]); ++i) {
+    uintptr_t word = word_load(&set->raw[i]);
+    while (word != 0) {
+      const size_t bit = (size_t)__builtin_ctzll(word);
+      word &= word - 1;
+
+      // the value this bit represents is also the representation of its item
+      const uintptr_t value = i * WORD_SIZE + bit;
+
+      const int rc = callback(&value, context);
+      if (rc != 0)
+        return rc;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,28 @@
+/// @file
+/// @brief Implementation of batched set insertion, for inline set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+int set_inline_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                            set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.count <= sizeof(set->raw) * CHAR_BIT);
+
+  // the inline set involves no shared pointer, so there is nothing to amortise
+  unsigned char *const it = items;
+  for (size_t i = 0; i < n; ++i) {
+    bool *const e = exists == NULL ? NULL : &exists[i];
+    const int rc = set_inline_insert_(set, it + i * sig.size, e, sig);
+    if (rc != 0)
+      return rc;
+  }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/// @file
+/// @brief Occupancy accounting and sizing shared by the hash table sets
+///
+/// The unboxed, double-word and boxed sets lay out their slots differently,
+/// but track how full their backing storage is and choose the size of the
+/// storage they migrate into in the same way. Each of their headers includes
+/// this one after defining its own `set_impl_t`, which must have `full`,
+/// `capacity`, `used` and `deleted` members as described there. A translation
+/// unit can therefore only use one of these set implementations.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "counter.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// get the capacity (in slots) of a set
+static inline size_t set_capacity(const set_impl_t *set) {
+  return (size_t)1 << set->capacity >> 1;
+}
+
+/// percentage occupancy at which we expand the backing storage
+enum { LOAD_FACTOR = 70 };
+
+/// does a set need to be expanded before inserting into it?
+///
+/// @param set Set to inspect, or `NULL` for an uninitialised set
+/// @return True if the set is at or above its load factor
+static inline bool set_is_full(set_impl_t *set) {
+  if (set == NULL)
+    return true;
+  return atomic_load_explicit(&set->full, memory_order_acquire);
+}
+
+/// account for an item having been written into a previously empty slot
+///
+/// This is where a set notices it has reached its load factor.
+///
+/// @param set Set that was inserted into
+static inline void set_add_used(set_impl_t *set) {
+  assert(set != NULL);
+
+  const size_t limit = set_capacity(set) * LOAD_FACTOR / 100;
+  const size_t stripe = counter_add(&set->used, 1);
+  if (!counter_should_check(stripe, limit))
+    return;
+
+  const size_t used = counter_read(&set->used);
+  if (used * 100 >= set_capacity(set) * LOAD_FACTOR)
+    atomic_store_explicit(&set->full, true, memory_order_release);
+}
+
+/// percentage of slots holding tombstones at which we compact the set
+enum { TOMBSTONE_FACTOR = 35 };
+
+/// minimum capacity (exponent + 1) a set will be shrunk to
+///
+/// Migrating into a smaller table relies on it having room for any insertions
+/// that were already in flight when the migration began. Keeping a floor under
+/// the size of shrunk tables ensures there is ample space for these.
+enum { SHRINK_FLOOR = 9 };
+
+/// get the number of non-deleted items in a set
+static inline size_t set_live(set_impl_t *set) {
+  assert(set != NULL);
+
+  // read deletions first, so we never see a deletion whose insertion we missed
+  const size_t deleted = counter_read(&set->deleted);
+  const size_t used = counter_read(&set->used);
+
+  // in the case of racing insertions and deletes, we can see an inconsistent
+  // state
+  if (used < deleted)
+    return 0;
+
+  return used - deleted;
+}
+
+/// account for an item having been deleted
+///
+/// @param set Set that was removed from
+/// @return True if the set now contains enough tombstones that it is worth
+///   compacting
+static inline bool set_add_deleted(set_impl_t *set) {
+  assert(set != NULL);
+
+  const size_t limit = set_capacity(set) * TOMBSTONE_FACTOR / 100;
+  const size_t stripe = counter_add(&set->deleted, 1);
+  if (!counter_should_check(stripe, limit))
+    return false;
+
+  const size_t deleted = counter_read(&set->deleted);
+  return deleted * 100 >= set_capacity(set) * TOMBSTONE_FACTOR;
+}
+
+/// get the capacity of the smallest set that holds `n` items without reaching
+/// its load factor
+///
+/// @param n Number of items, at most `SIZE_MAX / 100`
+/// @return Exponent + 1 of the number of slots needed
+static inline size_t set_capacity_for(size_t n) {
+  assert(n <= SIZE_MAX / 100);
+
+  size_t c = 1;
+  while (c < sizeof(size_t) * CHAR_BIT &&
+         ((size_t)1 << c >> 1) * LOAD_FACTOR <= n * 100)
+    ++c;
+  return c;
+}
+
+/// choose the capacity of the table a set should next be migrated into
+///
+/// A set that is being grown because it reached its load factor is migrated
+/// into the smallest table that holds its non-deleted items below the load
+/// factor, doubling its capacity. A set that is being compacted, either
+/// because tombstones have accumulated or because they are the reason it
+/// reached its load factor, is migrated into a table its non-deleted items
+/// fill at most half of the load factor. This may be smaller, the same as or
+/// larger than the set’s current capacity. Tombstones are not carried across
+/// a migration, so this is how deleted slots are reclaimed.
+///
+/// @param set Set to inspect, or `NULL` for an uninitialised set
+/// @param compact Is this migration to reclaim tombstones, rather than to grow?
+/// @return Exponent + 1 of the number of slots for the new table
+static inline size_t set_resize_capacity(set_impl_t *set, bool compact) {
+  if (set == NULL)
+    return 1;
+
+  const size_t live = set_live(set);
+
+  // if the non-deleted items alone have outgrown the set, grow it
+  if (!compact) {
+    const size_t c = set_capacity_for(live);
+    if (c > set->capacity)
+      return c;
+  }
+
+  size_t c = set_capacity_for(live * 2);
+
+  // if this would shrink the set, do not go below the floor
+  if (c < set->capacity) {
+    if (c < SHRINK_FLOOR)
+      c = SHRINK_FLOOR;
+    if (c > set->capacity)
+      c = set->capacity;
+  }
+
+  return c;
+}
+
@@ -0,0 +1,43 @@
+/// @file
+/// @brief Thread-local bitset-backed set internals
+///
+/// This is the `SET_LOCAL` counterpart of the bitset-backed set. It stores the
+/// presence of its elements as a bitset array, reached through a plain owning
+/// pointer and accessed with plain loads and stores.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/set.h>
+
+enum { WORD_SIZE = sizeof(uintptr_t) * CHAR_BIT };
+
+/// get the number of words in the bitset of a set
+///
+/// @param sig Signature of the set item type
+/// @return Number of `uintptr_t`s needed to hold one bit per value of the type
+static inline size_t bitset_words(set_sig_t_ sig) {
+  assert(sig.size <= 2);
+  const size_t bits = (size_t)1 << (sig.size * CHAR_BIT);
+  return bits / WORD_SIZE + (bits % WORD_SIZE == 0 ? 0 : 1);
+}
+
+/// materialise the value of an item
+///
+/// @param item Item to read
+/// @param sig Signature of the set item type
+/// @return The item’s representation, which is also its index in the bitset
+static inline uintptr_t bitset_value(const void *item, set_sig_t_ sig) {
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= 2);
+  uintptr_t value = 0;
+  if (sig.size > 0)
+    memcpy(&value, item, sig.size);
+  return value;
+}
@@ -0,0 +1,39 @@
+/// @file
+/// @brief Implementation of batched set existence check, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+size_t set_local_bitset_contains_many_(set_t_ *set, const void *items, size_t n,
+                                       bool *found, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  const unsigned char *const it = items;
+  const uintptr_t *const s = set->local;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+
+    // if the bitset is not yet allocated, the set is empty
+    bool f = false;
+    if (s != NULL) {
+      const uintptr_t value = bitset_value(it + i * sig.size, sig);
+      const uintptr_t mask = (uintptr_t)1 << (value % WORD_SIZE);
+      f = (s[value / WORD_SIZE] & mask) != 0;
+    }
+
+    if (found != NULL)
+      found[i] = f;
+    count += f;
+  }
+
+  return count;
+}
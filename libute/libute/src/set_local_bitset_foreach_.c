@@ -0,0 +1,40 @@
+/// @file
+/// @brief Implementation of set iteration, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+int set_local_bitset_foreach_(set_t_ *set,
+                              int (*callback)(const void *, void *),
+                              void *context, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(callback != NULL);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  // if the bitset has not yet been allocated, the set is empty
+  if (set->local == NULL)
+    return 0;
+
+  const uintptr_t *const s = set->local;
+  int rc = 0;
+  for (size_t i = 0; i < bitset_words(sig) && rc == 0; ++i) {
+    uintptr_t word = s[i];
+    while (word != 0 && rc == 0) {
+      const size_t bit = (size_t)__builtin_ctzll(word);
+      word &= word - 1;
+
+      // the value this bit represents is also the representation of its item
+      const uintptr_t value = i * WORD_SIZE + bit;
+
+      rc = callback(&value, context);
+    }
+  }
+
+  return rc;
+}
@@ -0,0 +1,16 @@
+/// @file
+/// @brief Implementation of set destruction, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/set.h>
+
+void set_local_bitset_free_(set_t_ *set) {
+  assert(set != NULL);
+
+  free(set->local);
+  set->local = NULL;
+}
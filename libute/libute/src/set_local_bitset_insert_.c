@@ -0,0 +1,39 @@
+/// @file
+/// @brief Implementation of set insertion, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ute/set.h>
+
+int set_local_bitset_insert_(set_t_ *set, void *item, bool *exists,
+                             set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  // do we need to allocate the bitset?
+  if (set->local == NULL) {
+    set->local = calloc(bitset_words(sig), sizeof(uintptr_t));
+    if (set->local == NULL)
+      return ENOMEM;
+  }
+
+  const uintptr_t value = bitset_value(item, sig);
+  uintptr_t *const s = set->local;
+  const uintptr_t mask = (uintptr_t)1 << (value % WORD_SIZE);
+  const uintptr_t old = s[value / WORD_SIZE];
+  s[value / WORD_SIZE] = old | mask;
+
+  if (exists != NULL)
+    *exists = (old & mask) != 0;
+
+  return 0;
+}
@@ -0,0 +1,45 @@
+/// @file
+/// @brief Implementation of batched set insertion, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ute/set.h>
+
+int set_local_bitset_insert_many_(set_t_ *set, void *items, size_t n,
+                                  bool *exists, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  if (n == 0)
+    return 0;
+
+  // do we need to allocate the bitset?
+  if (set->local == NULL) {
+    set->local = calloc(bitset_words(sig), sizeof(uintptr_t));
+    if (set->local == NULL)
+      return ENOMEM;
+  }
+
+  const unsigned char *const it = items;
+  uintptr_t *const s = set->local;
+  for (size_t i = 0; i < n; ++i) {
+    const uintptr_t value = bitset_value(it + i * sig.size, sig);
+    const uintptr_t mask = (uintptr_t)1 << (value % WORD_SIZE);
+    const uintptr_t old = s[value / WORD_SIZE];
+    s[value / WORD_SIZE] = old | mask;
+
+    if (exists != NULL)
+      exists[i] = (old & mask) != 0;
+  }
+
+  return 0;
+}
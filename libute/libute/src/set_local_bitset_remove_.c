@@ -0,0 +1,30 @@
+/// @file
+/// @brief Implementation of set removal, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+bool set_local_bitset_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  // if the bitset is not yet allocated, the set is empty
+  if (set->local == NULL)
+    return false;
+
+  const uintptr_t value = bitset_value(item, sig);
+  uintptr_t *const s = set->local;
+  const uintptr_t mask = (uintptr_t)1 << (value % WORD_SIZE);
+  const uintptr_t old = s[value / WORD_SIZE];
+  s[value / WORD_SIZE] = old & ~mask;
+
+  return (old & mask) != 0;
+}
@@ -0,0 +1,28 @@
+/// @file
+/// @brief Implementation of set size, for local bitset set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_local_bitset.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+size_t set_local_bitset_size_(set_t_ *set, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(sig.size <= 2);
+  assert(sig.dtor == NULL);
+
+  // if the bitset has not yet been allocated, the set is empty
+  if (set->local == NULL)
+    return 0;
+
+  // count set bits
+  const uintptr_t *const s = set->local;
+  size_t size = 0;
+  for (size_t i = 0; i < bitset_words(sig); ++i)
+    size += __builtin_popcountll(s[i]);
+
+  return size;
+}
@@ -0,0 +1,30 @@
+/// @file
+/// @brief Implementation of set compaction, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+int set_local_table_compact_(set_t_ *set, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  // an uninitialised set has nothing to compact
+  local_table_t *t = set->local;
+  if (t == NULL)
+    return 0;
+
+  // if there are no tombstones and we would not shrink, there is nothing to do
+  const size_t slots = local_slots_for(t->size * 2);
+  if (t->used == t->size && slots >= local_slots(t))
+    return 0;
+
+  const int rc = local_table_resize_(&t, slots, local_set_layout(sig));
+  if (rc != 0)
+    return rc;
+  set->local = t;
+
+  return 0;
+}
@@ -0,0 +1,21 @@
+/// @file
+/// @brief Implementation of set existence check, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+bool set_local_table_contains_(set_t_ *set, const void *item,
+                               set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  const local_layout_t layout = local_set_layout(sig);
+  const size_t h = local_hash(item, layout);
+  return local_find(set->local, item, h, layout) != SIZE_MAX;
+}
@@ -0,0 +1,34 @@
+/// @file
+/// @brief Implementation of batched set existence check, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+size_t set_local_table_contains_many_(set_t_ *set, const void *items, size_t n,
+                                      bool *found, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+
+  const local_layout_t layout = local_set_layout(sig);
+  const local_table_t *const t = set->local;
+
+  const unsigned char *const it = items;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const void *const item = it + i * sig.size;
+    const size_t h = local_hash(item, layout);
+    const bool f = local_find(t, item, h, layout) != SIZE_MAX;
+
+    if (found != NULL)
+      found[i] = f;
+    count += f;
+  }
+
+  return count;
+}
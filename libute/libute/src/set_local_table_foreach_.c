@@ -0,0 +1,33 @@
+/// @file
+/// @brief Implementation of set iteration, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+int set_local_table_foreach_(set_t_ *set,
+                             int (*callback)(const void *, void *),
+                             void *context, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(callback != NULL);
+
+  const local_layout_t layout = local_set_layout(sig);
+  const local_table_t *const t = set->local;
+
+  // if the table has not yet been allocated, the set is empty
+  if (t == NULL)
+    return 0;
+
+  for (size_t i = 0; i < local_slots(t); ++i) {
+    if (!local_is_full_slot(t, i))
+      continue;
+    const int rc = callback(local_entry(t, i, layout), context);
+    if (rc != 0)
+      return rc;
+  }
+
+  return 0;
+}
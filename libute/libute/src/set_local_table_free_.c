@@ -0,0 +1,17 @@
+/// @file
+/// @brief Implementation of set destruction, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+void set_local_table_free_(set_t_ *set) {
+  assert(set != NULL);
+
+  // the table remembers the item destructor, so we do not need the signature
+  local_table_destroy(set->local);
+  set->local = NULL;
+}
@@ -0,0 +1,49 @@
+/// @file
+/// @brief Implementation of set insertion, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ute/set.h>
+
+int set_local_table_insert_(set_t_ *set, void *item, bool *exists,
+                            set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  const local_layout_t layout = local_set_layout(sig);
+  local_table_t *t = set->local;
+
+  {
+    const int rc = local_make_room(&t, layout);
+    if (rc != 0) {
+      if (sig.dtor != NULL)
+        sig.dtor(item);
+      return rc;
+    }
+    set->local = t;
+  }
+
+  const size_t h = local_hash(item, layout);
+  bool found;
+  const size_t index = local_probe(t, item, h, layout, &found);
+
+  if (found) {
+    // the item is consumed even though it is not inserted
+    if (sig.dtor != NULL)
+      sig.dtor(item);
+  } else {
+    if (sig.size > 0)
+      memcpy(local_entry(t, index, layout), item, sig.size);
+    local_occupy(t, index, h);
+  }
+
+  if (exists != NULL)
+    *exists = found;
+
+  return 0;
+}
@@ -0,0 +1,30 @@
+/// @file
+/// @brief Implementation of batched set insertion, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+int set_local_table_insert_many_(set_t_ *set, void *items, size_t n,
+                                 bool *exists, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+
+  // without any synchronisation to amortise, a batch is just a loop
+  unsigned char *const it = items;
+  for (size_t i = 0; i < n; ++i) {
+    bool *const e = exists == NULL ? NULL : &exists[i];
+    const int rc = set_local_table_insert_(set, it + i * sig.size, e, sig);
+    if (rc != 0) {
+      // consume the items we will not get to
+      for (size_t j = i + 1; j < n && sig.dtor != NULL; ++j)
+        sig.dtor(it + j * sig.size);
+      return rc;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,30 @@
+/// @file
+/// @brief Implementation of set removal, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+bool set_local_table_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(item != NULL || sig.size == 0);
+
+  const local_layout_t layout = local_set_layout(sig);
+  local_table_t *const t = set->local;
+
+  const size_t h = local_hash(item, layout);
+  const size_t index = local_find(t, item, h, layout);
+  if (index == SIZE_MAX)
+    return false;
+
+  if (sig.dtor != NULL)
+    sig.dtor(local_entry(t, index, layout));
+  local_vacate(t, index);
+
+  return true;
+}
@@ -0,0 +1,31 @@
+/// @file
+/// @brief Implementation of set pre-sizing, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+int set_local_table_reserve_(set_t_ *set, size_t n, set_sig_t_ sig) {
+  assert(set != NULL);
+
+  if (n > SIZE_MAX / 100)
+    return ENOMEM;
+
+  // is the backing storage already large enough?
+  const size_t slots = local_slots_for(n);
+  local_table_t *t = set->local;
+  if (t != NULL && local_slots(t) >= slots)
+    return 0;
+
+  const int rc = local_table_resize_(&t, slots, local_set_layout(sig));
+  if (rc != 0)
+    return rc;
+  set->local = t;
+
+  return 0;
+}
@@ -0,0 +1,17 @@
+/// @file
+/// @brief Implementation of set size, for local table set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "local_table.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+size_t set_local_table_size_(set_t_ *set, set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+
+  const local_table_t *const t = set->local;
+  return t == NULL ? 0 : t->size;
+}
@@ -9,6 +9,10 @@
 
 #pragma once
 
+#include "attr.h"
+#include "counter.h"
+#include "epoch.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <limits.h>
 #include <stdatomic.h>
@@ -16,8 +20,36 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <ute/asp.h>
 #include <ute/set.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifndef __has_include
+#define __has_include(x) 0
+#endif
+
+#ifndef __has_feature
+#define __has_feature(x) 0
+#endif
+
+#ifdef __x86_64__
+#if __has_include(<immintrin.h>)
+#include <immintrin.h>
+
+// TSan does not understand a vector load of the tags as racing benignly with
+// their atomic stores. Clang signals TSan via `__has_feature`, GCC via
+// `__SANITIZE_THREAD__`.
+#ifdef __SSE2__
+#if !__has_feature(thread_sanitizer) && !defined(__SANITIZE_THREAD__)
+#define USE_SSE2
+#endif
+#endif
+#endif
+#endif
+
 /// a set slot (see below)
 #ifdef _MSC_VER
 typedef uintptr_t slot_t;
@@ -33,17 +65,55 @@ typedef uintptr_t __attribute__((may_alias)) slot_t;
 ///   ┌───────┐   ┌──────────┐   ┌──────┬──────┬──────┬──
 ///   │ root¹ ├──►│   base   ├──►│ item │      │ item │ …
 ///   │       │   ├──────────┤   └──────┴──────┴──────┴──
-///   └───────┘   │   used   │
+///   └───────┘   │   tags   ├──►┌──────┬──────┬──────┬──
+///               ├──────────┤   │ tag  │  0   │ tag  │ …
+///               │  next¹   ├─┐ └──────┴──────┴──────┴──
+///               ├──────────┤ └► successor set_impl_t, while migrating
+///               ├──────────┤
+///               │  stage   │
+///               ├──────────┤
+///               │ claimed  │
 ///               ├──────────┤
-///               │ deleted  │
+///               │ migrated │
+///               ├──────────┤
+///               │   full   │
 ///               ├──────────┤
 ///               │ capacity │
+///               ├──────────┤
+///               │  used²   │
+///               ├──────────┤
+///               │ deleted² │
+///               ├──────────┤
+///               │   ctrl   │
+///               ├──────────┤
+///               │ retired  │
 ///               └──────────┘
 ///
 /// `set_impl_t` carries no information about the size of set items. This is
 /// expected to be passed in by callers.
 ///
+/// Each slot has a corresponding 1-byte tag, derived from the hash of its item.
+/// Lookups compare a whole group of tags at once and only read the slots whose
+/// tag matches or has not yet been written. The slots remain the source of
+/// truth; the tags are only a hint for skipping slots that cannot contain the
+/// sought item.
+///
+/// Growing the set is a cooperative process. The first thread to notice the
+/// set needs more space claims the right to allocate a successor (`stage`) and
+/// publishes it (`next`). From then on, any thread that encounters the set
+/// claims a chunk of slots (`claimed`), moves them into the successor and
+/// accounts for them (`migrated`). Whichever thread completes the final chunk
+/// promotes the successor to be the new root.
+///
+/// Lookups read the set without acquiring a reference to it, from within an
+/// epoch guard (see ./epoch.h). So the set embeds the control block of its own
+/// shared pointer (`ctrl`), to keep it readable for as long as the set. When
+/// the last reference is released, the set is retired (`retired`) rather than
+/// deallocated immediately.
+///
 /// ¹ This is an atomic shared pointer, 2 words wide.
+/// ² These are striped counters (see ./counter.h), each stripe occupying its
+///   own cache line.
 typedef struct {
   /// backing storage of set slots
   ///
@@ -64,15 +134,48 @@ typedef struct {
   ///    └── has been deleted?
   _Atomic slot_t *base;
 
-  atomic_size_t used;    ///< how many slots are non-empty?
-  atomic_size_t deleted; ///< how many slots contain deleted items?
-  size_t capacity;       ///< exponent + 1 of how many total slots at `base`?
+  /// hash tags of set slots
+  ///
+  /// A tag is 0 until the item in its slot has been written, after which it
+  /// holds the top 7 bits of the item’s hash with the high bit set. Tags never
+  /// change again once written because slots are never reused. There are at
+  /// least `GROUP` tags, with any beyond the set’s capacity remaining 0.
+  _Atomic uint8_t *tags;
+
+  asp_t next; ///< set being migrated into, if any
+
+  atomic_int stage;       ///< migration status (see below)
+  atomic_size_t claimed;  ///< how many slots have been claimed by migrators?
+  atomic_size_t migrated; ///< how many slots have been moved to `next`?
+
+  atomic_bool full; ///< has the set reached its load factor?
+  size_t capacity;  ///< exponent + 1 of how many total slots at `base`?
+
+  counter_t used;    ///< how many slots are non-empty?
+  counter_t deleted; ///< how many slots contain deleted items?
+
+  sp_ctrl_t ctrl;       ///< control block of the shared pointer to this set
+  epoch_node_t retired; ///< tracking for deferred deallocation
 } set_impl_t;
 
-/// get the capacity (in slots) of a set
-static inline size_t set_capacity(const set_impl_t set) {
-  return (size_t)1 << set.capacity >> 1;
-}
+/// values of `set_impl_t.stage`
+enum {
+  LIVE = 0,      ///< no migration has been started
+  GROWING = 1,   ///< a thread is allocating `next`
+  MIGRATING = 2, ///< `next` is published and slots are being moved to it
+};
+
+/// number of slots a migrator claims at once
+enum { MIGRATION_CHUNK = 64 };
+
+/// number of tags compared at once during probing
+enum { GROUP = 16 };
+
+/// number of items hashed and prefetched ahead in batched operations
+enum { BATCH = 16 };
+
+// occupancy accounting, written in terms of the `set_impl_t` defined above
+#include "set_load.h"
 
 /// atomically read a slot from a hash table
 static inline slot_t slot_load(_Atomic slot_t *slotptr) {
@@ -118,6 +221,129 @@ static inline slot_t slot_moved(slot_t slot) {
   return slot | MIGRATED;
 }
 
+/// derive the tag of an item from its hash
+static inline uint8_t hash_to_tag(size_t h) {
+  return (uint8_t)(0x80 | (h >> (sizeof(h) * CHAR_BIT - 7)));
+}
+
+/// record the tag of a slot, after having written the slot itself
+static inline void tag_store(set_impl_t *set, size_t index, uint8_t tag) {
+  atomic_store_explicit(&set->tags[index], tag, memory_order_release);
+}
+
+/// find slots in a group that may contain an item with the given tag
+///
+/// @param group Pointer to the first tag in the group
+/// @param tag Tag to search for
+/// @return A bitmask with bit `i` set if `group[i]` is either `tag` or 0
+static inline unsigned tag_group_match(_Atomic uint8_t *group, uint8_t tag) {
+  assert(group != NULL);
+  assert((uintptr_t)group % GROUP == 0);
+
+#ifdef USE_SSE2
+  // The tags are only hints, so a torn or stale read is harmless. As such, we
+  // can read them non-atomically with a single SSE2 load.
+  {
+    typedef __m128i __attribute__((may_alias)) group_t;
+
+    const __m128i g = _mm_load_si128((const group_t *)(const void *)group);
+    const __m128i hit = _mm_cmpeq_epi8(g, _mm_set1_epi8((char)tag));
+    const __m128i unwritten = _mm_cmpeq_epi8(g, _mm_setzero_si128());
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(hit, unwritten));
+  }
+#else
+  unsigned match = 0;
+  for (size_t i = 0; i < GROUP; ++i) {
+    const uint8_t t = atomic_load_explicit(&group[i], memory_order_relaxed);
+    if (t == tag || t == 0)
+      match |= 1u << i;
+  }
+  return match;
+#endif
+}
+
+/// state of a probe sequence through a set
+typedef struct {
+  size_t group;        ///< index of the first slot in the current group
+  size_t step;         ///< how many groups past the first have we visited?
+  unsigned candidates; ///< slots in the current group yet to be inspected
+} probe_t;
+
+/// number of slots in each probing group of a set
+static inline size_t probe_width(const set_impl_t *set) {
+  return set_capacity(set) < GROUP ? set_capacity(set) : GROUP;
+}
+
+/// bitmask of the valid slots in each probing group of a set
+static inline unsigned probe_valid(const set_impl_t *set) {
+  return (unsigned)(((size_t)1 << probe_width(set)) - 1);
+}
+
+/// begin probing a set for an item
+///
+/// Slots are visited in linear probing order, starting at the item’s hash
+/// bucket. Slots whose tag rules them out are skipped.
+///
+/// @param set Set to probe
+/// @param h Hash of the sought item
+/// @param tag Tag of the sought item
+/// @return Probing state to pass to `probe_next`
+static inline probe_t probe_start(set_impl_t *set, size_t h, uint8_t tag) {
+  assert(set != NULL);
+
+  const size_t start = h & (set_capacity(set) - 1);
+  const size_t group = start & ~(probe_width(set) - 1);
+  const unsigned match = tag_group_match(&set->tags[group], tag);
+  const unsigned skip = (1u << (start - group)) - 1;
+  return (probe_t){.group = group,
+                   .candidates = match & probe_valid(set) & ~skip};
+}
+
+/// get the next slot to inspect in a probe sequence
+///
+/// @param set Set being probed
+/// @param probe Probing state from `probe_start`
+/// @param h Hash of the sought item
+/// @param tag Tag of the sought item
+/// @param index [out] Index of the next slot to inspect
+/// @return False if the probe sequence is exhausted
+static inline bool probe_next(set_impl_t *set, probe_t *probe, size_t h,
+                              uint8_t tag, size_t *index) {
+  assert(set != NULL);
+  assert(probe != NULL);
+  assert(index != NULL);
+
+  const size_t groups = set_capacity(set) / probe_width(set);
+
+  while (probe->candidates == 0) {
+    if (probe->step == groups)
+      return false;
+    ++probe->step;
+    probe->group = (probe->group + probe_width(set)) & (set_capacity(set) - 1);
+    unsigned match = tag_group_match(&set->tags[probe->group], tag);
+    match &= probe_valid(set);
+
+    // on wrapping back around to the first group, only the slots preceding our
+    // starting bucket remain
+    if (probe->step == groups) {
+      const size_t start = h & (set_capacity(set) - 1);
+      match &= (1u << (start - probe->group)) - 1;
+    }
+
+    probe->candidates = match;
+  }
+
+#ifdef _MSC_VER
+  unsigned long bit;
+  _BitScanForward(&bit, probe->candidates);
+#else
+  const unsigned bit = (unsigned)__builtin_ctz(probe->candidates);
+#endif
+  probe->candidates &= probe->candidates - 1;
+  *index = probe->group + bit;
+  return true;
+}
+
 /// convert a set slot to its originating item pointer
 #define SLOT_TO_PTR(slot) (&(slot))
 
@@ -143,3 +369,106 @@ static inline bool eq(const void *a, const void *b, set_sig_t_ sig) {
     return sig.eq(a, b, sig.size);
   return memcmp(a, b, sig.size) == 0;
 }
+
+/// prefetch the storage an item with the given hash will be probed in
+///
+/// @param set Set to be probed
+/// @param h Hash of the sought item
+static inline void probe_prefetch(const set_impl_t *set, size_t h) {
+  assert(set != NULL);
+
+#ifdef __GNUC__
+  const size_t start = h & (set_capacity(set) - 1);
+  __builtin_prefetch((const void *)&set->tags[start & ~(size_t)(GROUP - 1)]);
+  __builtin_prefetch((const void *)&set->base[start]);
+#else
+  (void)h;
+#endif
+}
+
+/// find an item in a set table
+///
+/// @param set Set to search
+/// @param item Item to seek
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return True if the item was found
+static inline bool lookup(set_impl_t *set, const void *item, size_t h,
+                          set_sig_t_ sig) {
+  assert(set != NULL);
+
+  const uint8_t tag = hash_to_tag(h);
+  probe_t probe = probe_start(set, h, tag);
+  for (size_t index; probe_next(set, &probe, h, tag, &index);) {
+    const slot_t slot = slot_load(&set->base[index]);
+
+    // skip checking whether this slot is moved or not, because we do not care
+    // if we are racing with a rehashing and reading an older stale copy of the
+    // table
+
+    // if we see an empty slot, we have probed as far as this item would be
+    if (slot_is_free(slot))
+      break;
+
+    // skip tombstones
+    if (slot_is_deleted(slot))
+      continue;
+
+    // check if this is the item we are seeking
+    const void *const p = SLOT_TO_PTR(slot);
+    if (eq(item, p, sig))
+      return true;
+  }
+
+  return false;
+}
+
+/// create a new, empty set
+///
+/// @param capacity Exponent + 1 of the number of slots to allocate
+/// @return A shared pointer to the set or `(sp_t){0}` on out of memory
+PRIVATE sp_t set_unboxed_new_(size_t capacity);
+
+/// insert an item into a set table
+///
+/// The return value means:
+///   • 0 – the item was inserted
+///   • `EEXIST` – the item was already present
+///   • `ENOMEM` – not enough space to insert the item or a migration has begun
+///
+/// @param set Set to operate on
+/// @param item Copy to insert
+/// @param h Hash of `item`
+/// @param sig Signature of the set item type
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_unboxed_put_(set_impl_t *set, const void *item, size_t h,
+                             set_sig_t_ sig);
+
+/// begin migrating a set into a new table
+///
+/// If the set is uninitialised (`sp.ptr == NULL`), a new table is installed as
+/// the root directly.
+///
+/// The return value means:
+///   • 0 – a migration was started or the root was initialised
+///   • `EALREADY` – someone else is already migrating this set
+///   • `ENOMEM` – out of memory
+///
+/// @param set Set to operate on
+/// @param sp Reference to the current root of the set
+/// @param capacity Exponent + 1 of the number of slots in the new table
+/// @return 0 on success or an errno otherwise
+PRIVATE int set_unboxed_resize_(set_t_ *set, sp_t sp, size_t capacity);
+
+/// contribute to any in-progress migration of a set
+///
+/// If the table `sp` is being migrated, this claims and moves chunks of slots
+/// until there are none left, and then waits for any other migrators to finish
+/// theirs. The caller is expected to then re-acquire the root and retry its
+/// operation.
+///
+/// @param set Set to operate on
+/// @param sp Reference to the table to help migrate
+/// @param sig Signature of the set item type
+/// @return True if a migration was in progress
+PRIVATE bool set_unboxed_help_(set_t_ *set, sp_t sp, set_sig_t_ sig);
@@ -3,7 +3,9 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "hash.h"
 #include "set_unboxed.h"
+#include "sp_ctrl.h"
 #include <assert.h>
 #include <stdalign.h>
 #include <stdatomic.h>
@@ -11,7 +13,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <ute/asp.h>
-#include <ute/hash.h>
+#include <ute/epoch.h>
 #include <ute/set.h>
 
 bool set_unboxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
@@ -21,41 +23,15 @@ bool set_unboxed_contains_(set_t_ *set, const void *item, set_sig_t_ sig) {
   assert(sig.alignment <= alignof(uintptr_t));
   assert(sig.dtor == NULL);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(item, sig.size);
+  const size_t h = hash_item(sig.hash, item, sig.size);
 
-  // acquire a reference to the set
-  sp_t sp = sp_acq(&set->root);
+  // guard the set against being deallocated while we read it
+  epoch_enter();
+  set_impl_t *const s = sp_peek_(&set->root);
 
   // if the set is uninitialised, it is semantically empty
-  if (sp.ptr == NULL)
-    return false;
+  const bool found = s != NULL && lookup(s, item, h, sig);
 
-  set_impl_t *const s = sp.ptr;
-
-  for (size_t i = 0; i < set_capacity(*s); ++i) {
-    const size_t index = (h + i) % set_capacity(*s);
-    const slot_t slot = slot_load(&s->base[index]);
-
-    // skip checking whether this slot is moved or not, because we do not care
-    // if we are racing with a rehashing and reading an older stale copy of the
-    // table
-
-    // if we see an empty slot, we have probed as far as this item would be
-    if (slot_is_free(slot))
-      break;
-
-    // skip tombstones
-    if (slot_is_deleted(slot))
-      continue;
-
-    // check if this is the item we are seeking
-    const void *const p = SLOT_TO_PTR(slot);
-    if (eq(item, p, sig)) {
-      sp_rel(sp);
-      return true;
-    }
-  }
-
-  sp_rel(sp);
-  return false;
+  epoch_exit();
+  return found;
 }
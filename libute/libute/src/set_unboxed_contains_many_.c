@@ -0,0 +1,63 @@
+/// @file
+/// @brief Implementation of batched set existence check, for unboxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hash.h"
+#include "set_unboxed.h"
+#include "sp_ctrl.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/epoch.h>
+#include <ute/set.h>
+
+size_t set_unboxed_contains_many_(set_t_ *set, const void *items, size_t n,
+                                  bool *found, set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size < sizeof(uintptr_t));
+  assert(sig.alignment <= alignof(uintptr_t));
+  assert(sig.dtor == NULL);
+
+  const unsigned char *const it = items;
+
+  // guard the set against being deallocated while we read it, across the
+  // whole batch
+  epoch_enter();
+
+  size_t count = 0;
+  for (size_t base = 0; base < n; base += BATCH) {
+    const size_t m = n - base < BATCH ? n - base : BATCH;
+
+    // Reading from a table that is being migrated is safe, but it will grow
+    // increasingly stale. So read the current root afresh for each block.
+    set_impl_t *const s = sp_peek_(&set->root);
+
+    // hash this block of items up front and start pulling in the storage they
+    // will be probed in
+    size_t hashes[BATCH];
+    for (size_t i = 0; i < m && s != NULL; ++i) {
+      const void *const item = it + (base + i) * sig.size;
+      hashes[i] = hash_item(sig.hash, item, sig.size);
+      probe_prefetch(s, hashes[i]);
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+      const void *const item = it + (base + i) * sig.size;
+
+      // an uninitialised set is semantically empty
+      const bool f = s != NULL && lookup(s, item, hashes[i], sig);
+      if (found != NULL)
+        found[base + i] = f;
+      count += f;
+    }
+  }
+
+  epoch_exit();
+  return count;
+}
@@ -0,0 +1,46 @@
+/// @file
+/// @brief Implementation of set iteration, for unboxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "set_unboxed.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+int set_unboxed_foreach_(set_t_ *set, int (*callback)(const void *, void *),
+                         void *context, set_sig_t_ sig UNUSED) {
+  assert(set != NULL);
+  assert(callback != NULL);
+
+  // acquire a reference to the set
+  sp_t sp = sp_acq(&set->root);
+
+  // if the set is uninitialised, it is semantically empty
+  if (sp.ptr == NULL)
+    return 0;
+
+  set_impl_t *const s = sp.ptr;
+
+  // Walk only the table we hold. If it is being migrated, slots that have been
+  // moved retain their items, so we still see everything that was present when
+  // the migration began.
+  int rc = 0;
+  for (size_t i = 0; i < set_capacity(s); ++i) {
+    slot_t slot = slot_load(&s->base[i]);
+
+    // skip empty slots and tombstones
+    if (slot_is_free(slot) || slot_is_deleted(slot))
+      continue;
+
+    // pass the callback our local copy of the item
+    rc = callback(SLOT_TO_PTR(slot), context);
+    if (rc != 0)
+      break;
+  }
+
+  sp_rel(sp);
+  return rc;
+}
@@ -0,0 +1,84 @@
+/// @file
+/// @brief Implementation of batched set insertion, for unboxed set
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "hash.h"
+#include "set_unboxed.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/asp.h>
+#include <ute/set.h>
+
+int set_unboxed_insert_many_(set_t_ *set, void *items, size_t n, bool *exists,
+                             set_sig_t_ sig) {
+  assert(set != NULL);
+  assert(items != NULL || n == 0 || sig.size == 0);
+  assert(sig.size < sizeof(uintptr_t));
+  assert(sig.alignment <= alignof(uintptr_t));
+  assert(sig.dtor == NULL);
+
+  const unsigned char *const it = items;
+
+  // acquire a reference to the set, which we hold across the whole batch
+  // unless we need to move to a successor table
+  sp_t sp = sp_acq(&set->root);
+
+  for (size_t base = 0; base < n; base += BATCH) {
+    const size_t m = n - base < BATCH ? n - base : BATCH;
+
+    // hash this block of items up front and start pulling in the storage they
+    // will be probed in
+    size_t hashes[BATCH];
+    for (size_t i = 0; i < m; ++i) {
+      const void *const item = it + (base + i) * sig.size;
+      hashes[i] = hash_item(sig.hash, item, sig.size);
+      if (sp.ptr != NULL)
+        probe_prefetch(sp.ptr, hashes[i]);
+    }
+
+    for (size_t i = 0; i < m;) {
+      const void *const item = it + (base + i) * sig.size;
+
+      // if someone is migrating the set, help them and then move to the
+      // successor
+      if (set_unboxed_help_(set, sp, sig)) {
+        sp_rel(sp);
+        sp = sp_acq(&set->root);
+        continue;
+      }
+
+      set_impl_t *const s = sp.ptr;
+
+      // do we need to expand or compact the backing storage?
+      if (set_is_full(s)) {
+        const size_t c = set_resize_capacity(s, false);
+        const int rc = set_unboxed_resize_(set, sp, c);
+        sp_rel(sp);
+        if (rc == ENOMEM)
+          return ENOMEM;
+        sp = sp_acq(&set->root);
+        continue;
+      }
+
+      const int rc = set_unboxed_put_(s, item, hashes[i], sig);
+      if (rc != 0 && rc != EEXIST) {
+        // we raced with the start of a migration
+        sp_rel(sp);
+        sp = sp_acq(&set->root);
+        continue;
+      }
+      if (exists != NULL)
+        exists[base + i] = rc == EEXIST;
+      ++i;
+    }
+  }
+
+  sp_rel(sp);
+  return 0;
+}
@@ -3,6 +3,8 @@
 ///
 /// All content in this file is in the public domain. Use it any way you wish.
 
+#include "backoff.h"
+#include "hash.h"
 #include "set_unboxed.h"
 #include <assert.h>
 #include <stdalign.h>
@@ -11,7 +13,6 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <ute/asp.h>
-#include <ute/hash.h>
 #include <ute/set.h>
 
 bool set_unboxed_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
@@ -21,8 +22,9 @@ bool set_unboxed_remove_(set_t_ *set, const void *item, set_sig_t_ sig) {
   assert(sig.alignment <= alignof(uintptr_t));
   assert(sig.dtor == NULL);
 
-  const size_t h = (sig.hash != NULL ? sig.hash : hash)(item, sig.size);
+  const size_t h = hash_item(sig.hash, item, sig.size);
 
+  backoff_t backoff = {0};
 retry1:;
   // acquire a reference to the set
   sp_t sp = sp_acq(&set->root);
@@ -33,20 +35,25 @@ retry1:;
 
   set_impl_t *const s = sp.ptr;
 
-  for (size_t i = 0; i < set_capacity(*s); ++i) {
-    const size_t index = (h + i) % set_capacity(*s);
+  const uint8_t tag = hash_to_tag(h);
+  probe_t probe = probe_start(s, h, tag);
+  for (size_t index; probe_next(s, &probe, h, tag, &index);) {
     slot_t slot = slot_load(&s->base[index]);
 
   retry2:
     if (slot_is_moved(slot)) {
-      // someone is rehashing the set into new storage
+      // someone is rehashing the set into new storage, so help them
+      (void)set_unboxed_help_(set, sp, sig);
       sp_rel(sp);
+      backoff_(&backoff);
       goto retry1;
     }
 
     // if this slot is unoccupied, we have probed as far as the item could be
-    if (slot_is_free(slot))
-      break;
+    if (slot_is_free(slot)) {
+      sp_rel(sp);
+      return false;
+    }
 
     // skip tombstones
     if (slot_is_deleted(slot))
@@ -56,14 +63,32 @@ retry1:;
     const void *const p = SLOT_TO_PTR(slot);
     if (eq(item, p, sig)) {
       // mark as deleted
-      if (!slot_cas(&s->base[index], &slot, slot_deleted(slot)))
+      if (!slot_cas(&s->base[index], &slot, slot_deleted(slot))) {
+        backoff_(&backoff);
         goto retry2;
-      (void)atomic_fetch_add_explicit(&s->deleted, 1, memory_order_acq_rel);
+      }
+
+      // if tombstones are accumulating, rehash to reclaim them
+      if (set_add_deleted(s)) {
+        const size_t c = set_resize_capacity(s, true);
+        if (set_unboxed_resize_(set, sp, c) == 0)
+          (void)set_unboxed_help_(set, sp, sig);
+      }
+
       sp_rel(sp);
       return true;
     }
   }
 
+  // We have exhausted the probe sequence without seeing a free slot. Because
+  // we skipped slots whose tags did not match, we may also have passed over
+  // moved slots. So check whether we need to retry in a successor table.
+  if (set_unboxed_help_(set, sp, sig)) {
+    sp_rel(sp);
+    backoff_(&backoff);
+    goto retry1;
+  }
+
   sp_rel(sp);
   return false;
 }
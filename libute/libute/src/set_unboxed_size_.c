@@ -5,7 +5,6 @@
 
 #include "set_unboxed.h"
 #include <assert.h>
-#include <stdatomic.h>
 #include <stddef.h>
 #include <ute/asp.h>
 #include <ute/attr.h>
@@ -22,17 +21,10 @@ size_t set_unboxed_size_(set_t_ *set, set_sig_t_ sig UNUSED) {
   if (sp.ptr == NULL)
     return 0;
 
-  const set_impl_t *const s = sp.ptr;
-  const size_t used = atomic_load_explicit(&s->used, memory_order_acquire);
-  const size_t deleted =
-      atomic_load_explicit(&s->deleted, memory_order_acquire);
+  set_impl_t *const s = sp.ptr;
+  const size_t size = set_live(s);
 
   sp_rel(sp);
 
-  // in the case of racing insertions and deletes, we can see an inconsistent
-  // state
-  if (used < deleted)
-    return 0;
-
-  return used - deleted;
+  return size;
 }
@@ -0,0 +1,135 @@
+/// @file
+/// @brief Slab allocator internals
+///
+/// A slab hands out fixed-size blocks of memory, carved from larger chunks that
+/// are obtained from the system allocator. Freed blocks are recycled through a
+/// lock-free free list, so in steady state allocation and deallocation do not
+/// touch the system allocator at all.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/stack.h>
+
+/// a slab
+///
+/// Each block is immediately preceded by a hidden header word:
+///
+///   chunk
+///   ┌───────┬───┬─────┬─────────┬───┬─────┬─────────┬──
+///   │ next¹ │ … │ hdr │  block  │ … │ hdr │  block  │ …
+///   └───────┴───┴─────┴─────────┴───┴─────┴─────────┴──
+///                     ▲
+///                     └─ pointer returned to callers
+///
+/// While a block is free, its header links it to the header of the next block
+/// in the free list. While it is allocated, the header points back to the slab
+/// it came from. The header is only ever accessed atomically, so a thread
+/// racing to pop a block that has just been handed out reads a stale but
+/// harmless value.
+///
+/// Chunks are only released when the slab itself is destroyed. This means a
+/// block’s memory stays valid for the lifetime of the slab, whatever state the
+/// block is in.
+///
+/// ¹ Chunks are linked together so they can be found when the slab is
+///   destroyed.
+typedef struct slab {
+  /// free list, linking the headers of free blocks
+  STACK(void *_Atomic) free;
+
+  void *_Atomic chunks; ///< most recently allocated chunk
+
+  /// references to this slab
+  ///
+  /// One reference is held by each owner of the slab and one by each allocated
+  /// block.
+  atomic_size_t refs;
+
+  atomic_size_t chunk_blocks; ///< number of blocks in the next chunk
+
+  size_t alignment; ///< alignment of blocks
+  size_t offset;    ///< bytes from the start of a chunk to its first block
+  size_t stride;    ///< bytes from the start of one block to the next
+
+  void *context; ///< opaque value for the use of the slab’s creator
+} slab_t;
+
+/// number of blocks in the first chunk of a slab
+enum { SLAB_MIN_BLOCKS = 8 };
+
+/// maximum number of blocks in a chunk
+enum { SLAB_MAX_BLOCKS = 512 };
+
+/// get the header of a block
+static inline void *_Atomic *slab_header(void *block) {
+  assert(block != NULL);
+  return (void *_Atomic *)block - 1;
+}
+
+/// get the slab an allocated block came from
+///
+/// @param block A block returned from `slab_alloc_`
+/// @return The owning slab
+static inline slab_t *slab_owner(void *block) {
+  return atomic_load_explicit(slab_header(block), memory_order_relaxed);
+}
+
+/// take an additional reference to a slab
+///
+/// @param slab Slab to retain
+static inline void slab_retain(slab_t *slab) {
+  assert(slab != NULL);
+  (void)atomic_fetch_add_explicit(&slab->refs, 1, memory_order_relaxed);
+}
+
+/// push a chain of blocks onto a slab’s free list
+///
+/// The blocks from `first` to `last` must already be linked together, through
+/// their headers.
+///
+/// @param slab Slab to operate on
+/// @param first First block in the chain
+/// @param last Last block in the chain
+static inline void slab_push(slab_t *slab, void *first, void *last) {
+  assert(slab != NULL);
+  assert(first != NULL);
+  assert(last != NULL);
+
+  STACK_PUSH_CHAIN(&slab->free, slab_header(first), slab_header(last));
+}
+
+/// create a new slab
+///
+/// The caller receives the only reference to the slab and should drop it with
+/// `slab_release_` when done.
+///
+/// @param size Size in bytes of each block
+/// @param alignment Required alignment of each block
+/// @param context Opaque value to store in the slab
+/// @return A new slab or `NULL` on out of memory
+PRIVATE slab_t *slab_new_(size_t size, size_t alignment, void *context);
+
+/// allocate a block from a slab
+///
+/// The block holds a reference to the slab until it is returned via
+/// `slab_free_`.
+///
+/// @param slab Slab to allocate from
+/// @return A new block or `NULL` on out of memory
+PRIVATE void *slab_alloc_(slab_t *slab);
+
+/// return a block to the slab it was allocated from
+///
+/// @param block A block returned from `slab_alloc_`
+PRIVATE void slab_free_(void *block);
+
+/// drop a reference to a slab, destroying it if this was the last
+///
+/// @param slab Slab to release
+PRIVATE void slab_release_(slab_t *slab);
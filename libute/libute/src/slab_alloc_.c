@@ -0,0 +1,93 @@
+/// @file
+/// @brief Implementation of slab allocation
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "slab.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/aligned_alloc.h>
+#include <ute/stack.h>
+
+/// hand out a block that has been removed from the free list
+///
+/// @param slab Slab the block came from
+/// @param block Block to hand out
+/// @return `block`
+static void *claim(slab_t *slab, void *block) {
+  assert(slab != NULL);
+  assert(block != NULL);
+
+  atomic_store_explicit(slab_header(block), slab, memory_order_relaxed);
+  slab_retain(slab);
+  return block;
+}
+
+/// try to take a block from the free list
+///
+/// @param slab Slab to allocate from
+/// @return A block or `NULL` if the free list was empty
+static void *pop(slab_t *slab) {
+  assert(slab != NULL);
+
+  void *_Atomic *const header = STACK_POP(&slab->free);
+  if (header == NULL)
+    return NULL;
+  return header + 1;
+}
+
+void *slab_alloc_(slab_t *slab) {
+  assert(slab != NULL);
+
+  {
+    void *const block = pop(slab);
+    if (block != NULL)
+      return claim(slab, block);
+  }
+
+  // the free list is empty, so allocate a new chunk, growing the chunk size
+  // each time so that small slabs stay small and large slabs make few trips to
+  // the system allocator
+  size_t n = atomic_load_explicit(&slab->chunk_blocks, memory_order_relaxed);
+  if (n < SLAB_MAX_BLOCKS)
+    (void)atomic_compare_exchange_strong_explicit(&slab->chunk_blocks, &n,
+                                                  n * 2, memory_order_relaxed,
+                                                  memory_order_relaxed);
+  if ((SIZE_MAX - slab->offset) / slab->stride < n)
+    return NULL;
+  char *const chunk =
+      ALIGNED_ALLOC(slab->alignment, slab->offset + n * slab->stride);
+  if (chunk == NULL)
+    return NULL;
+
+  // link the chunk in, so it can be found when the slab is destroyed
+  void *_Atomic *const link = (void *)chunk;
+  backoff_t backoff = {0};
+  void *prev = atomic_load_explicit(&slab->chunks, memory_order_relaxed);
+  while (true) {
+    atomic_store_explicit(link, prev, memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(&slab->chunks, &prev, chunk,
+                                              memory_order_release,
+                                              memory_order_relaxed))
+      break;
+    backoff_(&backoff);
+  }
+
+  // keep the first block for ourselves and put the rest on the free list
+  void *const first = chunk + slab->offset;
+  if (n > 1) {
+    for (size_t i = 1; i + 1 < n; ++i) {
+      void *const block = chunk + slab->offset + i * slab->stride;
+      STACK_SET_NEXT(&slab->free, slab_header(block),
+                     slab_header((char *)block + slab->stride));
+    }
+    slab_push(slab, (char *)first + slab->stride,
+              (char *)first + (n - 1) * slab->stride);
+  }
+
+  return claim(slab, first);
+}
@@ -0,0 +1,20 @@
+/// @file
+/// @brief Implementation of slab deallocation
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "slab.h"
+#include <assert.h>
+#include <stddef.h>
+
+void slab_free_(void *block) {
+  assert(block != NULL);
+
+  slab_t *const slab = slab_owner(block);
+  assert(slab != NULL);
+
+  slab_push(slab, block, block);
+
+  // drop the reference the block held, which may destroy the slab
+  slab_release_(slab);
+}
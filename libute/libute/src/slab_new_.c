@@ -0,0 +1,46 @@
+/// @file
+/// @brief Implementation of slab creation
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "slab.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/aligned_alloc.h>
+
+/// round a size up to a multiple of a power of 2
+static size_t round_up(size_t size, size_t alignment) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+slab_t *slab_new_(size_t size, size_t alignment, void *context) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+  // block headers are pointers, so blocks need at least pointer alignment to
+  // keep them aligned too
+  if (alignment < alignof(void *))
+    alignment = alignof(void *);
+
+  if (size > SIZE_MAX - sizeof(void *) - alignment)
+    return NULL;
+
+  slab_t *const s = ALIGNED_ALLOC(alignof(slab_t), sizeof(*s));
+  if (s == NULL)
+    return NULL;
+
+  *s = (slab_t){
+      .alignment = alignment,
+      // leave room for the chunk link and the first block’s header
+      .offset = round_up(2 * sizeof(void *), alignment),
+      .stride = round_up(size + sizeof(void *), alignment),
+      .context = context,
+  };
+  atomic_init(&s->refs, 1);
+  atomic_init(&s->chunk_blocks, SLAB_MIN_BLOCKS);
+
+  return s;
+}
@@ -0,0 +1,30 @@
+/// @file
+/// @brief Implementation of slab destruction
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "slab.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/aligned_alloc.h>
+
+void slab_release_(slab_t *slab) {
+  if (slab == NULL)
+    return;
+
+  if (atomic_fetch_sub_explicit(&slab->refs, 1, memory_order_acq_rel) != 1)
+    return;
+
+  // we were the last reference, so no blocks are in use and nobody else can
+  // be touching the free list
+  void *chunk = atomic_load_explicit(&slab->chunks, memory_order_acquire);
+  while (chunk != NULL) {
+    void *const next =
+        atomic_load_explicit((void *_Atomic *)chunk, memory_order_relaxed);
+    ALIGNED_FREE(chunk);
+    chunk = next;
+  }
+
+  ALIGNED_FREE(slab);
+}
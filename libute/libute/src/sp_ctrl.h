@@ -0,0 +1,75 @@
+/// @file
+/// @brief Shared pointer control block internals
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <ute/asp.h>
+
+struct sp_ctrl {
+  void *value;                  ///< the managed underlying pointer
+  void (*dtor)(void *, void *); ///< optional user-supplied destructor
+  void *dtor_context;           ///< second parameter to `dtor`
+  atomic_size_t ref_count;      ///< outstanding references
+
+  /// does this control block live in storage owned by `dtor`?
+  ///
+  /// If so, the control block is not separately freed when the last reference
+  /// is released. It is the destructor’s responsibility to reclaim it.
+  bool embedded;
+
+  /// is this control block at the start of a single allocation from `sp_make`,
+  /// which also holds the value?
+  ///
+  /// If so, the whole allocation is freed after the destructor is called.
+  bool fused;
+
+  /// next control block awaiting destruction (see `sp_deferred_`)
+  struct sp_ctrl *deferred;
+};
+
+/// global state of deferred destruction
+typedef struct {
+  atomic_bool enabled; ///< should destructors be left for `sp_reclaim`?
+
+  /// control blocks whose last reference has been released
+  sp_ctrl_t *_Atomic queue;
+} sp_deferred_t;
+
+/// global state of deferred destruction
+///
+/// When enabled, releasing the last reference to a shared pointer pushes its
+/// control block onto a queue, rather than running its destructor. Allocations
+/// reclaimed by epochs (see ./epoch.h) are similarly queued. `sp_reclaim`
+/// drains both.
+extern PRIVATE sp_deferred_t sp_deferred_;
+
+/// create a new shared pointer with a caller-provided control block
+///
+/// This is an alternative to `sp_new` for callers who can allocate the control
+/// block alongside the value being managed. `ctrl` must remain valid until
+/// `dtor` is called, after which it is no longer accessed.
+///
+/// @param ctrl Storage for the control block
+/// @param value Raw pointer to encapsulate, which must not be null
+/// @param dtor Destructor to be called when last `sp_t` is released
+/// @param dtor_context Value to pass in `dtor` calls as second parameter
+/// @return A shared pointer
+PRIVATE sp_t sp_new_in_(sp_ctrl_t *ctrl, void *value,
+                        void (*dtor)(void *, void *), void *dtor_context);
+
+/// read the current target of an atomic shared pointer without acquiring it
+///
+/// No reference is taken, so the returned pointer is only valid while the
+/// caller otherwise knows it cannot be released. For example, the caller is
+/// inside an epoch guard (see ./epoch.h) and `asp`’s targets are only ever
+/// deallocated through `epoch_retire_`. Their control blocks must also be
+/// embedded in storage reclaimed this way, as this reads through it.
+///
+/// @param asp Atomic shared pointer to read
+/// @return The current target of `asp`
+PRIVATE void *sp_peek_(asp_t *asp);
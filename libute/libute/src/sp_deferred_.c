@@ -0,0 +1,8 @@
+/// @file
+/// @brief Storage for deferred destruction state
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "sp_ctrl.h"
+
+sp_deferred_t sp_deferred_;
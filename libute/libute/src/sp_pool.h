@@ -0,0 +1,94 @@
+/// @file
+/// @brief Pooled allocation of shared pointer control blocks
+///
+/// Control blocks allocated by `sp_new` are all the same size, and tend to be
+/// freed and reallocated in quick succession. Rather than going through the
+/// system allocator each time, freed blocks are kept for reuse.
+///
+/// Each thread caches a small stack of free blocks (a magazine), which it can
+/// allocate from and free into without synchronising with any other thread.
+/// A thread that frees into a full magazine moves half its contents to a
+/// global lock-free stack (the depot) in one operation. A thread whose
+/// magazine is empty allocates from the depot, and only falls back to the
+/// system allocator if that is also empty.
+///
+/// Blocks are never returned to the system allocator. The pool is therefore
+/// bounded by the peak number of control blocks simultaneously live.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include "attr.h"
+#include "counter.h"
+#include "sp_ctrl.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/stack.h>
+
+/// storage for a control block
+///
+/// While a block is free, its first word links it to the next block in the
+/// depot. This word overlaps `sp_ctrl_t.value`, which `sp_new` writes with a
+/// plain store once the block has been popped. A thread racing to pop the same
+/// block can still read the word atomically at this point (see ute/stack.h).
+/// This is a data race, but the racing thread’s compare-and-swap on the depot
+/// fails and it discards what it read. As blocks are never returned to the
+/// system allocator, the read itself is always of valid memory.
+typedef union sp_pool_block {
+  sp_ctrl_t ctrl;                    ///< the control block, while allocated
+  union sp_pool_block *_Atomic next; ///< next free block, while in the depot
+} sp_pool_block_t;
+
+/// number of blocks a magazine holds
+enum { SP_POOL_MAGAZINE = 32 };
+
+/// a thread’s cache of free blocks
+///
+/// Magazines are allocated on a thread’s first use and never freed. When the
+/// thread exits, its magazine is released for reuse by a later thread, along
+/// with the blocks it holds.
+typedef struct sp_pool_magazine {
+  size_t size;                               ///< number of blocks held
+  sp_pool_block_t *blocks[SP_POOL_MAGAZINE]; ///< free blocks
+
+  atomic_bool in_use; ///< is this magazine owned by a live thread?
+
+  struct sp_pool_magazine *next; ///< next magazine in `sp_pool_.magazines`
+} sp_pool_magazine_t;
+
+/// global state of the control block pool
+typedef struct {
+  STACK(sp_pool_block_t) depot; ///< free blocks shared among threads
+
+  /// every magazine that has ever been allocated
+  sp_pool_magazine_t *_Atomic magazines;
+
+  counter_t hits;   ///< allocations satisfied by the pool
+  counter_t misses; ///< allocations that fell back to the system allocator
+} sp_pool_t;
+
+/// global state of the control block pool
+extern PRIVATE sp_pool_t sp_pool_;
+
+/// magazine of the calling thread
+extern PRIVATE _Thread_local sp_pool_magazine_t *sp_pool_magazine_;
+
+/// acquire a magazine for the calling thread
+///
+/// @return The acquired magazine or `NULL` on out-of-memory
+PRIVATE sp_pool_magazine_t *sp_pool_register_(void);
+
+/// allocate a control block
+///
+/// The returned block’s contents are unspecified.
+///
+/// @return A control block or `NULL` on out-of-memory
+PRIVATE sp_ctrl_t *sp_pool_alloc_(void);
+
+/// return a control block to the pool
+///
+/// @param ctrl A control block previously returned by `sp_pool_alloc_`
+PRIVATE void sp_pool_free_(sp_ctrl_t *ctrl);
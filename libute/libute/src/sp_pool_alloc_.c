@@ -0,0 +1,40 @@
+/// @file
+/// @brief Implementation of allocating a control block from the pool
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "counter.h"
+#include "sp_ctrl.h"
+#include "sp_pool.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/stack.h>
+
+sp_ctrl_t *sp_pool_alloc_(void) {
+
+  sp_pool_magazine_t *m = sp_pool_magazine_;
+  if (m == NULL)
+    m = sp_pool_register_();
+
+  // allocate from our own magazine if we can
+  if (m != NULL && m->size > 0) {
+    (void)counter_add(&sp_pool_.hits, 1);
+    return &m->blocks[--m->size]->ctrl;
+  }
+
+  // otherwise, try popping a block from the depot
+  {
+    sp_pool_block_t *const block = STACK_POP(&sp_pool_.depot);
+    if (block != NULL) {
+      (void)counter_add(&sp_pool_.hits, 1);
+      return &block->ctrl;
+    }
+  }
+
+  // fall back to the system allocator
+  (void)counter_add(&sp_pool_.misses, 1);
+  sp_pool_block_t *const block = malloc(sizeof(*block));
+  if (block == NULL)
+    return NULL;
+  return &block->ctrl;
+}
@@ -0,0 +1,40 @@
+/// @file
+/// @brief Implementation of returning a control block to the pool
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "sp_ctrl.h"
+#include "sp_pool.h"
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include <ute/stack.h>
+
+void sp_pool_free_(sp_ctrl_t *ctrl) {
+  assert(ctrl != NULL);
+
+  sp_pool_block_t *const block = (void *)ctrl;
+
+  sp_pool_magazine_t *m = sp_pool_magazine_;
+  if (m == NULL)
+    m = sp_pool_register_();
+
+  // without a magazine, return the block straight to the depot
+  if (m == NULL) {
+    STACK_PUSH(&sp_pool_.depot, block);
+    return;
+  }
+
+  // if our magazine is full, move the older half of it to the depot
+  if (m->size == SP_POOL_MAGAZINE) {
+    enum { HALF = SP_POOL_MAGAZINE / 2 };
+    for (size_t i = 0; i + 1 < HALF; ++i)
+      STACK_SET_NEXT(&sp_pool_.depot, m->blocks[i], m->blocks[i + 1]);
+    STACK_PUSH_CHAIN(&sp_pool_.depot, m->blocks[0], m->blocks[HALF - 1]);
+    memmove(&m->blocks[0], &m->blocks[HALF],
+            (SP_POOL_MAGAZINE - HALF) * sizeof(m->blocks[0]));
+    m->size -= HALF;
+  }
+
+  m->blocks[m->size++] = block;
+}
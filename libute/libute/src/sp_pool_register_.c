@@ -0,0 +1,84 @@
+/// @file
+/// @brief Implementation of acquiring a per-thread control block magazine
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "sp_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#if USE_PTHREADS
+#include <pthread.h>
+
+/// key whose destructor releases a thread’s magazine when the thread exits
+static pthread_key_t key;
+
+/// was `key` successfully created?
+static bool have_key;
+
+/// guard for creating `key`
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/// release the magazine of an exiting thread
+///
+/// @param magazine Magazine to release
+static void release(void *magazine) {
+  sp_pool_magazine_t *const m = magazine;
+
+  // forget the magazine in case a later thread-exit handler frees a block
+  sp_pool_magazine_ = NULL;
+
+  // the blocks the magazine holds go with it to its next owner
+  atomic_store_explicit(&m->in_use, false, memory_order_release);
+}
+
+/// create `key`
+static void make_key(void) {
+  have_key = pthread_key_create(&key, release) == 0;
+}
+#endif
+
+sp_pool_magazine_t *sp_pool_register_(void) {
+
+  // try to reuse a magazine released by a thread that has since exited
+  sp_pool_magazine_t *m =
+      atomic_load_explicit(&sp_pool_.magazines, memory_order_acquire);
+  for (; m != NULL; m = m->next) {
+    bool in_use = false;
+    if (atomic_compare_exchange_strong_explicit(&m->in_use, &in_use, true,
+                                                memory_order_acq_rel,
+                                                memory_order_relaxed))
+      break;
+  }
+
+  if (m == NULL) {
+    // Magazines are never freed, so use the system allocator rather than
+    // `ALIGNED_ALLOC`, whose leak checks would flag them.
+    m = calloc(1, sizeof(*m));
+    if (m == NULL)
+      return NULL;
+    atomic_init(&m->in_use, true);
+
+    // add it to the list of magazines
+    backoff_t backoff = {0};
+    m->next = atomic_load_explicit(&sp_pool_.magazines, memory_order_acquire);
+    while (!atomic_compare_exchange_weak_explicit(&sp_pool_.magazines,
+                                                  &m->next, m,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire))
+      backoff_(&backoff);
+  }
+
+#if USE_PTHREADS
+  // arrange for the magazine to be released when we exit
+  (void)pthread_once(&key_once, make_key);
+  if (have_key)
+    (void)pthread_setspecific(key, m);
+#endif
+
+  sp_pool_magazine_ = m;
+  return m;
+}
@@ -0,0 +1,10 @@
+/// @file
+/// @brief Storage for the control block pool
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "sp_pool.h"
+
+sp_pool_t sp_pool_;
+
+_Thread_local sp_pool_magazine_t *sp_pool_magazine_;
@@ -0,0 +1,13 @@
+/// @file
+/// @brief Implementation of reading control block pool statistics
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "counter.h"
+#include "sp_pool.h"
+#include <ute/asp.h>
+
+sp_pool_stats_t sp_pool_stats(void) {
+  return (sp_pool_stats_t){.hits = counter_read(&sp_pool_.hits),
+                           .misses = counter_read(&sp_pool_.misses)};
+}
@@ -0,0 +1,48 @@
+/// @file
+/// @brief Intrusive stack internals
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/dword.h>
+
+/// construct a stack head
+///
+/// @param top Pointer to the top item
+/// @param tag Update counter
+/// @return The encoded head
+static inline dword_t stack_encode(void *top, uintptr_t tag) {
+  const uintptr_t words[] = {(uintptr_t)top, tag};
+  dword_t encoded;
+  assert(sizeof(encoded) == sizeof(words));
+  memcpy(&encoded, words, sizeof(encoded));
+  return encoded;
+}
+
+/// deconstruct a stack head
+///
+/// @param head Encoded head
+/// @param tag [out] Update counter
+/// @return Pointer to the top item
+static inline void *stack_decode(dword_t head, uintptr_t *tag) {
+  assert(tag != NULL);
+
+  uintptr_t words[2];
+  assert(sizeof(words) == sizeof(head));
+  memcpy(words, &head, sizeof(words));
+  *tag = words[1];
+  return (void *)words[0];
+}
+
+/// get the link word of an item
+///
+/// @param item Item to inspect
+/// @return Pointer to the link to the item’s successor
+static inline void *_Atomic *stack_link(void *item) {
+  assert(item != NULL);
+  return item;
+}
@@ -0,0 +1,15 @@
+/// @file
+/// @brief Implementation of walking a chain of stack items
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "stack.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/stack.h>
+
+void *stack_next_(void *item) {
+  assert(item != NULL);
+  return atomic_load_explicit(stack_link(item), memory_order_relaxed);
+}
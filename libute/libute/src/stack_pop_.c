@@ -0,0 +1,35 @@
+/// @file
+/// @brief Implementation of popping from a stack
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "stack.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dword.h>
+#include <ute/stack.h>
+
+void *stack_pop_(stack_t_ *stack) {
+  assert(stack != NULL);
+
+  backoff_t backoff = {0};
+  dword_t old = dword_atomic_load(&stack->head);
+  while (true) {
+    uintptr_t tag;
+    void *const top = stack_decode(old, &tag);
+    if (top == NULL)
+      return NULL;
+
+    // if `top` is popped by someone else before we swap, this reads an
+    // unrelated value, but our compare-and-swap will then fail on the tag
+    void *const next =
+        atomic_load_explicit(stack_link(top), memory_order_relaxed);
+    if (dword_atomic_cas(&stack->head, &old, stack_encode(next, tag + 1)))
+      return top;
+    backoff_(&backoff);
+  }
+}
@@ -0,0 +1,32 @@
+/// @file
+/// @brief Implementation of emptying a stack
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "stack.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dword.h>
+#include <ute/stack.h>
+
+void *stack_pop_all_(stack_t_ *stack) {
+  assert(stack != NULL);
+
+  // We could exchange in an empty head, but that would need to reset the tag.
+  // The tag must keep advancing, so that a thread part way through a pop that
+  // read the old top cannot succeed if the same item is pushed back.
+  backoff_t backoff = {0};
+  dword_t old = dword_atomic_load(&stack->head);
+  while (true) {
+    uintptr_t tag;
+    void *const top = stack_decode(old, &tag);
+    if (top == NULL)
+      return NULL;
+    if (dword_atomic_cas(&stack->head, &old, stack_encode(NULL, tag + 1)))
+      return top;
+    backoff_(&backoff);
+  }
+}
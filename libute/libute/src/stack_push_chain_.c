@@ -0,0 +1,31 @@
+/// @file
+/// @brief Implementation of pushing onto a stack
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include "stack.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dword.h>
+#include <ute/stack.h>
+
+void stack_push_chain_(stack_t_ *stack, void *first, void *last) {
+  assert(stack != NULL);
+  assert(first != NULL);
+  assert(last != NULL);
+
+  backoff_t backoff = {0};
+  dword_t old = dword_atomic_load(&stack->head);
+  while (true) {
+    uintptr_t tag;
+    void *const top = stack_decode(old, &tag);
+    atomic_store_explicit(stack_link(last), top, memory_order_relaxed);
+    if (dword_atomic_cas(&stack->head, &old, stack_encode(first, tag + 1)))
+      break;
+    backoff_(&backoff);
+  }
+}
@@ -0,0 +1,15 @@
+/// @file
+/// @brief Implementation of linking a chain of stack items
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "stack.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <ute/stack.h>
+
+void stack_set_next_(void *item, void *next) {
+  assert(item != NULL);
+  atomic_store_explicit(stack_link(item), next, memory_order_relaxed);
+}
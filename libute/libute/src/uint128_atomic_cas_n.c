@@ -1,16 +1,14 @@
 /// @file
 /// @brief Atomically compare-and-swap a 128-bit unsigned integer
 ///
+/// The definition is in ute/int128_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <ute/int128.h>
+#define USE_INLINE_ATOMICS 1
 
-bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
-                          uint128_t desired) {
-  assert(dst != NULL);
+#include <ute/int128.h>
 
-  return uint128_atomic_cas(dst, &expected, desired);
-}
+extern inline bool uint128_atomic_cas_n(uint128_t *dst, uint128_t expected,
+                                        uint128_t desired);
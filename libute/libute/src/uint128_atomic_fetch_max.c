@@ -0,0 +1,26 @@
+/// @file
+/// @brief Atomically raise a 128-bit unsigned integer to a bound
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/int128.h>
+
+uint128_t uint128_atomic_fetch_max(uint128_t *dst, uint128_t src) {
+  assert(dst != NULL);
+
+  backoff_t backoff = {0};
+  uint128_t old = uint128_atomic_load(dst);
+  while (true) {
+    // if the current value already satisfies the bound, avoid writing it and
+    // taking ownership of its cache line
+    if (src <= old)
+      return old;
+    if (uint128_atomic_cas(dst, &old, src))
+      return old;
+    backoff_(&backoff);
+  }
+}
@@ -0,0 +1,22 @@
+/// @file
+/// @brief Atomically subtract from a 128-bit unsigned integer
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "backoff.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/int128.h>
+
+uint128_t uint128_atomic_fetch_sub(uint128_t *dst, uint128_t src) {
+  assert(dst != NULL);
+
+  // There is no 128-bit fetch-and-sub instruction, so loop on a CAS. A failed
+  // CAS updates `old` to the current value, so we only load up front.
+  backoff_t backoff = {0};
+  uint128_t old = uint128_atomic_load(dst);
+  while (!uint128_atomic_cas(dst, &old, old - src))
+    backoff_(&backoff);
+
+  return old;
+}
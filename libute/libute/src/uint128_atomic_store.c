@@ -1,48 +1,13 @@
 /// @file
 /// @brief Atomically write a 128-bit unsigned integer
 ///
+/// The definition is in ute/int128_inline.h. This emits the external
+/// definition that calls which are not inlined resolve to.
+///
 /// All content in this file is in the public domain. Use it any way you wish.
 
-#include <assert.h>
-#include <stddef.h>
-#include <ute/int128.h>
-
-#ifndef __has_include
-#define __has_include(x) 0
-#endif
-
-#ifndef __has_feature
-#define __has_feature(x) 0
-#endif
+#define USE_INLINE_ATOMICS 1
 
-#ifdef __x86_64__
-#if __has_include(<immintrin.h>)
-#include <immintrin.h>
-#endif
-#endif
-
-void uint128_atomic_store(uint128_t *dst, uint128_t src) {
-  assert(dst != NULL);
-
-#ifdef __x86_64__
-#if __has_include(<immintrin.h>)
-#if !__has_feature(thread_sanitizer)
-#ifdef __SSE2__
-  // A 128-bit AVX store is atomic. However _mm_store_si128 does not reliably
-  // lower to a MOVDQA. Thankfully a volatile store seems to reliably lower to
-  // either this or MOVAPS.
-  {
-    typedef __m128i __attribute__((may_alias)) avx128_t;
-
-    volatile avx128_t *d = (avx128_t *)dst;
-    *d = (__m128i)src;
-  }
-#endif
-#endif
-#endif
-#endif
+#include <ute/int128.h>
 
-  // On 128-bit scalars, the __atomic built-ins and C11 atomics are not lowered
-  // to native instructions. So we resort to an xchg.
-  (void)uint128_atomic_xchg(dst, src);
-}
+extern inline void uint128_atomic_store(uint128_t *dst, uint128_t src);
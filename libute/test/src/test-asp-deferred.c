@@ -0,0 +1,86 @@
+/// @file
+/// @brief Test deferring shared pointer destructors
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/asp.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+#include <ute/set.h>
+
+/// number of `count_free` calls made so far
+static size_t dtor_calls;
+
+static void count_free(void *p, void *context UNUSED) {
+  free(p);
+  ++dtor_calls;
+}
+
+/// releasing the last reference should not run the destructor until reclaimed
+TEST("atomic shared pointer deferred destructor") {
+  dtor_calls = 0;
+  sp_defer_dtors(true);
+
+  asp_t ptr = 0;
+  {
+    int *const p = malloc(sizeof(*p));
+    ASSERT_NOT_NULL(p);
+    const sp_t sp = sp_new(p, count_free, NULL);
+    ASSERT_NOT_NULL(sp.ptr);
+    sp_store(&ptr, sp);
+  }
+
+  // overwriting the last reference should queue, not run, the destructor
+  sp_t null = {0};
+  sp_store(&ptr, null);
+  ASSERT_EQ(dtor_calls, (size_t)0);
+
+  ASSERT_GE(sp_reclaim(), (size_t)1);
+  ASSERT_EQ(dtor_calls, (size_t)1);
+
+  // nothing should be left
+  ASSERT_EQ(sp_reclaim(), (size_t)0);
+
+  sp_defer_dtors(false);
+}
+
+/// migrated tables should be reclaimed by `sp_reclaim`
+TEST("deferred destruction of set and dictionary tables") {
+  sp_defer_dtors(true);
+
+  SET(int) ints = {0};
+  DICT(int, int) dict = {0};
+
+  // grow both through several migrations
+  for (int i = 0; i < 1000; ++i) {
+    {
+      const int r = SET_INSERT(&ints, i);
+      ASSERT_EQ(r, 0);
+    }
+    {
+      const int r = DICT_SET(&dict, i, i + 1);
+      ASSERT_EQ(r, 0);
+    }
+  }
+
+  // old tables were queued, so should now be reclaimable
+  ASSERT_GT(sp_reclaim(), (size_t)0);
+
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT(SET_CONTAINS(&ints, i));
+    const int *const v = DICT_GET(&dict, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, i + 1);
+  }
+
+  SET_FREE(&ints);
+  DICT_FREE(&dict);
+
+  // the final tables are only freed on reclamation
+  ASSERT_GT(sp_reclaim(), (size_t)0);
+
+  sp_defer_dtors(false);
+}
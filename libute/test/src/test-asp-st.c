@@ -4,6 +4,9 @@
 /// All content in this file is in the public domain. Use it any way you wish.
 
 #include "test.h"
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <ute/asp.h>
 #include <ute/attr.h>
@@ -102,3 +105,64 @@ TEST("atomic shared pointer counter reallocate, single-threaded") {
   sp_t null = {0};
   sp_store(&ptr, null);
 }
+
+/// number of `count_dtor` calls made so far
+static size_t dtor_calls;
+
+static void count_dtor(void *p UNUSED, void *context UNUSED) { ++dtor_calls; }
+
+/// a shared pointer allocated together with its control block
+TEST("atomic shared pointer from sp_make") {
+  dtor_calls = 0;
+
+  sp_t sp = sp_make(sizeof(long double), alignof(long double), count_dtor,
+                    NULL);
+  ASSERT_NOT_NULL(sp.ptr);
+  ASSERT_EQ((uintptr_t)sp.ptr % alignof(long double), (uintptr_t)0);
+
+  // the value should start zeroed
+  long double *const p = sp.ptr;
+  ASSERT(*p == 0);
+  *p = 42;
+
+  asp_t ptr = 0;
+  sp_store(&ptr, sp_dup(sp));
+  sp_rel(sp);
+  ASSERT_EQ(dtor_calls, (size_t)0);
+
+  {
+    const sp_t sp2 = sp_acq(&ptr);
+    ASSERT(*(long double *)sp2.ptr == 42);
+    sp_rel(sp2);
+  }
+
+  // over-aligned values should also be supported
+  {
+    const sp_t sp3 = sp_make(1, 128, NULL, NULL);
+    ASSERT_NOT_NULL(sp3.ptr);
+    ASSERT_EQ((uintptr_t)sp3.ptr % 128, (uintptr_t)0);
+    sp_rel(sp3);
+  }
+
+  sp_t null = {0};
+  sp_store(&ptr, null);
+  ASSERT_EQ(dtor_calls, (size_t)1);
+}
+
+/// control blocks of released shared pointers should be reused
+TEST("atomic shared pointer control block reuse") {
+  const sp_pool_stats_t before = sp_pool_stats();
+
+  for (int i = 0; i < 100; ++i) {
+    int *const p = malloc(sizeof(*p));
+    ASSERT_NOT_NULL(p);
+    const sp_t sp = sp_new(p, free_, NULL);
+    ASSERT_NOT_NULL(sp.ptr);
+    sp_rel(sp);
+  }
+
+  // all but the first allocation should have been satisfied from the pool
+  const sp_pool_stats_t after = sp_pool_stats();
+  ASSERT_GE(after.hits - before.hits, (size_t)99);
+  ASSERT_LE(after.misses - before.misses, (size_t)1);
+}
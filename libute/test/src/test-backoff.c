@@ -0,0 +1,81 @@
+/// @file
+/// @brief Test backoff.h API under contention
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stddef.h>
+#include <ute/backoff.h>
+#include <ute/set.h>
+
+typedef SET(int) ints_t;
+
+/// how many items each writer inserts
+enum { INSERTED = 2000 };
+
+typedef struct {
+  ints_t *ints;
+  int thread_id;
+} state_t;
+
+static THREAD_RET writer(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  // interleave with the other writers, so we contend on the same slots
+  for (int i = 0; i < INSERTED; ++i) {
+    const int r = SET_INSERT(s->ints, i * 4 + s->thread_id);
+    ASSERT_EQ(r, 0);
+  }
+
+  return 0;
+}
+
+/// run writers contending on a single set
+static void contend(void) {
+  ints_t ints = {0};
+
+  thread_t t[4];
+  state_t st[sizeof(t) / sizeof(t[0])];
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    st[i] = (state_t){.ints = &ints, .thread_id = (int)i};
+    const int r = THREAD_CREATE(&t[i], writer, &st[i]);
+    ASSERT_EQ(r, 0);
+  }
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)(INSERTED * 4));
+
+  SET_FREE(&ints);
+}
+
+/// statistics should only ever grow
+TEST("backoff stats") {
+  const backoff_stats_t before = backoff_stats();
+  contend();
+  const backoff_stats_t after = backoff_stats();
+
+  ASSERT_GE(after.pauses, before.pauses);
+  ASSERT_GE(after.yields, before.yields);
+}
+
+/// a configuration that never yields should be respected
+TEST("backoff without yielding") {
+  backoff_configure((backoff_config_t){.max_shift = 0, .yield = false});
+
+  const backoff_stats_t before = backoff_stats();
+  contend();
+  const backoff_stats_t after = backoff_stats();
+
+  ASSERT_EQ(after.yields, before.yields);
+  ASSERT_GE(after.pauses, before.pauses);
+
+  // restore the default configuration for other tests
+  backoff_configure((backoff_config_t){.max_shift = 6, .yield = true});
+}
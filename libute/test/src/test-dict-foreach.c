@@ -0,0 +1,70 @@
+/// @file
+/// @brief Test of dictionary iteration
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+
+/// how many times each key has been visited
+static size_t seen[1000];
+
+static int see(const void *key, void *value, void *context UNUSED) {
+  const int *const k = key;
+  int *const v = value;
+  if (*k < 0 || (size_t)*k >= sizeof(seen) / sizeof(seen[0]) || *v != *k + 1)
+    return -1;
+  ++seen[*k];
+  return 0;
+}
+
+/// iterating a dictionary should visit each entry once
+TEST("dict foreach") {
+  memset(seen, 0, sizeof(seen));
+  DICT(int, int) ints = {0};
+
+  ASSERT_EQ(DICT_FOREACH(&ints, see, NULL), 0);
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT_EQ(DICT_SET(&ints, i, i + 1), 0);
+  for (int i = 0; i < 1000; i += 2)
+    ASSERT(DICT_REMOVE(&ints, i));
+
+  ASSERT_EQ(DICT_FOREACH(&ints, see, NULL), 0);
+  for (size_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(seen[i], i % 2 != 0 ? 1u : 0u);
+
+  DICT_FREE(&ints);
+}
+
+static int increment(const void *key UNUSED, void *value, void *context) {
+  int *const v = value;
+  const int *const limit = context;
+  ++*v;
+  return *v > *limit ? 1 : 0;
+}
+
+/// the callback should be able to update values and stop iteration
+TEST("dict foreach update") {
+  DICT(int, int) ints = {0};
+
+  for (int i = 0; i < 10; ++i)
+    ASSERT_EQ(DICT_SET(&ints, i, 0), 0);
+
+  int limit = 100;
+  ASSERT_EQ(DICT_FOREACH(&ints, increment, &limit), 0);
+  for (int i = 0; i < 10; ++i) {
+    const int *const v = DICT_GET(&ints, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, 1);
+  }
+
+  limit = 0;
+  ASSERT_EQ(DICT_FOREACH(&ints, increment, &limit), 1);
+
+  DICT_FREE(&ints);
+}
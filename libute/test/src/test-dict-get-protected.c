@@ -0,0 +1,188 @@
+/// @file
+/// @brief Test protected dictionary lookups racing with modifiers
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+#include <ute/hazard.h>
+
+typedef DICT(int, int) ints_t;
+
+/// number of keys readers and writers operate on
+enum { KEYS = 64 };
+
+/// number of rounds of overwrites and removals each writer performs
+enum { ROUNDS = 200 };
+
+typedef struct {
+  ints_t *xs;
+  atomic_bool *done; ///< have writers finished?
+  int thread_id;
+} state_t;
+
+/// a value for a key, which readers can check
+static int make_val(int key, int round) { return round * KEYS + key; }
+
+static THREAD_RET reader(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  do {
+    for (int k = 0; k < KEYS; ++k) {
+      const int *const v = DICT_GET_PROTECTED(s->xs, k, 0);
+
+      // the value may be replaced or removed under us, but should remain
+      // readable and belong to the key we asked for
+      if (v != NULL)
+        ASSERT_EQ(*v % KEYS, k);
+    }
+  } while (!atomic_load(s->done));
+
+  hazard_clear(0);
+  return 0;
+}
+
+static THREAD_RET writer(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (int round = 0; round < ROUNDS; ++round) {
+    for (int k = 0; k < KEYS; ++k) {
+      if ((k + round + s->thread_id) % 5 == 0) {
+        (void)DICT_REMOVE(s->xs, k);
+      } else {
+        const int r = DICT_SET(s->xs, k, make_val(k, round));
+        ASSERT_EQ(r, 0);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/// lookups racing with overwrites, removals, and migrations
+TEST("dict protected lookups during modification") {
+  ints_t xs = {0};
+  atomic_bool done = false;
+
+  thread_t readers[4];
+  thread_t writers[2];
+  state_t rs[sizeof(readers) / sizeof(readers[0])];
+  state_t ws[sizeof(writers) / sizeof(writers[0])];
+
+  for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); ++i) {
+    rs[i] = (state_t){.xs = &xs, .done = &done, .thread_id = (int)i};
+    const int r = THREAD_CREATE(&readers[i], reader, &rs[i]);
+    ASSERT_EQ(r, 0);
+  }
+  for (size_t i = 0; i < sizeof(writers) / sizeof(writers[0]); ++i) {
+    ws[i] = (state_t){.xs = &xs, .done = &done, .thread_id = (int)i};
+    const int r = THREAD_CREATE(&writers[i], writer, &ws[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(writers) / sizeof(writers[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(writers[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+  atomic_store(&done, true);
+  for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(readers[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  DICT_FREE(&xs);
+}
+
+/// a protected value should outlive its removal
+TEST("dict protected lookup across removal") {
+  ints_t xs = {0};
+
+  {
+    const int r = DICT_SET(&xs, 1, 42);
+    ASSERT_EQ(r, 0);
+  }
+
+  const int *const v = DICT_GET_PROTECTED(&xs, 1, 2);
+  ASSERT_NOT_NULL(v);
+  ASSERT_EQ(*v, 42);
+
+  ASSERT(DICT_REMOVE(&xs, 1));
+  ASSERT_NULL(DICT_GET(&xs, 1));
+  hazard_scan();
+  ASSERT_EQ(*v, 42);
+
+  ASSERT_NULL(DICT_GET_PROTECTED(&xs, 1, 2));
+
+  DICT_FREE(&xs);
+}
+
+/// number of values `count_dtor` has been called on
+static size_t destroyed;
+
+static void count_dtor(void *value UNUSED) { ++destroyed; }
+
+/// without protected lookups, replaced values should be destroyed immediately
+TEST("dict value destruction without protected lookups") {
+  DICT(int, int) xs = {.value_dtor = count_dtor};
+  destroyed = 0;
+
+  ASSERT_EQ(DICT_SET(&xs, 1, 42), 0);
+  ASSERT_EQ(DICT_SET(&xs, 1, 43), 0);
+  ASSERT_EQ(destroyed, 1u);
+
+  ASSERT(DICT_REMOVE(&xs, 1));
+  ASSERT_EQ(destroyed, 2u);
+
+  DICT_FREE(&xs);
+}
+
+/// once a protected lookup is made, destruction should wait for protection
+TEST("dict value destruction after protected lookups") {
+  DICT(int, int) xs = {.value_dtor = count_dtor};
+  destroyed = 0;
+
+  ASSERT_EQ(DICT_SET(&xs, 1, 42), 0);
+
+  const int *const v = DICT_GET_PROTECTED(&xs, 1, 0);
+  ASSERT_NOT_NULL(v);
+
+  ASSERT_EQ(DICT_SET(&xs, 1, 43), 0);
+  hazard_scan();
+  ASSERT_EQ(destroyed, 0u);
+  ASSERT_EQ(*v, 42);
+
+  hazard_clear(0);
+  hazard_scan();
+  ASSERT_EQ(destroyed, 1u);
+
+  DICT_FREE(&xs);
+  ASSERT_EQ(destroyed, 2u);
+}
+
+/// protected lookups in a local dictionary are plain lookups
+TEST("dict local protected lookup") {
+  DICT_LOCAL(int, int) xs = {0};
+
+  {
+    const int r = DICT_SET(&xs, 1, 42);
+    ASSERT_EQ(r, 0);
+  }
+
+  const int *const v = DICT_GET_PROTECTED(&xs, 1, 0);
+  ASSERT_NOT_NULL(v);
+  ASSERT_EQ(*v, 42);
+  ASSERT_NULL(DICT_GET_PROTECTED(&xs, 2, 0));
+
+  DICT_FREE(&xs);
+}
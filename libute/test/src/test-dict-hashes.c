@@ -0,0 +1,71 @@
+/// @file
+/// @brief Test dictionary probing in the presence of hash collisions
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+/// a key too wide to be stored inline, so its slot records its hash
+typedef struct {
+  uint64_t lo;
+  uint64_t hi;
+} wide_t;
+
+/// a hash that sends every key to the same bucket with the same hash
+static size_t same_hash(const void *key, size_t size) {
+  (void)key;
+  (void)size;
+  return 42;
+}
+
+/// a hash that sends every key to the same bucket with differing hashes
+static size_t same_bucket_hash(const void *key, size_t size) {
+  (void)size;
+  const wide_t *const k = key;
+  return (size_t)k->lo << 16;
+}
+
+/// exercise a dictionary whose keys are stored with their hashes
+///
+/// @param hash Hash function to use
+static void exercise(size_t (*hash)(const void *, size_t)) {
+  DICT(wide_t, int) wides = {.hash = hash};
+
+  for (int i = 0; i < 100; ++i) {
+    const wide_t k = {.lo = (uint64_t)i, .hi = 1};
+    ASSERT_EQ(DICT_SET(&wides, k, i), 0);
+  }
+  ASSERT_EQ(DICT_SIZE(&wides), 100u);
+
+  for (int i = 0; i < 200; ++i) {
+    const wide_t k = {.lo = (uint64_t)i, .hi = 1};
+    const int *const v = DICT_GET(&wides, k);
+    ASSERT((v != NULL) == (i < 100));
+    if (v != NULL)
+      ASSERT_EQ(*v, i);
+
+    // keys that differ only outside what the hash covers should not match
+    const wide_t other = {.lo = (uint64_t)i, .hi = 2};
+    ASSERT(!DICT_CONTAINS(&wides, other));
+  }
+
+  for (int i = 0; i < 100; i += 2) {
+    const wide_t k = {.lo = (uint64_t)i, .hi = 1};
+    ASSERT(DICT_REMOVE(&wides, k));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const wide_t k = {.lo = (uint64_t)i, .hi = 1};
+    ASSERT(DICT_CONTAINS(&wides, k) == (i % 2 != 0));
+  }
+
+  DICT_FREE(&wides);
+}
+
+TEST("wide key dict, colliding hashes") { exercise(same_hash); }
+
+TEST("wide key dict, colliding buckets") { exercise(same_bucket_hash); }
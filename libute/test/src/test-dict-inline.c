@@ -0,0 +1,227 @@
+/// @file
+/// @brief Test dictionaries whose keys or values are stored inline in slots
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+#include <ute/hazard.h>
+
+/// narrow values should round trip through set, get, and removal
+TEST("dict inline narrow values") {
+  DICT(int, uint8_t) bytes = {0};
+  DICT(int, uint16_t) shorts = {0};
+
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(DICT_SET(&bytes, i, (uint8_t)(i * 7)), 0);
+    ASSERT_EQ(DICT_SET(&shorts, i, (uint16_t)(i * 31)), 0);
+  }
+  ASSERT_EQ(DICT_SIZE(&bytes), 1000u);
+  ASSERT_EQ(DICT_SIZE(&shorts), 1000u);
+
+  for (int i = 0; i < 1000; ++i) {
+    const uint8_t *const b = DICT_GET(&bytes, i);
+    ASSERT_NOT_NULL(b);
+    ASSERT_EQ((unsigned)*b, (unsigned)(uint8_t)(i * 7));
+    const uint16_t *const s = DICT_GET(&shorts, i);
+    ASSERT_NOT_NULL(s);
+    ASSERT_EQ((unsigned)*s, (unsigned)(uint16_t)(i * 31));
+  }
+
+  // a 0 value must be distinguishable from an absent one
+  ASSERT_EQ(DICT_SET(&bytes, 0, 0), 0);
+  {
+    const uint8_t *const b = DICT_GET(&bytes, 0);
+    ASSERT_NOT_NULL(b);
+    ASSERT_EQ((unsigned)*b, 0u);
+  }
+
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT(DICT_REMOVE(&bytes, i));
+    ASSERT(!DICT_CONTAINS(&bytes, i));
+    ASSERT_NULL(DICT_GET(&bytes, i));
+  }
+  ASSERT_EQ(DICT_SIZE(&bytes), 500u);
+
+  DICT_FREE(&shorts);
+  DICT_FREE(&bytes);
+}
+
+/// small aggregates should also be stored inline
+TEST("dict inline struct values") {
+  typedef struct {
+    char c[3];
+  } rgb_t;
+  DICT(int, rgb_t) colours = {0};
+
+  for (int i = 0; i < 100; ++i) {
+    const rgb_t v = {{(char)i, (char)(i + 1), (char)(i + 2)}};
+    ASSERT_EQ(DICT_SET(&colours, i, v), 0);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const rgb_t *const v = DICT_GET(&colours, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(v->c[0], (char)i);
+    ASSERT_EQ(v->c[1], (char)(i + 1));
+    ASSERT_EQ(v->c[2], (char)(i + 2));
+  }
+
+  DICT_FREE(&colours);
+}
+
+/// a protected lookup of an inline value should yield a stable copy
+TEST("dict inline protected lookup") {
+  DICT(int, int) ints = {0};
+
+  ASSERT_EQ(DICT_SET(&ints, 42, 1), 0);
+
+  const int *const v = DICT_GET_PROTECTED(&ints, 42, 0);
+  ASSERT_NOT_NULL(v);
+  ASSERT_EQ(*v, 1);
+
+  // the copy should survive the entry being overwritten and removed
+  ASSERT_EQ(DICT_SET(&ints, 42, 2), 0);
+  ASSERT_EQ(*v, 1);
+  ASSERT(DICT_REMOVE(&ints, 42));
+  ASSERT_EQ(*v, 1);
+
+  // lookups in other slots should not disturb it
+  ASSERT_EQ(DICT_SET(&ints, 43, 3), 0);
+  const int *const w = DICT_GET_PROTECTED(&ints, 43, 1);
+  ASSERT_NOT_NULL(w);
+  ASSERT_EQ(*w, 3);
+  ASSERT_EQ(*v, 1);
+
+  ASSERT_NULL(DICT_GET_PROTECTED(&ints, 42, 0));
+
+  hazard_clear(1);
+  hazard_clear(0);
+  DICT_FREE(&ints);
+}
+
+static int double_it(const void *key UNUSED, void *value,
+                     void *context UNUSED) {
+  int *const v = value;
+  *v *= 2;
+  return 0;
+}
+
+/// updates made through iteration should be written back to the slot
+TEST("dict inline foreach update") {
+  DICT(int, int) ints = {0};
+
+  for (int i = 0; i < 100; ++i)
+    ASSERT_EQ(DICT_SET(&ints, i, i), 0);
+
+  ASSERT_EQ(DICT_FOREACH(&ints, double_it, NULL), 0);
+
+  for (int i = 0; i < 100; ++i) {
+    const int *const v = DICT_GET(&ints, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, 2 * i);
+  }
+
+  DICT_FREE(&ints);
+}
+
+static size_t freed;
+
+static void dtor(void *value) {
+  int **const v = value;
+  free(*v);
+  ++freed;
+}
+
+/// values with a destructor must keep their own storage
+TEST("dict inline ineligible with destructor") {
+  freed = 0;
+  DICT(int, int *) ptrs = {.value_dtor = dtor};
+
+  for (int i = 0; i < 100; ++i) {
+    int *const p = malloc(sizeof(*p));
+    ASSERT_NOT_NULL(p);
+    *p = i;
+    ASSERT_EQ(DICT_SET(&ptrs, i, p), 0);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    int *const *const v = DICT_GET(&ptrs, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(**v, i);
+  }
+
+  ASSERT(DICT_REMOVE(&ptrs, 0));
+  DICT_FREE(&ptrs);
+  ASSERT_EQ(freed, 100u);
+}
+
+/// narrow keys should be distinguished from one another through migrations
+TEST("dict inline narrow keys") {
+  DICT(uint8_t, int) ints = {0};
+
+  for (int i = 0; i < 256; ++i)
+    ASSERT_EQ(DICT_SET(&ints, (uint8_t)i, i), 0);
+  ASSERT_EQ(DICT_SIZE(&ints), 256u);
+
+  for (int i = 0; i < 256; ++i) {
+    const int *const v = DICT_GET(&ints, (uint8_t)i);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, i);
+  }
+
+  // a 0 key must be distinguishable from an empty slot
+  ASSERT(DICT_REMOVE(&ints, 0));
+  ASSERT(!DICT_CONTAINS(&ints, 0));
+  ASSERT_EQ(DICT_SET(&ints, 0, 42), 0);
+  {
+    const int *const v = DICT_GET(&ints, 0);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, 42);
+  }
+  ASSERT_EQ(DICT_SIZE(&ints), 256u);
+
+  DICT_FREE(&ints);
+}
+
+typedef struct {
+  char c[3];
+} tag_t;
+
+static int check_key(const void *key, void *value, void *context) {
+  const tag_t *const k = key;
+  const int *const v = value;
+  size_t *const count = context;
+  if (k->c[0] != (char)*v || k->c[1] != 'x' || k->c[2] != (char)(*v + 1))
+    return -1;
+  ++*count;
+  return 0;
+}
+
+/// iteration should see inline keys as they were inserted
+TEST("dict inline struct keys") {
+  DICT(tag_t, int) tags = {0};
+
+  for (int i = 0; i < 100; ++i) {
+    const tag_t k = {{(char)i, 'x', (char)(i + 1)}};
+    ASSERT_EQ(DICT_SET(&tags, k, i), 0);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const tag_t k = {{(char)i, 'x', (char)(i + 1)}};
+    const int *const v = DICT_GET(&tags, k);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(*v, i);
+  }
+
+  size_t count = 0;
+  ASSERT_EQ(DICT_FOREACH(&tags, check_key, &count), 0);
+  ASSERT_EQ(count, 100u);
+
+  DICT_FREE(&tags);
+}
@@ -0,0 +1,134 @@
+/// @file
+/// @brief Tests of thread-local dictionaries
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ute/attr.h>
+#include <ute/dict.h>
+
+/// some basic operations on a local dictionary
+TEST("local dict basic") {
+  DICT_LOCAL(int, double) d = {0};
+
+  ASSERT_EQ(DICT_SIZE(&d), 0u);
+  ASSERT_NULL(DICT_GET(&d, 42));
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT_EQ(DICT_SET(&d, i, i * 0.5), 0);
+  ASSERT_EQ(DICT_SIZE(&d), 1000u);
+
+  for (int i = 0; i < 1000; ++i) {
+    const double *const v = DICT_GET(&d, i);
+    ASSERT_NOT_NULL(v);
+    ASSERT(*v == i * 0.5);
+  }
+
+  // overwrite an entry
+  ASSERT_EQ(DICT_SET(&d, 10, -1.0), 0);
+  ASSERT_EQ(DICT_SIZE(&d), 1000u);
+  ASSERT(*DICT_GET(&d, 10) == -1.0);
+
+  for (int i = 0; i < 1000; i += 2)
+    ASSERT(DICT_REMOVE(&d, i));
+  ASSERT_EQ(DICT_SIZE(&d), 500u);
+  ASSERT(!DICT_REMOVE(&d, 0));
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT(DICT_CONTAINS(&d, i) == (i % 2 != 0));
+
+  DICT_FREE(&d);
+  ASSERT_EQ(DICT_SIZE(&d), 0u);
+}
+
+static void key_dtor(void *key) {
+  assert(key != NULL);
+
+  char **const k = key;
+  free(*k);
+}
+
+static void value_dtor(void *value) {
+  assert(value != NULL);
+
+  char **const v = value;
+  free(*v);
+}
+
+/// key and value destructors should be called exactly once for each
+TEST("local dict destructors") {
+  DICT_LOCAL(char *, char *) d = {.key_dtor = key_dtor,
+                                  .value_dtor = value_dtor};
+
+  const char *strings[] = {"foo", "bar", "qux", "quux", "corge"};
+
+  char *to_remove = NULL;
+  for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i) {
+    char *const k = strdup(strings[i]);
+    ASSERT_NOT_NULL(k);
+    char *const v = strdup(strings[i]);
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(DICT_SET(&d, k, v), 0);
+    if (i == 0)
+      to_remove = k;
+  }
+
+  ASSERT(DICT_REMOVE(&d, to_remove));
+  ASSERT_EQ(DICT_SIZE(&d), 4u);
+
+  // leak checking confirms free destroys the remaining entries
+  DICT_FREE(&d);
+}
+
+/// overwriting an entry should destroy its old value
+TEST("local dict overwrite") {
+  DICT_LOCAL(int, char *) d = {.value_dtor = value_dtor};
+
+  for (int i = 0; i < 3; ++i) {
+    char *const v = strdup("foo");
+    ASSERT_NOT_NULL(v);
+    ASSERT_EQ(DICT_SET(&d, 42, v), 0);
+  }
+  ASSERT_EQ(DICT_SIZE(&d), 1u);
+
+  DICT_FREE(&d);
+}
+
+static int sum_entry(const void *key, void *value, void *context) {
+  const int *const k = key;
+  const long *const v = value;
+  long *const sum = context;
+  *sum += *k * *v;
+  return 0;
+}
+
+static int stop(const void *key UNUSED, void *value UNUSED,
+                void *context UNUSED) {
+  return 42;
+}
+
+/// iterating a local dictionary should visit every entry
+TEST("local dict foreach") {
+  DICT_LOCAL(int, long) d = {0};
+
+  ASSERT_EQ(DICT_RESERVE(&d, 100), 0);
+
+  long expected = 0;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(DICT_SET(&d, i, (long)i + 1), 0);
+    expected += (long)i * (i + 1);
+  }
+
+  long sum = 0;
+  ASSERT_EQ(DICT_FOREACH(&d, sum_entry, &sum), 0);
+  ASSERT_EQ(sum, expected);
+
+  ASSERT_EQ(DICT_FOREACH(&d, stop, NULL), 42);
+
+  DICT_FREE(&d);
+}
@@ -109,5 +109,8 @@ TEST("int→int dict multithreaded, leave set non-empty") {
     ASSERT_EQ(ret, (THREAD_RET){0});
   }
 
+  // every thread’s entries should be accounted for
+  ASSERT_EQ(DICT_SIZE(&xs), sizeof(t) / sizeof(t[0]) * 10);
+
   DICT_FREE(&xs);
 }
@@ -0,0 +1,60 @@
+/// @file
+/// @brief Test pre-sizing of dictionaries
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/dict.h>
+
+/// reserving in a dictionary should not disturb its contents
+TEST("int→int dict, reserve") {
+  DICT(int, int) ints = {0};
+
+  // reserving in an empty dictionary should allocate it
+  ASSERT_EQ(DICT_RESERVE(&ints, 10), 0);
+  ASSERT_EQ(DICT_SIZE(&ints), 0u);
+
+  for (int i = 0; i < 10; ++i) {
+    const int r = DICT_SET(&ints, i, i + 1);
+    ASSERT_EQ(r, 0);
+  }
+
+  // growing a populated dictionary should retain what is already there
+  ASSERT_EQ(DICT_RESERVE(&ints, 5000), 0);
+  ASSERT_EQ(DICT_SIZE(&ints), 10u);
+
+  for (int i = 10; i < 5000; ++i) {
+    const int r = DICT_SET(&ints, i, i + 1);
+    ASSERT_EQ(r, 0);
+  }
+
+  // asking for less than we have should be a no-op
+  ASSERT_EQ(DICT_RESERVE(&ints, 1), 0);
+
+  ASSERT_EQ(DICT_SIZE(&ints), 5000u);
+  for (int i = 0; i < 5010; ++i) {
+    const int *const v = DICT_GET(&ints, i);
+    if (i < 5000) {
+      ASSERT_NOT_NULL(v);
+      ASSERT_EQ(*v, i + 1);
+    } else {
+      ASSERT_NULL(v);
+    }
+  }
+
+  DICT_FREE(&ints);
+}
+
+/// unreasonably large reservations should fail cleanly
+TEST("int→int dict, reserve too much") {
+  DICT(int, int) ints = {0};
+
+  ASSERT_EQ(DICT_RESERVE(&ints, SIZE_MAX), ENOMEM);
+  ASSERT_EQ(DICT_SET(&ints, 42, 43), 0);
+  ASSERT(DICT_CONTAINS(&ints, 42));
+
+  DICT_FREE(&ints);
+}
@@ -0,0 +1,61 @@
+/// @file
+/// @brief Test dword atomics through their inline definitions
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#define USE_INLINE_ATOMICS 1
+
+#include "test.h"
+#include <stdint.h>
+#include <string.h>
+#include <ute/dword.h>
+
+TEST("dword inline atomics") {
+  atomic_dword_t d = dword_zero();
+
+  dword_atomic_store_lo(&d, 1);
+  dword_atomic_store_hi(&d, 2);
+  ASSERT_EQ(dword_atomic_load_lo(&d), (uintptr_t)1);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)2);
+
+  // a whole-dword load should see both halves
+  const dword_t old = dword_atomic_load(&d);
+  dword_t expected = old;
+  ASSERT(dword_atomic_cas(&d, &expected, dword_zero()));
+  ASSERT_EQ(dword_atomic_load_lo(&d), (uintptr_t)0);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)0);
+
+  // a failing CAS should report the current value
+  ASSERT(!dword_atomic_cas(&d, &expected, old));
+  const dword_t zero = dword_zero();
+  ASSERT(memcmp(&expected, &zero, sizeof(zero)) == 0);
+  ASSERT(dword_atomic_cas_n(&d, zero, old));
+
+  dword_atomic_store(&d, zero);
+  ASSERT_EQ(dword_atomic_load_lo(&d), (uintptr_t)0);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)0);
+}
+
+TEST("dword inline half atomics") {
+  atomic_dword_t d = dword_zero();
+
+  uintptr_t expected = 1;
+  ASSERT(!dword_atomic_cas_lo(&d, &expected, 3));
+  ASSERT_EQ(expected, (uintptr_t)0);
+  ASSERT(dword_atomic_cas_lo(&d, &expected, 3));
+  ASSERT(dword_atomic_cas_n_hi(&d, 0, 4));
+  ASSERT(!dword_atomic_cas_n_hi(&d, 0, 5));
+
+  // exchanging one half should leave the other untouched
+  ASSERT_EQ(dword_atomic_xchg_lo(&d, 5), (uintptr_t)3);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)4);
+  ASSERT_EQ(dword_atomic_xchg_hi(&d, 6), (uintptr_t)4);
+  ASSERT_EQ(dword_atomic_load_lo(&d), (uintptr_t)5);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)6);
+
+  expected = 6;
+  ASSERT(dword_atomic_cas_hi(&d, &expected, 7));
+  ASSERT(dword_atomic_cas_n_lo(&d, 5, 8));
+  ASSERT_EQ(dword_atomic_load_lo(&d), (uintptr_t)8);
+  ASSERT_EQ(dword_atomic_load_hi(&d), (uintptr_t)7);
+}
@@ -0,0 +1,204 @@
+/// @file
+/// @brief Test epoch.h API and lookups that rely on it
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/epoch.h>
+#include <ute/set.h>
+
+typedef SET(int) ints_t;
+
+/// lookups within an explicit guard, across tables being retired
+TEST("epoch guard around lookups") {
+  ints_t ints = {0};
+
+  epoch_enter();
+  epoch_enter();
+
+  // growing the set retires its old tables, which must stay readable to us
+  for (int i = 0; i < 1000; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+    ASSERT(SET_CONTAINS(&ints, i));
+    ASSERT(!SET_CONTAINS(&ints, i + 1));
+  }
+
+  epoch_exit();
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT(SET_CONTAINS(&ints, i));
+
+  epoch_exit();
+
+  // this should reclaim everything, as we have left our guard
+  SET_FREE(&ints);
+}
+
+/// number of destructor calls made so far
+static size_t dtor_calls;
+
+static void count_dtor(void *item) {
+  (void)item;
+  ++dtor_calls;
+}
+
+/// retired boxed tables should still destroy their items by the time the set
+/// is freed
+TEST("epoch guard around boxed lookups") {
+  SET(int) ints = {.dtor = count_dtor};
+  dtor_calls = 0;
+
+  epoch_enter();
+  for (int i = 0; i < 1000; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+    ASSERT(SET_CONTAINS(&ints, i));
+  }
+  for (int i = 0; i < 1000; i += 2)
+    ASSERT(SET_REMOVE(&ints, i));
+  epoch_exit();
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 2 != 0));
+
+  SET_FREE(&ints);
+  ASSERT_EQ(dtor_calls, (size_t)1000);
+}
+
+/// how many items are present before readers start
+enum { PRESENT = 500 };
+
+/// how many items writers insert while readers are running
+enum { INSERTED = 4000 };
+
+typedef struct {
+  ints_t *ints;
+  atomic_bool *done; ///< have writers finished?
+  int thread_id;
+} state_t;
+
+static THREAD_RET reader(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  // repeatedly look up items that are always present, while the set is
+  // migrated out from under us
+  do {
+    for (int i = 0; i < PRESENT; ++i)
+      ASSERT(SET_CONTAINS(s->ints, i));
+    ASSERT(!SET_CONTAINS(s->ints, -1));
+
+    bool found[PRESENT];
+    int items[PRESENT];
+    for (int i = 0; i < PRESENT; ++i)
+      items[i] = i;
+    ASSERT_EQ(SET_CONTAINS_MANY(s->ints, items, PRESENT, found),
+              (size_t)PRESENT);
+  } while (!atomic_load(s->done));
+
+  return 0;
+}
+
+static THREAD_RET writer(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (int i = 0; i < INSERTED; ++i) {
+    const int v = PRESENT + s->thread_id * INSERTED + i;
+    const int r = SET_INSERT(s->ints, v);
+    ASSERT_EQ(r, 0);
+  }
+
+  return 0;
+}
+
+/// lookups racing with migrations
+TEST("epoch lookups during growth") {
+  ints_t ints = {0};
+  atomic_bool done = false;
+
+  for (int i = 0; i < PRESENT; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  thread_t readers[4];
+  thread_t writers[2];
+  state_t rs[sizeof(readers) / sizeof(readers[0])];
+  state_t ws[sizeof(writers) / sizeof(writers[0])];
+
+  for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); ++i) {
+    rs[i] = (state_t){.ints = &ints, .done = &done, .thread_id = (int)i};
+    const int r = THREAD_CREATE(&readers[i], reader, &rs[i]);
+    ASSERT_EQ(r, 0);
+  }
+  for (size_t i = 0; i < sizeof(writers) / sizeof(writers[0]); ++i) {
+    ws[i] = (state_t){.ints = &ints, .done = &done, .thread_id = (int)i};
+    const int r = THREAD_CREATE(&writers[i], writer, &ws[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(writers) / sizeof(writers[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(writers[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+  atomic_store(&done, true);
+  for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(readers[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  const size_t expected =
+      PRESENT + sizeof(writers) / sizeof(writers[0]) * INSERTED;
+  ASSERT_EQ(SET_SIZE(&ints), expected);
+
+  SET_FREE(&ints);
+}
+
+typedef SET(unsigned char) chars_t;
+
+static THREAD_RET char_reader(void *arg) {
+  assert(arg != NULL);
+  chars_t *const chars = arg;
+
+  for (int i = 0; i < 256; ++i)
+    ASSERT(SET_CONTAINS(chars, (unsigned char)i) == (i % 3 == 0));
+
+  return 0;
+}
+
+/// threads that come and go, each entering guards
+TEST("epoch short-lived threads") {
+  chars_t chars = {0};
+
+  for (int i = 0; i < 256; i += 3) {
+    const int r = SET_INSERT(&chars, (unsigned char)i);
+    ASSERT_EQ(r, 0);
+  }
+
+  // run more threads than are live at once, so exited threads’ state is reused
+  for (int round = 0; round < 8; ++round) {
+    thread_t t[4];
+    for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+      const int r = THREAD_CREATE(&t[i], char_reader, &chars);
+      ASSERT_EQ(r, 0);
+    }
+    for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+      THREAD_RET ret = 0;
+      const int r = THREAD_JOIN(t[i], &ret);
+      ASSERT_EQ(r, 0);
+      ASSERT_EQ(ret, (THREAD_RET){0});
+    }
+  }
+
+  SET_FREE(&chars);
+}
@@ -0,0 +1,88 @@
+/// @file
+/// @brief Test of hashing
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/hash.h>
+
+/// the hash of some data should not depend on where it lives in memory
+TEST("hash alignment independence") {
+  unsigned char data[128];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = (unsigned char)(i * 7 + 3);
+
+  for (size_t len = 0; len <= 100; ++len) {
+    const size_t expected = hash(data, len);
+    for (size_t offset = 1; offset < 8; ++offset) {
+      unsigned char copy[sizeof(data) + 8];
+      memcpy(copy + offset, data, len);
+      ASSERT_EQ(hash(copy + offset, len), expected);
+    }
+  }
+}
+
+/// sequential integers should be spread evenly over the low bits of the hash,
+/// which are what sets and dictionaries use to pick a slot
+TEST("hash distribution of sequential integers") {
+  enum { BUCKETS = 1 << 12 };
+  static size_t load[BUCKETS];
+
+  // one trial for each fixed-width size and one for a wider key
+  for (size_t size = 1; size <= 16; size *= 2) {
+    memset(load, 0, sizeof(load));
+    for (uint32_t i = 0; i < BUCKETS; ++i) {
+      unsigned char key[16] = {0};
+      memcpy(key, &i, size < sizeof(i) ? size : sizeof(i));
+      ++load[hash(key, size) % BUCKETS];
+    }
+
+    // with 1-byte keys there are only 256 distinct values
+    const size_t distinct = size == 1 ? 256 : BUCKETS;
+    size_t max = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      if (load[i] > max)
+        max = load[i];
+      if (load[i] > 0)
+        ++used;
+    }
+
+    // a uniform random function would put at most ~8 in any bucket and fill
+    // ~63% of them, so these bounds are generous
+    if (size == 1) {
+      ASSERT_GE(used, distinct / 2);
+    } else {
+      ASSERT_LE(max, 16u);
+      ASSERT_GE(used, distinct / 2);
+    }
+  }
+}
+
+/// flipping any input bit should flip about half the output bits
+TEST("hash avalanche") {
+  for (size_t size = 1; size <= 64; size = size < 8 ? size * 2 : size + 24) {
+    unsigned char key[64];
+    for (size_t i = 0; i < sizeof(key); ++i)
+      key[i] = (unsigned char)(i * 131 + 17);
+
+    const uint64_t base = hash(key, size);
+    size_t flipped = 0;
+    size_t trials = 0;
+    for (size_t bit = 0; bit < size * 8; ++bit) {
+      key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+      const uint64_t h = hash(key, size);
+      key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+      flipped += (size_t)__builtin_popcountll(base ^ h);
+      ++trials;
+    }
+
+    // average number of output bits flipped, out of the bits in a `size_t`
+    const size_t bits = sizeof(size_t) * 8;
+    ASSERT_GE(flipped, trials * bits * 3 / 8);
+    ASSERT_LE(flipped, trials * bits * 5 / 8);
+  }
+}
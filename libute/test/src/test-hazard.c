@@ -0,0 +1,111 @@
+/// @file
+/// @brief Test hazard.h API
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/hazard.h>
+
+/// number of destructor calls made so far
+static atomic_size_t dtor_calls;
+
+static void count_free(void *ptr, void *context) {
+  (void)context;
+  free(ptr);
+  (void)atomic_fetch_add(&dtor_calls, 1);
+}
+
+/// a protected pointer should survive retirement until it is unprotected
+TEST("hazard protect and retire") {
+  atomic_store(&dtor_calls, 0);
+
+  int *const p = malloc(sizeof(*p));
+  ASSERT_NOT_NULL(p);
+  *p = 42;
+  void *_Atomic src = p;
+
+  int *const q = hazard_protect(0, &src);
+  ASSERT(q == p);
+
+  // unlink and retire it, as a writer would
+  atomic_store(&src, NULL);
+  hazard_retire(p, count_free, NULL);
+  hazard_scan();
+  ASSERT_EQ(atomic_load(&dtor_calls), (size_t)0);
+
+  // it should still be readable
+  ASSERT_EQ(*q, 42);
+
+  hazard_clear(0);
+  hazard_scan();
+  ASSERT_EQ(atomic_load(&dtor_calls), (size_t)1);
+}
+
+/// protecting a null pointer should be harmless
+TEST("hazard protect null") {
+  void *_Atomic src = NULL;
+  void *const p = hazard_protect(HAZARD_SLOTS - 1, &src);
+  ASSERT_NULL(p);
+  hazard_clear(HAZARD_SLOTS - 1);
+}
+
+/// unprotected retirements should be reclaimed in batches
+TEST("hazard retire many") {
+  atomic_store(&dtor_calls, 0);
+
+  for (size_t i = 0; i < 1000; ++i) {
+    int *const p = malloc(sizeof(*p));
+    ASSERT_NOT_NULL(p);
+    hazard_retire(p, count_free, NULL);
+  }
+
+  // retirement should have reclaimed some of these along the way
+  ASSERT_GT(atomic_load(&dtor_calls), (size_t)0);
+
+  hazard_scan();
+  ASSERT_EQ(atomic_load(&dtor_calls), (size_t)1000);
+}
+
+static THREAD_RET retirer(void *arg) {
+  assert(arg != NULL);
+  void *_Atomic *const src = arg;
+
+  void *const p = atomic_exchange(src, NULL);
+  ASSERT_NOT_NULL(p);
+  hazard_retire(p, count_free, NULL);
+
+  return 0;
+}
+
+/// allocations retired by a thread that exits should be adopted by others
+TEST("hazard retire from exiting thread") {
+  atomic_store(&dtor_calls, 0);
+
+  int *const p = malloc(sizeof(*p));
+  ASSERT_NOT_NULL(p);
+  void *_Atomic src = p;
+
+  // protect the allocation, so the retiring thread cannot free it
+  ASSERT(hazard_protect(1, &src) == p);
+
+  thread_t t;
+  {
+    const int r = THREAD_CREATE(&t, retirer, (void *)&src);
+    ASSERT_EQ(r, 0);
+  }
+  {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t, &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+  ASSERT_EQ(atomic_load(&dtor_calls), (size_t)0);
+
+  hazard_clear(1);
+  hazard_scan();
+  ASSERT_EQ(atomic_load(&dtor_calls), (size_t)1);
+}
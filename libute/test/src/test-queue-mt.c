@@ -0,0 +1,125 @@
+/// @file
+/// @brief Test multi-threaded queue operations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <ute/queue.h>
+
+/// number of producers and of consumers
+enum { THREADS = 4 };
+
+/// items each producer pushes
+enum { ITEMS = 20000 };
+
+/// maximum batch size used by batched producers and consumers
+enum { BATCH = 7 };
+
+typedef struct {
+  QUEUE(size_t) queue;
+  atomic_size_t popped;               ///< total items popped so far
+  atomic_uchar seen[THREADS * ITEMS]; ///< how many times each item was popped
+} shared_t;
+
+typedef struct {
+  size_t thread_id;
+  bool batched; ///< use batched operations?
+  shared_t *shared;
+} state_t;
+
+static THREAD_RET producer(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  size_t next = s->thread_id * ITEMS;
+  const size_t end = next + ITEMS;
+  while (next < end) {
+    if (s->batched) {
+      size_t items[BATCH];
+      size_t n = 0;
+      for (; n < BATCH && next + n < end; ++n)
+        items[n] = next + n;
+      next += QUEUE_PUSH_MANY(&s->shared->queue, items, n);
+    } else {
+      const int r = QUEUE_PUSH(&s->shared->queue, next);
+      if (r == 0) {
+        ++next;
+      } else {
+        ASSERT_EQ(r, EAGAIN);
+      }
+    }
+  }
+
+  return 0;
+}
+
+static THREAD_RET consumer(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+  shared_t *const sh = s->shared;
+
+  while (atomic_load(&sh->popped) < THREADS * ITEMS) {
+    size_t items[BATCH];
+    size_t n = 0;
+    if (s->batched) {
+      n = QUEUE_POP_MANY(&sh->queue, items, BATCH);
+    } else if (QUEUE_POP(&sh->queue, &items[0])) {
+      n = 1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      ASSERT(items[i] < THREADS * ITEMS);
+      // each item should be popped exactly once
+      ASSERT_EQ(atomic_fetch_add(&sh->seen[items[i]], 1), 0);
+    }
+    (void)atomic_fetch_add(&sh->popped, n);
+  }
+
+  return 0;
+}
+
+/// run producers and consumers against a small queue
+static void run(bool batched) {
+  shared_t *const sh = calloc(1, sizeof(*sh));
+  ASSERT(sh != NULL);
+  sh->queue.capacity = 64;
+
+  thread_t t[THREADS * 2];
+  state_t s[THREADS * 2];
+
+  for (size_t i = 0; i < THREADS * 2; ++i)
+    s[i] = (state_t){.thread_id = i % THREADS,
+                     // mix batched and unbatched operations
+                     .batched = batched && i % 2 == 0,
+                     .shared = sh};
+
+  for (size_t i = 0; i < THREADS * 2; ++i) {
+    const int r =
+        THREAD_CREATE(&t[i], i < THREADS ? producer : consumer, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < THREADS * 2; ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  for (size_t i = 0; i < THREADS * ITEMS; ++i)
+    ASSERT_EQ(atomic_load(&sh->seen[i]), 1);
+  ASSERT_EQ(QUEUE_SIZE(&sh->queue), 0u);
+
+  QUEUE_FREE(&sh->queue);
+  free(sh);
+}
+
+TEST("queue, multi-threaded") { run(false); }
+
+TEST("queue, multi-threaded batched") { run(true); }
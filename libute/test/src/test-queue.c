@@ -0,0 +1,167 @@
+/// @file
+/// @brief Test single-threaded queue operations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <errno.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/queue.h>
+
+/// an unallocated queue should be empty
+TEST("queue, empty") {
+  QUEUE(int) ints = {.capacity = 4};
+
+  ASSERT_EQ(QUEUE_SIZE(&ints), 0u);
+
+  int x = 42;
+  ASSERT(!QUEUE_POP(&ints, &x));
+  ASSERT_EQ(x, 42);
+
+  int xs[4] = {0};
+  ASSERT_EQ(QUEUE_POP_MANY(&ints, xs, 4), 0u);
+
+  QUEUE_FREE(&ints);
+}
+
+/// pushing to a queue with no capacity should fail
+TEST("queue, zero capacity") {
+  QUEUE(int) ints = {0};
+
+  ASSERT_EQ(QUEUE_PUSH(&ints, 1), EINVAL);
+
+  const int xs[] = {1, 2};
+  ASSERT_EQ(QUEUE_PUSH_MANY(&ints, xs, 2), 0u);
+
+  QUEUE_FREE(&ints);
+}
+
+/// items should come out in the order they went in
+TEST("queue, FIFO order") {
+  QUEUE(int) ints = {.capacity = 8};
+
+  // go round the ring several times
+  for (int lap = 0; lap < 10; ++lap) {
+    for (int i = 0; i < 5; ++i) {
+      const int r = QUEUE_PUSH(&ints, lap * 10 + i);
+      ASSERT_EQ(r, 0);
+    }
+    ASSERT_EQ(QUEUE_SIZE(&ints), 5u);
+
+    for (int i = 0; i < 5; ++i) {
+      int x = -1;
+      ASSERT(QUEUE_POP(&ints, &x));
+      ASSERT_EQ(x, lap * 10 + i);
+    }
+    ASSERT_EQ(QUEUE_SIZE(&ints), 0u);
+  }
+
+  QUEUE_FREE(&ints);
+}
+
+/// a queue should hold exactly its capacity, rounded up to a power of 2
+TEST("queue, full") {
+  QUEUE(long) longs = {.capacity = 5};
+
+  for (long i = 0; i < 8; ++i) {
+    const int r = QUEUE_PUSH(&longs, i);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(QUEUE_SIZE(&longs), 8u);
+
+  ASSERT_EQ(QUEUE_PUSH(&longs, 8), EAGAIN);
+
+  // making room should allow pushing again
+  long x = -1;
+  ASSERT(QUEUE_POP(&longs, &x));
+  ASSERT_EQ(x, 0);
+  ASSERT_EQ(QUEUE_PUSH(&longs, 8), 0);
+  ASSERT_EQ(QUEUE_PUSH(&longs, 9), EAGAIN);
+
+  for (long i = 1; i < 9; ++i) {
+    ASSERT(QUEUE_POP(&longs, &x));
+    ASSERT_EQ(x, i);
+  }
+  ASSERT(!QUEUE_POP(&longs, &x));
+
+  QUEUE_FREE(&longs);
+}
+
+/// batched operations should do as much as they can
+TEST("queue, batched operations") {
+  QUEUE(unsigned) us = {.capacity = 16};
+
+  unsigned in[20];
+  for (size_t i = 0; i < sizeof(in) / sizeof(in[0]); ++i)
+    in[i] = (unsigned)i;
+
+  ASSERT_EQ(QUEUE_PUSH_MANY(&us, in, 10), 10u);
+  ASSERT_EQ(QUEUE_SIZE(&us), 10u);
+
+  // only some of these should fit
+  ASSERT_EQ(QUEUE_PUSH_MANY(&us, in + 10, 10), 6u);
+  ASSERT_EQ(QUEUE_SIZE(&us), 16u);
+  ASSERT_EQ(QUEUE_PUSH_MANY(&us, in + 16, 4), 0u);
+
+  unsigned out[20] = {0};
+  ASSERT_EQ(QUEUE_POP_MANY(&us, out, 3), 3u);
+  for (size_t i = 0; i < 3; ++i)
+    ASSERT_EQ(out[i], in[i]);
+
+  // asking for more than is there should return what there is
+  ASSERT_EQ(QUEUE_POP_MANY(&us, out + 3, 20), 13u);
+  for (size_t i = 0; i < 16; ++i)
+    ASSERT_EQ(out[i], in[i]);
+  ASSERT_EQ(QUEUE_SIZE(&us), 0u);
+
+  // batches should work across the wrap around of the ring
+  ASSERT_EQ(QUEUE_PUSH_MANY(&us, in, 12), 12u);
+  ASSERT_EQ(QUEUE_POP_MANY(&us, out, 12), 12u);
+  for (size_t i = 0; i < 12; ++i)
+    ASSERT_EQ(out[i], in[i]);
+
+  QUEUE_FREE(&us);
+}
+
+/// a type with stricter alignment than a queue’s internal bookkeeping
+typedef struct {
+  alignas(64) uint64_t value;
+  char tag;
+} aligned_t;
+
+TEST("queue, over-aligned items") {
+  QUEUE(aligned_t) as = {.capacity = 4};
+
+  for (uint64_t i = 0; i < 4; ++i) {
+    const int r = QUEUE_PUSH(&as, ((aligned_t){.value = i, .tag = 'a'}));
+    ASSERT_EQ(r, 0);
+  }
+
+  for (uint64_t i = 0; i < 4; ++i) {
+    aligned_t a = {0};
+    ASSERT(QUEUE_POP(&as, &a));
+    ASSERT_EQ(a.value, i);
+    ASSERT_EQ(a.tag, 'a');
+  }
+
+  QUEUE_FREE(&as);
+}
+
+/// a freed queue should be reusable
+TEST("queue, reuse after free") {
+  QUEUE(bool) bools = {.capacity = 2};
+
+  ASSERT_EQ(QUEUE_PUSH(&bools, true), 0);
+  QUEUE_FREE(&bools);
+  ASSERT_EQ(QUEUE_SIZE(&bools), 0u);
+
+  ASSERT_EQ(QUEUE_PUSH(&bools, false), 0);
+  bool b = true;
+  ASSERT(QUEUE_POP(&bools, &b));
+  ASSERT(!b);
+
+  QUEUE_FREE(&bools);
+}
@@ -0,0 +1,165 @@
+/// @file
+/// @brief Test reclamation of removed set items
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+/// steady-state churn on an unboxed set
+TEST("int set, churn") {
+  SET(int) ints = {0};
+
+  // keep a sliding window of 100 items in the set
+  for (int i = 0; i < 100000; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+    if (i >= 100)
+      ASSERT(SET_REMOVE(&ints, i - 100));
+  }
+
+  ASSERT_EQ(SET_SIZE(&ints), 100u);
+  for (int i = 100000 - 200; i < 100000; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i >= 100000 - 100));
+
+  SET_FREE(&ints);
+}
+
+/// steady-state churn on a double-word set
+TEST("long set, churn") {
+  SET(unsigned long) longs = {0};
+
+  // keep a sliding window of 100 items in the set
+  for (unsigned long i = 0; i < 100000; ++i) {
+    const int r = SET_INSERT(&longs, i);
+    ASSERT_EQ(r, 0);
+    if (i >= 100)
+      ASSERT(SET_REMOVE(&longs, i - 100));
+  }
+
+  ASSERT_EQ(SET_SIZE(&longs), 100u);
+  for (unsigned long i = 100000 - 200; i < 100000; ++i)
+    ASSERT(SET_CONTAINS(&longs, i) == (i >= 100000 - 100));
+
+  SET_FREE(&longs);
+}
+
+/// explicit compaction should preserve a set’s contents
+TEST("int set, compact") {
+  SET(int) ints = {0};
+
+  // compacting an empty set should be a no-op
+  ASSERT_EQ(SET_COMPACT(&ints), 0);
+
+  for (int i = 0; i < 1000; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+  for (int i = 0; i < 1000; i += 3)
+    ASSERT(SET_REMOVE(&ints, i));
+
+  ASSERT_EQ(SET_COMPACT(&ints), 0);
+
+  ASSERT_EQ(SET_SIZE(&ints), 666u);
+  for (int i = 0; i < 1000; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 3 != 0));
+
+  // a second compaction should have nothing to do
+  ASSERT_EQ(SET_COMPACT(&ints), 0);
+  ASSERT_EQ(SET_SIZE(&ints), 666u);
+
+  SET_FREE(&ints);
+}
+
+/// explicit compaction should preserve a double-word set’s contents
+TEST("long set, compact") {
+  SET(unsigned long) longs = {0};
+
+  for (unsigned long i = 0; i < 1000; ++i) {
+    const int r = SET_INSERT(&longs, i);
+    ASSERT_EQ(r, 0);
+  }
+  for (unsigned long i = 0; i < 1000; i += 3)
+    ASSERT(SET_REMOVE(&longs, i));
+
+  ASSERT_EQ(SET_COMPACT(&longs), 0);
+
+  ASSERT_EQ(SET_SIZE(&longs), 666u);
+  for (unsigned long i = 0; i < 1000; ++i)
+    ASSERT(SET_CONTAINS(&longs, i) == (i % 3 != 0));
+
+  SET_FREE(&longs);
+}
+
+/// compacting sets that have no tombstones to reclaim
+TEST("bool and short set, compact") {
+  SET(bool) bools = {0};
+  ASSERT_EQ(SET_INSERT(&bools, true), 0);
+  ASSERT_EQ(SET_COMPACT(&bools), 0);
+  ASSERT(SET_CONTAINS(&bools, true));
+  SET_FREE(&bools);
+
+  SET(short) shorts = {0};
+  ASSERT_EQ(SET_INSERT(&shorts, 42), 0);
+  ASSERT_EQ(SET_COMPACT(&shorts), 0);
+  ASSERT(SET_CONTAINS(&shorts, 42));
+  SET_FREE(&shorts);
+}
+
+typedef SET(int) ints_t;
+
+typedef struct {
+  ints_t *ints;
+  int thread_id;
+} state_t;
+
+static THREAD_RET entry(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  // churn through items unique to this thread, racing other threads’
+  // compactions
+  for (int i = 0; i < 5000; ++i) {
+    const int v = s->thread_id * 5000 + i;
+    const int r = SET_INSERT(s->ints, v);
+    ASSERT_EQ(r, 0);
+    ASSERT(SET_CONTAINS(s->ints, v));
+    if (i >= 10)
+      ASSERT(SET_REMOVE(s->ints, v - 10));
+    if (i % 1000 == 0)
+      ASSERT_EQ(SET_COMPACT(s->ints), 0);
+  }
+
+  for (int i = 5000 - 10; i < 5000; ++i)
+    ASSERT(SET_CONTAINS(s->ints, s->thread_id * 5000 + i));
+
+  return 0;
+}
+
+/// steady-state churn from multiple threads
+TEST("int set, churn multithreaded") {
+  ints_t ints = {0};
+  thread_t t[8];
+  state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(s) / sizeof(s[0]); ++i)
+    s[i] = (state_t){.ints = &ints, .thread_id = (int)i};
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    const int r = THREAD_CREATE(&t[i], entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  ASSERT_EQ(SET_SIZE(&ints), sizeof(t) / sizeof(t[0]) * 10);
+  SET_FREE(&ints);
+}
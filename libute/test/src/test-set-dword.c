@@ -0,0 +1,96 @@
+/// @file
+/// @brief Test cases for sets of word-sized items
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+/// a set of pointers, including the null pointer
+TEST("pointer set") {
+  int xs[100];
+  SET(void *) ptrs = {0};
+
+  // an all-zeroes item should be distinguishable from an empty slot
+  ASSERT(!SET_CONTAINS(&ptrs, NULL));
+  ASSERT_EQ(SET_INSERT(&ptrs, NULL), 0);
+  ASSERT(SET_CONTAINS(&ptrs, NULL));
+
+  for (size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); ++i) {
+    const int r = SET_INSERT(&ptrs, &xs[i]);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(SET_SIZE(&ptrs), sizeof(xs) / sizeof(xs[0]) + 1);
+
+  for (size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); i += 2)
+    ASSERT(SET_REMOVE(&ptrs, &xs[i]));
+  ASSERT(SET_REMOVE(&ptrs, NULL));
+  ASSERT(!SET_REMOVE(&ptrs, NULL));
+
+  for (size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); ++i)
+    ASSERT(SET_CONTAINS(&ptrs, &xs[i]) == (i % 2 != 0));
+  ASSERT(!SET_CONTAINS(&ptrs, NULL));
+
+  SET_FREE(&ptrs);
+}
+
+/// a set of floating-point values
+TEST("double set") {
+  SET(double) ds = {0};
+
+  for (int i = -500; i < 500; ++i) {
+    const int r = SET_INSERT(&ds, i * 0.5);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(SET_SIZE(&ds), 1000u);
+
+  for (int i = -1000; i < 1000; ++i) {
+    const bool present = SET_CONTAINS(&ds, i * 0.5);
+    ASSERT(present == (i >= -500 && i < 500));
+  }
+
+  SET_FREE(&ds);
+}
+
+/// hash only the low half of an item
+static size_t low_hash(const void *item, size_t size) {
+  ASSERT_EQ(size, sizeof(uint64_t));
+  const uint64_t *const x = item;
+  return (size_t)(uint32_t)*x;
+}
+
+/// compare only the low halves of items
+static bool low_eq(const void *a, const void *b, size_t size) {
+  ASSERT_EQ(size, sizeof(uint64_t));
+  const uint64_t *const x = a;
+  const uint64_t *const y = b;
+  return (uint32_t)*x == (uint32_t)*y;
+}
+
+/// user-supplied hashing and comparison should be respected
+TEST("uint64_t set, custom comparator") {
+  SET(uint64_t) xs = {.hash = low_hash, .eq = low_eq};
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    const int r = SET_INSERT(&xs, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  // items differing only in their upper halves should be considered equal,
+  // including after the set has been migrated
+  for (uint64_t i = 0; i < 1000; ++i) {
+    bool exists = false;
+    const int r = SET_INSERT(&xs, i | (UINT64_C(1) << 40), &exists);
+    ASSERT_EQ(r, 0);
+    ASSERT(exists);
+  }
+  ASSERT_EQ(SET_SIZE(&xs), 1000u);
+
+  ASSERT(SET_REMOVE(&xs, UINT64_C(42) | (UINT64_C(1) << 50)));
+  ASSERT(!SET_CONTAINS(&xs, UINT64_C(42)));
+
+  SET_FREE(&xs);
+}
@@ -0,0 +1,227 @@
+/// @file
+/// @brief Test of set iteration
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+/// how many times each item has been visited, indexed by item value
+static size_t seen[1000];
+
+static int see_bool(const void *item, void *context UNUSED) {
+  const bool *const b = item;
+  ++seen[*b];
+  return 0;
+}
+
+static int see_char(const void *item, void *context UNUSED) {
+  const unsigned char *const c = item;
+  ++seen[*c];
+  return 0;
+}
+
+static int see_int(const void *item, void *context UNUSED) {
+  const int *const i = item;
+  assert(*i >= 0 && (size_t)*i < sizeof(seen) / sizeof(seen[0]));
+  ++seen[*i];
+  return 0;
+}
+
+static int see_long(const void *item, void *context UNUSED) {
+  const long *const l = item;
+  assert(*l >= 0 && (size_t)*l < sizeof(seen) / sizeof(seen[0]));
+  ++seen[*l];
+  return 0;
+}
+
+/// a type large enough to need boxing
+struct big {
+  int key;
+  char padding[60];
+};
+
+static int see_big(const void *item, void *context UNUSED) {
+  const struct big *const b = item;
+  assert(b->key >= 0 && (size_t)b->key < sizeof(seen) / sizeof(seen[0]));
+  ++seen[b->key];
+  return 0;
+}
+
+/// iterating an inline set should visit each item once
+TEST("bool set foreach") {
+  memset(seen, 0, sizeof(seen));
+  SET(bool) bools = {0};
+
+  ASSERT_EQ(SET_FOREACH(&bools, see_bool, NULL), 0);
+  ASSERT_EQ(seen[false], 0u);
+  ASSERT_EQ(seen[true], 0u);
+
+  ASSERT_EQ(SET_INSERT(&bools, true), 0);
+  ASSERT_EQ(SET_FOREACH(&bools, see_bool, NULL), 0);
+  ASSERT_EQ(seen[false], 0u);
+  ASSERT_EQ(seen[true], 1u);
+
+  SET_FREE(&bools);
+}
+
+/// iterating a bitset-backed set should visit each item once
+TEST("char set foreach") {
+  memset(seen, 0, sizeof(seen));
+  SET(unsigned char) chars = {0};
+
+  for (int i = 0; i < 256; i += 3)
+    ASSERT_EQ(SET_INSERT(&chars, (unsigned char)i), 0);
+
+  ASSERT_EQ(SET_FOREACH(&chars, see_char, NULL), 0);
+  for (size_t i = 0; i < 256; ++i)
+    ASSERT_EQ(seen[i], i % 3 == 0 ? 1u : 0u);
+
+  SET_FREE(&chars);
+}
+
+/// iterating an unboxed set should visit each item once
+TEST("int set foreach") {
+  memset(seen, 0, sizeof(seen));
+  SET(int) ints = {0};
+
+  ASSERT_EQ(SET_FOREACH(&ints, see_int, NULL), 0);
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT_EQ(SET_INSERT(&ints, i), 0);
+  for (int i = 0; i < 1000; i += 2)
+    ASSERT(SET_REMOVE(&ints, i));
+
+  ASSERT_EQ(SET_FOREACH(&ints, see_int, NULL), 0);
+  for (size_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(seen[i], i % 2 != 0 ? 1u : 0u);
+
+  SET_FREE(&ints);
+}
+
+/// iterating a double-word set should visit each item once
+TEST("long set foreach") {
+  memset(seen, 0, sizeof(seen));
+  SET(long) longs = {0};
+
+  for (long i = 0; i < 1000; ++i)
+    ASSERT_EQ(SET_INSERT(&longs, i), 0);
+  for (long i = 0; i < 1000; i += 2)
+    ASSERT(SET_REMOVE(&longs, i));
+
+  ASSERT_EQ(SET_FOREACH(&longs, see_long, NULL), 0);
+  for (size_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(seen[i], i % 2 != 0 ? 1u : 0u);
+
+  SET_FREE(&longs);
+}
+
+/// iterating a boxed set should visit each item once
+TEST("struct set foreach") {
+  memset(seen, 0, sizeof(seen));
+  SET(struct big) bigs = {0};
+
+  for (int i = 0; i < 1000; ++i)
+    ASSERT_EQ(SET_INSERT(&bigs, (struct big){.key = i}), 0);
+  for (int i = 0; i < 1000; i += 2)
+    ASSERT(SET_REMOVE(&bigs, (struct big){.key = i}));
+
+  ASSERT_EQ(SET_FOREACH(&bigs, see_big, NULL), 0);
+  for (size_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(seen[i], i % 2 != 0 ? 1u : 0u);
+
+  SET_FREE(&bigs);
+}
+
+static int stop_at(const void *item, void *context) {
+  const int *const i = item;
+  const int *const limit = context;
+  ++seen[*i];
+  return *i >= *limit ? *i : 0;
+}
+
+/// a non-zero callback return should stop iteration
+TEST("set foreach early exit") {
+  memset(seen, 0, sizeof(seen));
+  SET(int) ints = {0};
+
+  for (int i = 1; i < 100; ++i)
+    ASSERT_EQ(SET_INSERT(&ints, i), 0);
+
+  int limit = 50;
+  const int r = SET_FOREACH(&ints, stop_at, &limit);
+  ASSERT_GE(r, limit);
+
+  // nothing should have been visited after the callback asked to stop
+  size_t stops = 0;
+  for (size_t i = (size_t)limit; i < 100; ++i)
+    stops += seen[i];
+  ASSERT_EQ(stops, 1u);
+
+  SET_FREE(&ints);
+}
+
+typedef SET(int) ints_t;
+
+/// how many items are inserted before iteration begins
+enum { STABLE = 500 };
+
+static int count_stable(const void *item, void *context) {
+  const int *const i = item;
+  size_t *const count = context;
+  if (*i < STABLE)
+    ++*count;
+  return 0;
+}
+
+static THREAD_RET churn_entry(void *arg) {
+  assert(arg != NULL);
+  ints_t *const ints = arg;
+
+  // insert and remove items beyond the stable range, forcing migrations
+  for (int round = 0; round < 10; ++round) {
+    for (int i = STABLE; i < STABLE + 2000; ++i) {
+      const int r = SET_INSERT(ints, i);
+      ASSERT_EQ(r, 0);
+    }
+    for (int i = STABLE; i < STABLE + 2000; ++i)
+      ASSERT(SET_REMOVE(ints, i));
+  }
+
+  return 0;
+}
+
+/// iteration racing with modification should see every untouched item
+TEST("set foreach multithreaded") {
+  ints_t ints = {0};
+
+  for (int i = 0; i < STABLE; ++i)
+    ASSERT_EQ(SET_INSERT(&ints, i), 0);
+
+  thread_t t;
+  {
+    const int r = THREAD_CREATE(&t, churn_entry, &ints);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    size_t count = 0;
+    ASSERT_EQ(SET_FOREACH(&ints, count_stable, &count), 0);
+    ASSERT_EQ(count, (size_t)STABLE);
+  }
+
+  {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t, &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  SET_FREE(&ints);
+}
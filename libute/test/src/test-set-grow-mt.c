@@ -0,0 +1,154 @@
+/// @file
+/// @brief Test multiple threads growing a set concurrently
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+/// how many items each thread inserts
+enum { ITEMS_PER_THREAD = 2000 };
+
+typedef SET(int) ints_t;
+
+typedef struct {
+  ints_t *ints;
+  int thread_id;
+} ints_state_t;
+
+static THREAD_RET int_entry(void *arg) {
+  assert(arg != NULL);
+  ints_state_t *const s = arg;
+
+  for (int i = 0; i < ITEMS_PER_THREAD; ++i) {
+    const int v = s->thread_id * ITEMS_PER_THREAD + i;
+    const int r = SET_INSERT(s->ints, v);
+    ASSERT_EQ(r, 0);
+  }
+
+  // nothing we inserted should have been lost in a migration
+  for (int i = 0; i < ITEMS_PER_THREAD; ++i) {
+    const int v = s->thread_id * ITEMS_PER_THREAD + i;
+    ASSERT(SET_CONTAINS(s->ints, v));
+  }
+
+  // remove half our items, racing with other threads’ migrations
+  for (int i = 0; i < ITEMS_PER_THREAD; i += 2) {
+    const int v = s->thread_id * ITEMS_PER_THREAD + i;
+    ASSERT(SET_REMOVE(s->ints, v));
+  }
+
+  return 0;
+}
+
+/// many threads inserting into an unboxed set, forcing repeated expansion
+TEST("int set multithreaded growth") {
+
+  ints_t ints = {0};
+  thread_t t[8];
+  ints_state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(s) / sizeof(s[0]); ++i)
+    s[i] = (ints_state_t){.ints = &ints, .thread_id = (int)i};
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    const int r = THREAD_CREATE(&t[i], int_entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  const size_t expected = sizeof(t) / sizeof(t[0]) * ITEMS_PER_THREAD / 2;
+  ASSERT_EQ(SET_SIZE(&ints), expected);
+
+  for (int i = 0; i < (int)(sizeof(t) / sizeof(t[0])) * ITEMS_PER_THREAD; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 2 != 0));
+
+  SET_FREE(&ints);
+}
+
+typedef SET(unsigned long) longs_t;
+
+typedef struct {
+  longs_t *longs;
+  unsigned long thread_id;
+} longs_state_t;
+
+static THREAD_RET long_entry(void *arg) {
+  assert(arg != NULL);
+  longs_state_t *const s = arg;
+
+  for (unsigned long i = 0; i < ITEMS_PER_THREAD; ++i) {
+    const unsigned long v = s->thread_id * ITEMS_PER_THREAD + i;
+    const int r = SET_INSERT(s->longs, v);
+    ASSERT_EQ(r, 0);
+  }
+
+  // nothing we inserted should have been lost in a migration
+  for (unsigned long i = 0; i < ITEMS_PER_THREAD; ++i) {
+    const unsigned long v = s->thread_id * ITEMS_PER_THREAD + i;
+    ASSERT(SET_CONTAINS(s->longs, v));
+  }
+
+  // remove half our items, racing with other threads’ migrations
+  for (unsigned long i = 0; i < ITEMS_PER_THREAD; i += 2) {
+    const unsigned long v = s->thread_id * ITEMS_PER_THREAD + i;
+    ASSERT(SET_REMOVE(s->longs, v));
+  }
+
+  return 0;
+}
+
+/// a destructor that does nothing
+///
+/// Sets with a destructor use the boxed implementation, so this lets us test
+/// that with the same item type.
+static void nop(void *item) { (void)item; }
+
+/// many threads inserting into a set, forcing repeated expansion
+///
+/// @param dtor Optional destructor for the set
+static void long_growth(void (*dtor)(void *)) {
+
+  longs_t longs = {.dtor = dtor};
+  thread_t t[8];
+  longs_state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(s) / sizeof(s[0]); ++i)
+    s[i] = (longs_state_t){.longs = &longs, .thread_id = i};
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    const int r = THREAD_CREATE(&t[i], long_entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  const size_t expected = sizeof(t) / sizeof(t[0]) * ITEMS_PER_THREAD / 2;
+  ASSERT_EQ(SET_SIZE(&longs), expected);
+
+  for (unsigned long i = 0; i < sizeof(t) / sizeof(t[0]) * ITEMS_PER_THREAD;
+       ++i)
+    ASSERT(SET_CONTAINS(&longs, i) == (i % 2 != 0));
+
+  SET_FREE(&longs);
+}
+
+/// many threads inserting into a double-word set, forcing repeated expansion
+TEST("long set multithreaded growth") { long_growth(NULL); }
+
+/// many threads inserting into a boxed set, forcing repeated expansion
+TEST("long set with destructor multithreaded growth") { long_growth(nop); }
@@ -0,0 +1,136 @@
+/// @file
+/// @brief Test the sizing of set backing storage as it grows
+///
+/// The capacity of a set is not directly visible, but each migration into new
+/// storage rehashes every item in the set. By counting calls to a user-supplied
+/// hasher, we can see how many items a set held each time it grew and so infer
+/// how much its capacity grew by.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+/// number of insertions to make into each set
+enum { N = 100000 };
+
+/// number of times `count_hash` has been called
+static size_t hashes;
+
+/// FNV-1a hash that counts how often it is called
+static size_t count_hash(const void *item, size_t size) {
+  ++hashes;
+  const unsigned char *const p = item;
+  uint64_t h = UINT64_C(14695981039346656037);
+  for (size_t i = 0; i < size; ++i) {
+    h ^= p[i];
+    h *= UINT64_C(1099511628211);
+  }
+  return (size_t)h;
+}
+
+/// number of items a set held when it last grew
+static size_t last;
+
+/// note the hashing done by a single insertion
+///
+/// @param before Value of `hashes` before the insertion
+static void observe(size_t before) {
+  // anything beyond the hash of the inserted item was a migration
+  const size_t migrated = hashes - before - 1;
+  if (migrated == 0)
+    return;
+
+  // the small tables a set starts with round their load factor coarsely, so
+  // only judge growth once the set is large enough for it to be regular
+  if (last >= 16) {
+    // each growth should double the set’s capacity, and so the number of items
+    // it takes to fill it
+    ASSERT_GE(migrated * 2, last * 3);
+    ASSERT_LE(migrated * 2, last * 5);
+  }
+  last = migrated;
+}
+
+/// the storage of an unboxed set should double each time it grows
+TEST("int set, grow") {
+  SET(int) ints = {.hash = count_hash};
+  hashes = 0;
+  last = 0;
+
+  for (int i = 0; i < N; ++i) {
+    const size_t before = hashes;
+    ASSERT_EQ(SET_INSERT(&ints, i), 0);
+    observe(before);
+  }
+
+  // the set should have last grown recently enough that it is not left sparse
+  ASSERT_GT(last * 5, (size_t)N * 2);
+  ASSERT_LE(last, (size_t)N);
+
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)N);
+  SET_FREE(&ints);
+}
+
+/// the storage of a double-word set should double each time it grows
+TEST("long set, grow") {
+  SET(unsigned long) longs = {.hash = count_hash};
+  hashes = 0;
+  last = 0;
+
+  for (unsigned long i = 0; i < N; ++i) {
+    const size_t before = hashes;
+    ASSERT_EQ(SET_INSERT(&longs, i), 0);
+    observe(before);
+  }
+
+  ASSERT_GT(last * 5, (size_t)N * 2);
+  ASSERT_LE(last, (size_t)N);
+
+  ASSERT_EQ(SET_SIZE(&longs), (size_t)N);
+  SET_FREE(&longs);
+}
+
+/// the storage of a boxed set should double each time it grows
+TEST("struct set, grow") {
+  typedef struct {
+    uint64_t x[3];
+  } triple_t;
+  SET(triple_t) triples = {.hash = count_hash};
+  hashes = 0;
+  last = 0;
+
+  for (uint64_t i = 0; i < N; ++i) {
+    const triple_t t = {{i, i, i}};
+    const size_t before = hashes;
+    ASSERT_EQ(SET_INSERT(&triples, t), 0);
+    observe(before);
+  }
+
+  ASSERT_GT(last * 5, (size_t)N * 2);
+  ASSERT_LE(last, (size_t)N);
+
+  ASSERT_EQ(SET_SIZE(&triples), (size_t)N);
+  SET_FREE(&triples);
+}
+
+/// the storage of a thread-local set should double each time it grows
+TEST("local int set, grow") {
+  SET_LOCAL(int) ints = {.hash = count_hash};
+  hashes = 0;
+  last = 0;
+
+  for (int i = 0; i < N; ++i) {
+    const size_t before = hashes;
+    ASSERT_EQ(SET_INSERT(&ints, i), 0);
+    observe(before);
+  }
+
+  ASSERT_GT(last * 5, (size_t)N * 2);
+  ASSERT_LE(last, (size_t)N);
+
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)N);
+  SET_FREE(&ints);
+}
@@ -0,0 +1,205 @@
+/// @file
+/// @brief Tests of thread-local sets
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ute/attr.h>
+#include <ute/set.h>
+
+/// freeing an empty local set should be OK and should not leak memory
+TEST("empty local set lifecycle") {
+  SET_LOCAL(int) ints = {0};
+  ASSERT_EQ(SET_SIZE(&ints), 0u);
+  ASSERT(!SET_CONTAINS(&ints, 42));
+  ASSERT(!SET_REMOVE(&ints, 42));
+  SET_FREE(&ints);
+}
+
+/// a local set of a type with few values should still be stored inline
+TEST("local bool set") {
+  SET_LOCAL(bool) bools = {0};
+
+  ASSERT_EQ(SET_INSERT(&bools, true), 0);
+  ASSERT(SET_CONTAINS(&bools, true));
+  ASSERT(!SET_CONTAINS(&bools, false));
+  ASSERT_EQ(SET_SIZE(&bools), 1u);
+  ASSERT(SET_REMOVE(&bools, true));
+  ASSERT_EQ(SET_SIZE(&bools), 0u);
+
+  SET_FREE(&bools);
+}
+
+/// a local set of small items should be backed by a bitset
+TEST("local short set") {
+  SET_LOCAL(short) shorts = {0};
+
+  for (short i = -100; i < 100; i += 2) {
+    bool exists;
+    ASSERT_EQ(SET_INSERT(&shorts, i, &exists), 0);
+    ASSERT(!exists);
+  }
+  ASSERT_EQ(SET_SIZE(&shorts), 100u);
+
+  for (short i = -100; i < 100; ++i)
+    ASSERT(SET_CONTAINS(&shorts, i) == (i % 2 == 0));
+
+  {
+    bool exists;
+    ASSERT_EQ(SET_INSERT(&shorts, 0, &exists), 0);
+    ASSERT(exists);
+  }
+
+  for (short i = -100; i < 100; i += 4)
+    ASSERT(SET_REMOVE(&shorts, i));
+  ASSERT_EQ(SET_SIZE(&shorts), 50u);
+
+  SET_FREE(&shorts);
+  ASSERT_EQ(SET_SIZE(&shorts), 0u);
+}
+
+static int sum_int(const void *item, void *context) {
+  const int *const i = item;
+  long *const sum = context;
+  *sum += *i;
+  return 0;
+}
+
+/// a local set of word-sized items should support every set operation
+TEST("local int set") {
+  SET_LOCAL(int) ints = {0};
+
+  enum { N = 10000 };
+
+  for (int i = 0; i < N; ++i) {
+    bool exists;
+    ASSERT_EQ(SET_INSERT(&ints, i, &exists), 0);
+    ASSERT(!exists);
+    ASSERT_EQ(SET_SIZE(&ints), (size_t)i + 1);
+  }
+
+  // remove the odd numbers, leaving tombstones behind
+  for (int i = 1; i < N; i += 2)
+    ASSERT(SET_REMOVE(&ints, i));
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)N / 2);
+
+  for (int i = 0; i < N; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 2 == 0));
+
+  ASSERT_EQ(SET_COMPACT(&ints), 0);
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)N / 2);
+
+  {
+    const int items[] = {0, 1, 2, 3, N};
+    bool found[sizeof(items) / sizeof(items[0])];
+    const size_t count = SET_CONTAINS_MANY(
+        &ints, items, sizeof(items) / sizeof(items[0]), found);
+    ASSERT_EQ(count, 2u);
+    ASSERT(found[0]);
+    ASSERT(!found[1]);
+    ASSERT(found[2]);
+    ASSERT(!found[3]);
+    ASSERT(!found[4]);
+  }
+
+  {
+    int items[] = {1, 2, 3};
+    bool exists[sizeof(items) / sizeof(items[0])];
+    ASSERT_EQ(SET_INSERT_MANY(&ints, items, sizeof(items) / sizeof(items[0]),
+                              exists),
+              0);
+    ASSERT(!exists[0]);
+    ASSERT(exists[1]);
+    ASSERT(!exists[2]);
+  }
+
+  long sum = 0;
+  ASSERT_EQ(SET_FOREACH(&ints, sum_int, &sum), 0);
+  long expected = 1 + 3;
+  for (int i = 0; i < N; i += 2)
+    expected += i;
+  ASSERT_EQ(sum, expected);
+
+  SET_FREE(&ints);
+}
+
+/// a local set should honour a reservation
+TEST("local set reserve") {
+  SET_LOCAL(uint64_t) u64s = {0};
+
+  ASSERT_EQ(SET_RESERVE(&u64s, 1000), 0);
+  for (uint64_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(SET_INSERT(&u64s, i * UINT64_C(0x100000001)), 0);
+  ASSERT_EQ(SET_SIZE(&u64s), 1000u);
+
+  SET_FREE(&u64s);
+}
+
+/// a type too large for any concurrent unboxed implementation
+struct big {
+  int key;
+  char padding[60];
+};
+
+static size_t big_dtor_calls;
+
+static void big_dtor(void *item UNUSED) { ++big_dtor_calls; }
+
+/// items of any size should be stored directly and destroyed exactly once
+TEST("local set of large items") {
+  big_dtor_calls = 0;
+  SET_LOCAL(struct big) bigs = {.dtor = big_dtor};
+
+  for (int i = 0; i < 100; ++i) {
+    struct big b = {.key = i};
+    ASSERT_EQ(SET_INSERT(&bigs, b), 0);
+  }
+  ASSERT_EQ(SET_SIZE(&bigs), 100u);
+  ASSERT_EQ(big_dtor_calls, 0u);
+
+  // re-inserting consumes the duplicate
+  {
+    struct big b = {.key = 42};
+    bool exists;
+    ASSERT_EQ(SET_INSERT(&bigs, b, &exists), 0);
+    ASSERT(exists);
+    ASSERT_EQ(big_dtor_calls, 1u);
+  }
+
+  {
+    struct big b = {.key = 7};
+    ASSERT(SET_REMOVE(&bigs, b));
+    ASSERT_EQ(big_dtor_calls, 2u);
+    ASSERT(!SET_CONTAINS(&bigs, b));
+  }
+
+  SET_FREE(&bigs);
+  ASSERT_EQ(big_dtor_calls, 101u);
+}
+
+/// an over-aligned type
+struct over_aligned {
+  alignas(64) int key;
+};
+
+/// over-aligned items should be stored at their required alignment
+static int check_alignment(const void *item, void *context UNUSED) {
+  return (uintptr_t)item % 64 == 0 ? 0 : 1;
+}
+
+TEST("local set of over-aligned items") {
+  SET_LOCAL(struct over_aligned) items = {0};
+
+  for (int i = 0; i < 100; ++i) {
+    struct over_aligned o = {.key = i};
+    ASSERT_EQ(SET_INSERT(&items, o), 0);
+  }
+  ASSERT_EQ(SET_FOREACH(&items, check_alignment, NULL), 0);
+
+  SET_FREE(&items);
+}
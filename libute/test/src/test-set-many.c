@@ -0,0 +1,210 @@
+/// @file
+/// @brief Test batched set operations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ute/set.h>
+
+/// batched operations on an inline set
+TEST("bool set, batched operations") {
+  SET(bool) bools = {0};
+
+  bool items[] = {true, true};
+  bool exists[sizeof(items) / sizeof(items[0])] = {0};
+  const int r = SET_INSERT_MANY(&bools, items, 2, exists);
+  ASSERT_EQ(r, 0);
+  ASSERT(!exists[0]);
+  ASSERT(exists[1]);
+
+  const bool seek[] = {false, true};
+  bool found[sizeof(seek) / sizeof(seek[0])] = {0};
+  ASSERT_EQ(SET_CONTAINS_MANY(&bools, seek, 2, found), 1u);
+  ASSERT(!found[0]);
+  ASSERT(found[1]);
+
+  SET_FREE(&bools);
+}
+
+/// batched operations on a bitset-backed set
+TEST("short set, batched operations") {
+  SET(unsigned short) shorts = {0};
+
+  unsigned short items[100];
+  for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); ++i)
+    items[i] = (unsigned short)(i * 3);
+  const int r = SET_INSERT_MANY(&shorts, items, 100);
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(SET_SIZE(&shorts), 100u);
+
+  unsigned short seek[300];
+  for (size_t i = 0; i < sizeof(seek) / sizeof(seek[0]); ++i)
+    seek[i] = (unsigned short)i;
+  bool found[sizeof(seek) / sizeof(seek[0])] = {0};
+  ASSERT_EQ(SET_CONTAINS_MANY(&shorts, seek, 300, found), 100u);
+  for (size_t i = 0; i < sizeof(seek) / sizeof(seek[0]); ++i)
+    ASSERT(found[i] == (i % 3 == 0));
+
+  SET_FREE(&shorts);
+}
+
+/// batched operations on an unboxed set, large enough to expand mid-batch
+TEST("int set, batched operations") {
+  SET(int) ints = {0};
+
+  enum { N = 1000 };
+
+  // insert even numbers, with some duplicates
+  int items[N];
+  for (int i = 0; i < N; ++i)
+    items[i] = i / 2 * 2;
+  bool exists[N] = {0};
+  const int r = SET_INSERT_MANY(&ints, items, N, exists);
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(SET_SIZE(&ints), (size_t)N / 2);
+  for (int i = 0; i < N; ++i)
+    ASSERT(exists[i] == (i % 2 != 0));
+
+  int seek[N];
+  for (int i = 0; i < N; ++i)
+    seek[i] = i;
+  bool found[N] = {0};
+  ASSERT_EQ(SET_CONTAINS_MANY(&ints, seek, N, found), (size_t)N / 2);
+  for (int i = 0; i < N; ++i)
+    ASSERT(found[i] == (i % 2 == 0));
+
+  SET_FREE(&ints);
+}
+
+/// batched lookup in an empty set
+TEST("int set, batched lookup while empty") {
+  SET(int) ints = {0};
+
+  const int seek[] = {1, 2, 3};
+  ASSERT_EQ(SET_CONTAINS_MANY(&ints, seek, 3), 0u);
+
+  SET_FREE(&ints);
+}
+
+/// batched operations on a double-word set, large enough to expand mid-batch
+TEST("long set, batched operations") {
+  SET(unsigned long) longs = {0};
+
+  enum { N = 1000 };
+
+  unsigned long items[N];
+  for (size_t i = 0; i < N; ++i)
+    items[i] = i / 2 * 2;
+  bool exists[N] = {0};
+  const int r = SET_INSERT_MANY(&longs, items, N, exists);
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(SET_SIZE(&longs), (size_t)N / 2);
+  for (size_t i = 0; i < N; ++i)
+    ASSERT(exists[i] == (i % 2 != 0));
+
+  unsigned long seek[N];
+  for (size_t i = 0; i < N; ++i)
+    seek[i] = i;
+  bool found[N] = {0};
+  ASSERT_EQ(SET_CONTAINS_MANY(&longs, seek, N, found), (size_t)N / 2);
+  for (size_t i = 0; i < N; ++i)
+    ASSERT(found[i] == (i % 2 == 0));
+
+  SET_FREE(&longs);
+}
+
+struct foo {
+  char *payload;
+};
+
+static size_t foo_hash(const void *foo, size_t size) {
+  (void)size;
+  const struct foo *const f = foo;
+  return (size_t)f->payload[0];
+}
+
+static bool foo_eq(const void *a, const void *b, size_t size) {
+  (void)size;
+  const struct foo *const x = a;
+  const struct foo *const y = b;
+  return strcmp(x->payload, y->payload) == 0;
+}
+
+static void foo_dtor(void *foo) {
+  struct foo *const f = foo;
+  free(f->payload);
+}
+
+/// does `SET_INSERT_MANY` consume items, including duplicates?
+TEST("set with user destructor, batched operations") {
+  SET(struct foo) foos = {.hash = foo_hash, .eq = foo_eq, .dtor = foo_dtor};
+
+  struct foo fs[20] = {0};
+  for (size_t i = 0; i < sizeof(fs) / sizeof(fs[0]); ++i) {
+    const char c = 'a' + (char)(i / 2);
+    fs[i] = (struct foo){.payload = strdup((char[]){c, '\0'})};
+    ASSERT_NOT_NULL(fs[i].payload);
+  }
+  const int r = SET_INSERT_MANY(&foos, fs, sizeof(fs) / sizeof(fs[0]));
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(SET_SIZE(&foos), sizeof(fs) / sizeof(fs[0]) / 2);
+
+  struct foo seek = {.payload = (char[]){'c', '\0'}};
+  ASSERT_EQ(SET_CONTAINS_MANY(&foos, &seek, 1), 1u);
+
+  SET_FREE(&foos);
+}
+
+typedef SET(int) ints_t;
+
+typedef struct {
+  ints_t *ints;
+  int thread_id;
+} state_t;
+
+static THREAD_RET entry(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  enum { N = 500 };
+
+  int items[N];
+  for (int i = 0; i < N; ++i)
+    items[i] = s->thread_id * N + i;
+  const int r = SET_INSERT_MANY(s->ints, items, N);
+  ASSERT_EQ(r, 0);
+
+  ASSERT_EQ(SET_CONTAINS_MANY(s->ints, items, N), (size_t)N);
+
+  return 0;
+}
+
+/// batched insertions racing one another’s expansions
+TEST("int set, batched operations multithreaded") {
+  ints_t ints = {0};
+  thread_t t[8];
+  state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(s) / sizeof(s[0]); ++i)
+    s[i] = (state_t){.ints = &ints, .thread_id = (int)i};
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    const int r = THREAD_CREATE(&t[i], entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  ASSERT_EQ(SET_SIZE(&ints), sizeof(t) / sizeof(t[0]) * 500);
+  SET_FREE(&ints);
+}
@@ -0,0 +1,90 @@
+/// @file
+/// @brief Test pre-sizing of sets
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+/// reserving in an unboxed set should not disturb its contents
+TEST("int set, reserve") {
+  SET(int) ints = {0};
+
+  // reserving in an empty set should allocate it
+  ASSERT_EQ(SET_RESERVE(&ints, 10), 0);
+  ASSERT_EQ(SET_SIZE(&ints), 0u);
+
+  for (int i = 0; i < 10; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  // growing a populated set should retain what is already there
+  ASSERT_EQ(SET_RESERVE(&ints, 10000), 0);
+  ASSERT_EQ(SET_SIZE(&ints), 10u);
+
+  for (int i = 10; i < 10000; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  // asking for less than we have should be a no-op
+  ASSERT_EQ(SET_RESERVE(&ints, 1), 0);
+
+  ASSERT_EQ(SET_SIZE(&ints), 10000u);
+  for (int i = 0; i < 10010; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i < 10000));
+
+  SET_FREE(&ints);
+}
+
+/// reserving in a double-word set should not disturb its contents
+TEST("long set, reserve") {
+  SET(unsigned long) longs = {0};
+
+  for (unsigned long i = 0; i < 10; ++i) {
+    const int r = SET_INSERT(&longs, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  ASSERT_EQ(SET_RESERVE(&longs, 10000), 0);
+  ASSERT_EQ(SET_SIZE(&longs), 10u);
+
+  for (unsigned long i = 10; i < 10000; ++i) {
+    const int r = SET_INSERT(&longs, i);
+    ASSERT_EQ(r, 0);
+  }
+
+  ASSERT_EQ(SET_SIZE(&longs), 10000u);
+  for (unsigned long i = 0; i < 10010; ++i)
+    ASSERT(SET_CONTAINS(&longs, i) == (i < 10000));
+
+  SET_FREE(&longs);
+}
+
+/// fixed-size sets should accept reservations without complaint
+TEST("bool set, reserve") {
+  SET(bool) bools = {0};
+
+  ASSERT_EQ(SET_RESERVE(&bools, 1000), 0);
+  ASSERT_EQ(SET_INSERT(&bools, true), 0);
+  ASSERT(SET_CONTAINS(&bools, true));
+  ASSERT(!SET_CONTAINS(&bools, false));
+
+  SET_FREE(&bools);
+}
+
+/// unreasonably large reservations should fail cleanly
+TEST("int set, reserve too much") {
+  SET(int) ints = {0};
+
+  ASSERT_EQ(SET_RESERVE(&ints, SIZE_MAX), ENOMEM);
+  ASSERT_EQ(SET_INSERT(&ints, 42), 0);
+  ASSERT(SET_CONTAINS(&ints, 42));
+
+  SET_FREE(&ints);
+}
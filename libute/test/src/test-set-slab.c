@@ -0,0 +1,114 @@
+/// @file
+/// @brief Test recycling of boxed set item storage
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/set.h>
+
+/// how many items each thread churns through
+enum { ITEMS_PER_THREAD = 2000 };
+
+/// a type large enough to need boxing
+struct big {
+  int key;
+  char padding[60];
+};
+
+/// number of items destroyed
+static atomic_size_t destroyed;
+
+static void dtor(void *item) {
+  assert(item != NULL);
+  (void)item;
+  (void)atomic_fetch_add_explicit(&destroyed, 1, memory_order_relaxed);
+}
+
+typedef SET(struct big) bigs_t;
+
+/// repeatedly filling and emptying a set should reuse item storage correctly
+TEST("boxed set item churn") {
+  atomic_store(&destroyed, 0);
+  bigs_t bigs = {.dtor = dtor};
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      const int r = SET_INSERT(&bigs, (struct big){.key = round * 100 + i});
+      ASSERT_EQ(r, 0);
+    }
+    ASSERT_EQ(SET_SIZE(&bigs), 100u);
+
+    for (int i = 0; i < 100; ++i)
+      ASSERT(SET_CONTAINS(&bigs, (struct big){.key = round * 100 + i}));
+
+    for (int i = 0; i < 100; ++i) {
+      // a recycled block should never leave a stale copy of an earlier item
+      ASSERT(!SET_CONTAINS(&bigs, (struct big){.key = (round - 1) * 100 + i}));
+      ASSERT(SET_REMOVE(&bigs, (struct big){.key = round * 100 + i}));
+    }
+    ASSERT_EQ(SET_SIZE(&bigs), 0u);
+  }
+
+  SET_FREE(&bigs);
+
+  // every inserted item should have been destroyed exactly once
+  ASSERT_EQ(atomic_load(&destroyed), 10u * 100);
+}
+
+typedef struct {
+  bigs_t *bigs;
+  int thread_id;
+} bigs_state_t;
+
+static THREAD_RET big_entry(void *arg) {
+  assert(arg != NULL);
+  bigs_state_t *const s = arg;
+
+  for (int i = 0; i < ITEMS_PER_THREAD; ++i) {
+    const struct big v = {.key = s->thread_id * ITEMS_PER_THREAD + i};
+    const int r = SET_INSERT(s->bigs, v);
+    ASSERT_EQ(r, 0);
+
+    // remove every other item straight away, so its storage is recycled while
+    // other threads are allocating
+    if (i % 2 == 0)
+      ASSERT(SET_REMOVE(s->bigs, v));
+  }
+
+  return 0;
+}
+
+/// many threads allocating and freeing items from the same set
+TEST("boxed set multithreaded item churn") {
+  atomic_store(&destroyed, 0);
+  bigs_t bigs = {.dtor = dtor};
+  thread_t t[8];
+  bigs_state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(s) / sizeof(s[0]); ++i)
+    s[i] = (bigs_state_t){.bigs = &bigs, .thread_id = (int)i};
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    const int r = THREAD_CREATE(&t[i], big_entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  const size_t expected = sizeof(t) / sizeof(t[0]) * ITEMS_PER_THREAD / 2;
+  ASSERT_EQ(SET_SIZE(&bigs), expected);
+
+  for (int i = 0; i < (int)(sizeof(t) / sizeof(t[0])) * ITEMS_PER_THREAD; ++i)
+    ASSERT(SET_CONTAINS(&bigs, (struct big){.key = i}) == (i % 2 != 0));
+
+  SET_FREE(&bigs);
+}
@@ -0,0 +1,68 @@
+/// @file
+/// @brief Test set probing in the presence of hash tag collisions
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/set.h>
+
+/// a hash that sends every item to the same bucket with the same tag
+static size_t same_hash(const void *item, size_t size) {
+  (void)item;
+  (void)size;
+  return 42;
+}
+
+/// a hash that sends every item to the same bucket with differing tags
+static size_t same_bucket_hash(const void *item, size_t size) {
+  (void)size;
+  const int i = *(const int *)item;
+  return ((size_t)i << (sizeof(size_t) * CHAR_BIT - 7)) | 42;
+}
+
+/// exercise a set whose items all share a hash tag
+TEST("int set, colliding tags") {
+  SET(int) ints = {.hash = same_hash};
+
+  for (int i = 0; i < 100; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(SET_SIZE(&ints), 100u);
+
+  for (int i = 0; i < 200; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i < 100));
+
+  for (int i = 0; i < 100; i += 2)
+    ASSERT(SET_REMOVE(&ints, i));
+
+  for (int i = 0; i < 100; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 2 != 0));
+
+  SET_FREE(&ints);
+}
+
+/// exercise a set whose items all share a bucket, but not a hash tag
+TEST("int set, colliding buckets") {
+  SET(int) ints = {.hash = same_bucket_hash};
+
+  for (int i = 0; i < 100; ++i) {
+    const int r = SET_INSERT(&ints, i);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(SET_SIZE(&ints), 100u);
+
+  for (int i = 0; i < 200; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i < 100));
+
+  for (int i = 0; i < 100; i += 2)
+    ASSERT(SET_REMOVE(&ints, i));
+
+  for (int i = 0; i < 100; ++i)
+    ASSERT(SET_CONTAINS(&ints, i) == (i % 2 != 0));
+
+  SET_FREE(&ints);
+}
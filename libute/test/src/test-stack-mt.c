@@ -0,0 +1,131 @@
+/// @file
+/// @brief Multi-threaded tests of stacks
+///
+/// These tests have many threads repeatedly pop items from a small shared
+/// stack and push them back. Items are recycled quickly, so a stack without
+/// protection against the ABA problem would be likely to hand the same item to
+/// two threads at once or lose items.
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ute/stack.h>
+
+/// number of threads to run
+enum { THREADS = 16 };
+
+/// number of items shared among the threads
+enum { NODES = 8 };
+
+/// rounds of popping and pushing per thread
+enum { ITERATIONS = 20000 };
+
+typedef struct node {
+  struct node *link;  ///< reserved for use by the stack
+  atomic_size_t user; ///< 1 + ID of the thread holding this, or 0 if none
+} node_t;
+
+typedef STACK(node_t) node_stack_t;
+
+typedef struct {
+  size_t thread_id;
+  node_stack_t *stack;
+} state_t;
+
+/// take ownership of an item, checking no one else has it
+static void claim(node_t *n, size_t thread_id) {
+  const size_t prev = atomic_exchange(&n->user, thread_id + 1);
+  ASSERT_EQ(prev, 0u);
+}
+
+/// give up ownership of an item, checking no one else took it meanwhile
+static void unclaim(node_t *n, size_t thread_id) {
+  const size_t prev = atomic_exchange(&n->user, 0);
+  ASSERT_EQ(prev, thread_id + 1);
+}
+
+static THREAD_RET entry(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+
+    // pop a couple of items, if available
+    node_t *a = STACK_POP(s->stack);
+    node_t *b = STACK_POP(s->stack);
+    if (a != NULL)
+      claim(a, s->thread_id);
+    if (b != NULL)
+      claim(b, s->thread_id);
+
+    // push them back, as a chain if we got two
+    if (a != NULL)
+      unclaim(a, s->thread_id);
+    if (b != NULL)
+      unclaim(b, s->thread_id);
+    if (a != NULL && b != NULL) {
+      STACK_SET_NEXT(s->stack, a, b);
+      STACK_PUSH_CHAIN(s->stack, a, b);
+    } else if (a != NULL) {
+      STACK_PUSH(s->stack, a);
+    } else if (b != NULL) {
+      STACK_PUSH(s->stack, b);
+    }
+
+    // occasionally take everything and put it back
+    if (i % 64 == s->thread_id) {
+      node_t *first = STACK_POP_ALL(s->stack);
+      node_t *last = NULL;
+      for (node_t *n = first; n != NULL; n = STACK_NEXT(s->stack, n)) {
+        claim(n, s->thread_id);
+        last = n;
+      }
+      for (node_t *n = first; n != NULL; n = STACK_NEXT(s->stack, n))
+        unclaim(n, s->thread_id);
+      if (first != NULL)
+        STACK_PUSH_CHAIN(s->stack, first, last);
+    }
+  }
+
+  return 0;
+}
+
+TEST("stack, multi-threaded") {
+  node_stack_t stack = {0};
+  node_t nodes[NODES] = {0};
+
+  for (size_t i = 0; i < NODES; ++i)
+    STACK_PUSH(&stack, &nodes[i]);
+
+  thread_t t[THREADS];
+  state_t s[sizeof(t) / sizeof(t[0])];
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    s[i] = (state_t){.thread_id = i, .stack = &stack};
+    const int r = THREAD_CREATE(&t[i], entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+
+  // every item should be back on the stack exactly once
+  bool seen[NODES] = {0};
+  for (size_t i = 0; i < NODES; ++i) {
+    node_t *const n = STACK_POP(&stack);
+    ASSERT_NOT_NULL(n);
+    ASSERT(n >= nodes && n < nodes + NODES);
+    ASSERT(!seen[n - nodes]);
+    seen[n - nodes] = true;
+    ASSERT_EQ(atomic_load(&n->user), 0u);
+  }
+  ASSERT_NULL(STACK_POP(&stack));
+}
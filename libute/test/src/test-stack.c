@@ -0,0 +1,79 @@
+/// @file
+/// @brief Test single-threaded stack operations
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stddef.h>
+#include <ute/stack.h>
+
+typedef struct node {
+  struct node *link; ///< reserved for use by the stack
+  int value;
+} node_t;
+
+/// a zero-initialised stack should be empty
+TEST("stack, empty") {
+  STACK(node_t) nodes = {0};
+
+  ASSERT_NULL(STACK_POP(&nodes));
+  ASSERT_NULL(STACK_POP_ALL(&nodes));
+}
+
+/// items should come out in the reverse order they went in
+TEST("stack, LIFO order") {
+  STACK(node_t) nodes = {0};
+  node_t n[10] = {0};
+
+  for (int i = 0; i < 10; ++i) {
+    n[i].value = i;
+    STACK_PUSH(&nodes, &n[i]);
+  }
+
+  for (int i = 9; i >= 0; --i) {
+    node_t *const p = STACK_POP(&nodes);
+    ASSERT_EQ((void *)p, (void *)&n[i]);
+    ASSERT_EQ(p->value, i);
+  }
+  ASSERT_NULL(STACK_POP(&nodes));
+
+  // items should be reusable after being popped
+  STACK_PUSH(&nodes, &n[3]);
+  ASSERT_EQ((void *)STACK_POP(&nodes), (void *)&n[3]);
+  ASSERT_NULL(STACK_POP(&nodes));
+}
+
+/// a pushed chain should come out in the order it was linked
+TEST("stack, push chain") {
+  STACK(node_t) nodes = {0};
+  node_t n[5] = {0};
+
+  STACK_PUSH(&nodes, &n[4]);
+
+  for (size_t i = 0; i + 1 < 4; ++i)
+    STACK_SET_NEXT(&nodes, &n[i], &n[i + 1]);
+  STACK_PUSH_CHAIN(&nodes, &n[0], &n[3]);
+
+  for (size_t i = 0; i < 5; ++i)
+    ASSERT_EQ((void *)STACK_POP(&nodes), (void *)&n[i]);
+  ASSERT_NULL(STACK_POP(&nodes));
+}
+
+/// popping everything should return a walkable chain
+TEST("stack, pop all") {
+  STACK(node_t) nodes = {0};
+  node_t n[6] = {0};
+
+  for (size_t i = 0; i < 6; ++i)
+    STACK_PUSH(&nodes, &n[i]);
+
+  node_t *p = STACK_POP_ALL(&nodes);
+  for (size_t i = 6; i > 0; --i) {
+    ASSERT_EQ((void *)p, (void *)&n[i - 1]);
+    p = STACK_NEXT(&nodes, p);
+  }
+  ASSERT_NULL(p);
+
+  ASSERT_NULL(STACK_POP(&nodes));
+  ASSERT_NULL(STACK_POP_ALL(&nodes));
+}
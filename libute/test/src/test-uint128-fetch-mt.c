@@ -0,0 +1,152 @@
+/// @file
+/// @brief Test multi-threaded read-modify-write of 128-bit unsigned integers
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ute/int128.h>
+
+/// number of threads to run
+enum { THREADS = 16 };
+
+/// operations per thread
+enum { ITERATIONS = 10000 };
+
+typedef struct {
+  size_t thread_id;
+  uint128_t *target;
+} state_t;
+
+/// run `THREADS` copies of a thread entry point against a shared target
+static void run(THREAD_RET (*entry)(void *), uint128_t *target) {
+  thread_t t[THREADS];
+  state_t s[THREADS];
+
+  for (size_t i = 0; i < THREADS; ++i)
+    s[i] = (state_t){.thread_id = i, .target = target};
+
+  for (size_t i = 0; i < THREADS; ++i) {
+    const int r = THREAD_CREATE(&t[i], entry, &s[i]);
+    ASSERT_EQ(r, 0);
+  }
+
+  for (size_t i = 0; i < THREADS; ++i) {
+    THREAD_RET ret = 0;
+    const int r = THREAD_JOIN(t[i], &ret);
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(ret, (THREAD_RET){0});
+  }
+}
+
+/// amount each addition contributes, chosen to carry into the upper half
+static const uint128_t ADDEND = ((uint128_t)1 << 64) | UINT64_MAX;
+
+static THREAD_RET adder(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    if (s->thread_id % 2 == 0) {
+      (void)uint128_atomic_fetch_add(s->target, ADDEND);
+    } else {
+      // odd threads add twice and subtract once, for the same net effect
+      (void)uint128_atomic_fetch_add(s->target, ADDEND);
+      (void)uint128_atomic_fetch_add(s->target, ADDEND);
+      (void)uint128_atomic_fetch_sub(s->target, ADDEND);
+    }
+  }
+
+  return 0;
+}
+
+TEST("uint128_atomic_fetch_add multi-threaded") {
+  uint128_t target = 0;
+  run(adder, &target);
+  ASSERT(target == ADDEND * THREADS * ITERATIONS);
+}
+
+/// the bit in each half of the target owned by a thread
+static uint128_t bits(size_t thread_id) {
+  return ((uint128_t)1 << thread_id) | ((uint128_t)1 << (64 + thread_id));
+}
+
+static THREAD_RET toggler(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+  const uint128_t mine = bits(s->thread_id);
+
+  // toggle our bits with each operation, checking no other thread disturbs them
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    const uint128_t a = uint128_atomic_fetch_or(s->target, mine);
+    ASSERT((a & mine) == 0);
+    const uint128_t b = uint128_atomic_fetch_xor(s->target, mine);
+    ASSERT((b & mine) == mine);
+    const uint128_t c = uint128_atomic_fetch_xor(s->target, mine);
+    ASSERT((c & mine) == 0);
+    const uint128_t d = uint128_atomic_fetch_and(s->target, ~mine);
+    ASSERT((d & mine) == mine);
+  }
+
+  // leave our bits set for the caller to check
+  (void)uint128_atomic_fetch_or(s->target, mine);
+
+  return 0;
+}
+
+TEST("uint128_atomic_fetch_or multi-threaded") {
+  uint128_t target = 0;
+  run(toggler, &target);
+
+  uint128_t expected = 0;
+  for (size_t i = 0; i < THREADS; ++i)
+    expected |= bits(i);
+  ASSERT(target == expected);
+}
+
+/// a value distinct to each thread and iteration, spanning both halves
+static uint128_t sample(size_t thread_id, size_t i) {
+  return ((uint128_t)i << 64) | (thread_id * ITERATIONS + i);
+}
+
+static THREAD_RET maximiser(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    const uint128_t v = sample(s->thread_id, i);
+    (void)uint128_atomic_fetch_max(s->target, v);
+    // the target only ever grows, so must now be at least what we wrote
+    ASSERT(uint128_atomic_load(s->target) >= v);
+  }
+
+  return 0;
+}
+
+TEST("uint128_atomic_fetch_max multi-threaded") {
+  uint128_t target = 0;
+  run(maximiser, &target);
+  ASSERT(target == sample(THREADS - 1, ITERATIONS - 1));
+}
+
+static THREAD_RET minimiser(void *arg) {
+  assert(arg != NULL);
+  state_t *const s = arg;
+
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    const uint128_t v = ~sample(s->thread_id, i);
+    (void)uint128_atomic_fetch_min(s->target, v);
+    // the target only ever shrinks, so must now be at most what we wrote
+    ASSERT(uint128_atomic_load(s->target) <= v);
+  }
+
+  return 0;
+}
+
+TEST("uint128_atomic_fetch_min multi-threaded") {
+  uint128_t target = UINT128_MAX;
+  run(minimiser, &target);
+  ASSERT(target == ~sample(THREADS - 1, ITERATIONS - 1));
+}
@@ -0,0 +1,69 @@
+/// @file
+/// @brief Test single-threaded read-modify-write of 128-bit unsigned integers
+///
+/// All content in this file is in the public domain. Use it any way you wish.
+
+#include "test.h"
+#include <stdint.h>
+#include <ute/int128.h>
+
+/// a value with bits set in both halves
+#define BOTH_HALVES (((uint128_t)1 << 64) | 1)
+
+TEST("uint128_atomic_fetch_add single-threaded") {
+  uint128_t x = UINT64_MAX;
+  ASSERT(uint128_atomic_fetch_add(&x, 1) == UINT64_MAX);
+  ASSERT(x == (uint128_t)1 << 64);
+
+  // addition should wrap
+  x = UINT128_MAX;
+  ASSERT(uint128_atomic_fetch_add(&x, 2) == UINT128_MAX);
+  ASSERT(x == 1);
+}
+
+TEST("uint128_atomic_fetch_sub single-threaded") {
+  uint128_t x = (uint128_t)1 << 64;
+  ASSERT(uint128_atomic_fetch_sub(&x, 1) == (uint128_t)1 << 64);
+  ASSERT(x == UINT64_MAX);
+
+  // subtraction should wrap
+  x = 0;
+  ASSERT(uint128_atomic_fetch_sub(&x, 1) == 0);
+  ASSERT(x == UINT128_MAX);
+}
+
+TEST("uint128_atomic_fetch_and single-threaded") {
+  uint128_t x = UINT128_MAX;
+  ASSERT(uint128_atomic_fetch_and(&x, BOTH_HALVES) == UINT128_MAX);
+  ASSERT(x == BOTH_HALVES);
+}
+
+TEST("uint128_atomic_fetch_or single-threaded") {
+  uint128_t x = 0;
+  ASSERT(uint128_atomic_fetch_or(&x, BOTH_HALVES) == 0);
+  ASSERT(x == BOTH_HALVES);
+  ASSERT(uint128_atomic_fetch_or(&x, 2) == BOTH_HALVES);
+  ASSERT(x == (BOTH_HALVES | 2));
+}
+
+TEST("uint128_atomic_fetch_xor single-threaded") {
+  uint128_t x = BOTH_HALVES;
+  ASSERT(uint128_atomic_fetch_xor(&x, UINT128_MAX) == BOTH_HALVES);
+  ASSERT(x == ~BOTH_HALVES);
+}
+
+TEST("uint128_atomic_fetch_min single-threaded") {
+  uint128_t x = BOTH_HALVES;
+  ASSERT(uint128_atomic_fetch_min(&x, UINT128_MAX) == BOTH_HALVES);
+  ASSERT(x == BOTH_HALVES);
+  ASSERT(uint128_atomic_fetch_min(&x, UINT64_MAX) == BOTH_HALVES);
+  ASSERT(x == UINT64_MAX);
+}
+
+TEST("uint128_atomic_fetch_max single-threaded") {
+  uint128_t x = BOTH_HALVES;
+  ASSERT(uint128_atomic_fetch_max(&x, UINT64_MAX) == BOTH_HALVES);
+  ASSERT(x == BOTH_HALVES);
+  ASSERT(uint128_atomic_fetch_max(&x, UINT128_MAX) == BOTH_HALVES);
+  ASSERT(x == UINT128_MAX);
+}